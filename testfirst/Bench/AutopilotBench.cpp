@@ -0,0 +1,106 @@
+//
+// AutopilotBench.cpp
+// SnakeAutopilot decision latency (mean, p99, worst) versus snake length and node budget.
+// With no budget every decision is fully informed, so at moderate lengths the
+// snake must survive the whole run (fixed seed); with a budget no Think call may
+// expand more nodes than it.
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "SnakeAutopilot.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <vector>
+
+int RunAutopilotBench()
+{
+    // 64 x 48 cells; the long snakes are laid out along the Hamiltonian cycle first,
+    // which leaves the autopilot a maze of body to search around
+    constexpr int gridWidth = 64;
+    constexpr int gridHeight = 48;
+    constexpr int screenWidth = gridWidth * static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int screenHeight = gridHeight * static_cast<int>(SnakeGame::c_cellSize);
+
+    // Four decisions per movement step, like a 40 Hz frame rate
+    constexpr int thinksPerStep = 4;
+    constexpr int timedThinks = 20000;
+
+    const int lengths[] = { 3, 64, 256, 1024, 2048 };
+    const int budgets[] = { 128, SnakeAutopilot::c_defaultNodeBudget, INT_MAX };
+    constexpr int maxSurvivalLength = 256;  // Longest start that must not die with no budget
+
+    printf("%8s %8s %10s %10s %10s %10s %10s %8s %s\n",
+        "length", "budget", "mean us", "p99 us", "max us", "mean nodes", "max nodes", "food", "");
+
+    std::vector<double> latencies;
+    latencies.reserve(timedThinks);
+    bool ok = true;
+
+    for (int length : lengths)
+    {
+        for (int budget : budgets)
+        {
+            SnakeGame game;
+            game.Reset(screenWidth, screenHeight, 7);
+            game.Grow(length - static_cast<int>(game.GetLength()));
+            while (static_cast<int>(game.GetLength()) < length && !game.IsGameOver())
+            {
+                Bench::SteerAndStep(game, gridWidth, gridHeight);
+            }
+
+            SnakeAutopilot autopilot(budget);
+            autopilot.Reset(game);
+
+            latencies.clear();
+            const int startScore = game.GetScore();
+            uint64_t totalNodes = 0;
+            int maxNodes = 0;
+
+            for (int i = 0; i < timedThinks && !game.IsGameOver() && !game.IsWon(); ++i)
+            {
+                Bench::Stopwatch timer;
+                const Direction dir = autopilot.Think(game);
+                latencies.push_back(timer.ElapsedSeconds());
+
+                totalNodes += static_cast<uint64_t>(autopilot.GetLastNodeCount());
+                maxNodes = std::max(maxNodes, autopilot.GetLastNodeCount());
+
+                game.QueueDirection(dir);
+                game.Update(SnakeGame::c_moveInterval / thinksPerStep);
+            }
+
+            const size_t count = latencies.size();
+            double total = 0.0;
+            for (double latency : latencies)
+            {
+                total += latency;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            const double p99 = count ? latencies[std::min(count - 1, count * 99 / 100)] : 0.0;
+            const double worst = count ? latencies.back() : 0.0;
+
+            char budgetText[16];
+            if (budget == INT_MAX)
+                snprintf(budgetText, sizeof(budgetText), "none");
+            else
+                snprintf(budgetText, sizeof(budgetText), "%d", budget);
+
+            const bool mustSurvive = budget == INT_MAX && length <= maxSurvivalLength;
+            const bool survived = !(mustSurvive && game.IsGameOver());
+            const bool withinBudget = maxNodes <= budget;
+            ok &= survived && withinBudget;
+
+            printf("%8d %8s %10.3f %10.3f %10.3f %10.1f %10d %8d %s%s\n", length, budgetText,
+                count ? total * 1e6 / static_cast<double>(count) : 0.0, p99 * 1e6, worst * 1e6,
+                count ? static_cast<double>(totalNodes) / static_cast<double>(count) : 0.0, maxNodes,
+                game.GetScore() - startScore,
+                game.IsGameOver() ? "(died)" : (game.IsWon() ? "(won)" : ""),
+                (survived && withinBudget) ? (mustSurvive || budget != INT_MAX ? "  ok" : "") : "  FAILED");
+        }
+    }
+
+    return ok ? 0 : 1;
+}
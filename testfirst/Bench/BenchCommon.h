@@ -0,0 +1,83 @@
+//
+// BenchCommon.h
+// Shared helpers for the console benchmarks (timing, reporting, steering)
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "SnakeGame.h"
+
+namespace Bench
+{
+    // Monotonic stopwatch
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+        void Restart() { m_start = std::chrono::steady_clock::now(); }
+
+        double ElapsedSeconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Keeps a value alive so the optimizer cannot drop the work that produced it
+    inline const void* volatile g_sink = nullptr;
+
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+        g_sink = &value;
+    }
+
+    // Direction that follows a Hamiltonian cycle over a gridWidth x gridHeight board
+    // (gridHeight must be even). Row 0 and column 0 form the return lane and the
+    // remaining rows serpentine over columns 1..gridWidth-1. The cycle is oriented so
+    // the center row runs right, so a freshly reset snake (center row, facing right)
+    // can follow it until the board is full.
+    inline Direction HamiltonianDirection(int cellX, int cellY, int gridWidth, int gridHeight)
+    {
+        if (((gridHeight / 2) & 1) == 0)
+        {
+            // Even rows run right, column 0 runs up
+            if (cellX == 0)
+                return (cellY == 0) ? Direction::Right : Direction::Up;
+
+            if ((cellY & 1) == 0)
+                return (cellX < gridWidth - 1) ? Direction::Right : Direction::Down;
+
+            return (cellY == gridHeight - 1 || cellX > 1) ? Direction::Left : Direction::Down;
+        }
+
+        // Same cycle reversed: odd rows run right, column 0 runs down
+        if (cellY == 0)
+            return (cellX > 0) ? Direction::Left : Direction::Down;
+
+        if (cellX == 0)
+            return (cellY < gridHeight - 1) ? Direction::Down : Direction::Right;
+
+        if ((cellY & 1) != 0)
+            return (cellX < gridWidth - 1) ? Direction::Right : Direction::Up;
+
+        return (cellX > 1) ? Direction::Left : Direction::Up;
+    }
+
+    // Queue the cycle direction and advance exactly one movement step
+    // (SnakeGame or any SnakeGameT)
+    template<typename Game>
+    inline void SteerAndStep(Game& game, int gridWidth, int gridHeight)
+    {
+        const GridCell head = game.GetHead();
+        game.QueueDirection(HamiltonianDirection(head.x, head.y, gridWidth, gridHeight));
+        game.Update(SnakeGame::c_moveInterval);
+    }
+}
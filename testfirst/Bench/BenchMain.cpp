@@ -0,0 +1,102 @@
+//
+// BenchMain.cpp
+// Entry point for the console benchmarks
+//
+// Usage: snake_bench [name...]   (no arguments runs every benchmark)
+//
+
+#include "pch.h"
+
+#include <cstdio>
+#include <cstring>
+
+// Benchmark entry points (return 0 on success)
+int RunSnakeStepBench();
+int RunSnakeFillBench();
+int RunSnakeBodyBench();
+int RunSnakeBatchBench();
+int RunRandomBench();
+int RunAutopilotBench();
+int RunRollbackBench();
+int RunSnakeEventsBench();
+int RunTickDriftBench();
+int RunSnakeFixedBench();
+int RunSimThreadBench();
+int RunKeyboardBench();
+int RunInputHistoryBench();
+int RunLatencyTraceBench();
+int RunParticlePoolBench();
+int RunParticleScalingBench();
+int RunEmitterBench();
+int RunParticleBudgetBench();
+int RunInstanceStreamBench();
+int RunSnakeRunsBench();
+
+namespace
+{
+    struct BenchEntry
+    {
+        const char* name;
+        int (*run)();
+    };
+
+    const BenchEntry c_benches[] =
+    {
+        { "snake-step", RunSnakeStepBench },
+        { "snake-fill", RunSnakeFillBench },
+        { "snake-body", RunSnakeBodyBench },
+        { "snake-batch", RunSnakeBatchBench },
+        { "rand-threads", RunRandomBench },
+        { "autopilot", RunAutopilotBench },
+        { "rollback", RunRollbackBench },
+        { "snake-events", RunSnakeEventsBench },
+        { "tick-drift", RunTickDriftBench },
+        { "snake-fixed", RunSnakeFixedBench },
+        { "sim-thread", RunSimThreadBench },
+        { "keyboard", RunKeyboardBench },
+        { "input-history", RunInputHistoryBench },
+        { "latency-trace", RunLatencyTraceBench },
+        { "particle-pool", RunParticlePoolBench },
+        { "particle-scaling", RunParticleScalingBench },
+        { "emitters", RunEmitterBench },
+        { "particle-budget", RunParticleBudgetBench },
+        { "instance-stream", RunInstanceStreamBench },
+        { "snake-runs", RunSnakeRunsBench },
+    };
+}
+
+int main(int argc, char** argv)
+{
+    int result = 0;
+    bool ranAny = false;
+
+    for (const BenchEntry& bench : c_benches)
+    {
+        bool selected = (argc <= 1);
+        for (int i = 1; i < argc && !selected; ++i)
+        {
+            selected = (strcmp(argv[i], bench.name) == 0);
+        }
+
+        if (!selected)
+            continue;
+
+        printf("== %s ==\n", bench.name);
+        result |= bench.run();
+        printf("\n");
+        ranAny = true;
+    }
+
+    if (!ranAny)
+    {
+        printf("Unknown benchmark. Available:");
+        for (const BenchEntry& bench : c_benches)
+        {
+            printf(" %s", bench.name);
+        }
+        printf("\n");
+        return 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,289 @@
+//
+// EmitterBench.cpp
+// Data-driven emitters: parsing and its errors, baked curves against the keys they
+// came from, no allocations while bursts and running emitters spawn, and the
+// cost of spawning, updating and exporting
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "Effects2D.h"
+#include "ParticleEmitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Allocations made while g_countAllocations is set
+    bool g_countAllocations = false;
+    size_t g_allocations = 0;
+}
+
+void* operator new(size_t size)
+{
+    if (g_countAllocations)
+    {
+        g_allocations++;
+    }
+    if (void* memory = malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+namespace
+{
+    constexpr float c_frameSeconds = 1.0f / 60.0f;
+
+    const char* const c_sampleEmitters =
+        "# Comments and blank lines are skipped\n"
+        "\n"
+        "emitter spark\n"
+        "burst 40\n"
+        "lifetime 0.25 0.5\n"
+        "speed 200 400\n"
+        "angle -30 30\n"
+        "size 2 4\n"
+        "color 0 1 1 1 1\n"
+        "color 0.5 1 0.5 0 0.8\n"
+        "color 1 0.5 0 0 0\n"
+        "scale 0.25 2\n"
+        "scale 1 0.5\n"
+        "\n"
+        "emitter trail\n"
+        "rate 120 1.5\n"
+        "lifetime 1 1\n"
+        "speed 10 20\n"
+        "size 6 6\n";
+
+    // The spark keys again, evaluated directly
+    Float4 SparkColor(float t)
+    {
+        const float keys[3][5] = { { 0.0f, 1.0f, 1.0f, 1.0f, 1.0f }, { 0.5f, 1.0f, 0.5f, 0.0f, 0.8f }, { 1.0f, 0.5f, 0.0f, 0.0f, 0.0f } };
+        const size_t next = (t <= 0.5f) ? 1 : 2;
+        const float s = (t - keys[next - 1][0]) / (keys[next][0] - keys[next - 1][0]);
+        float value[4];
+        for (size_t i = 0; i < 4; ++i)
+        {
+            value[i] = keys[next - 1][i + 1] + (keys[next][i + 1] - keys[next - 1][i + 1]) * s;
+        }
+        return Float4{ value[0], value[1], value[2], value[3] };
+    }
+
+    float SparkScale(float t)
+    {
+        return (t <= 0.25f) ? 2.0f : 2.0f + (0.5f - 2.0f) * (t - 0.25f) / 0.75f;
+    }
+
+    bool CheckParse()
+    {
+        const EmitterLibrary defaults = EmitterLibrary::CreateDefault();
+        const EmitterLibrary sample = EmitterLibrary::Parse(c_sampleEmitters);
+        const int eat = defaults.Find("eat");
+        const int spark = sample.Find("spark");
+        const int trail = sample.Find("trail");
+        bool ok = eat == 0 && defaults.GetDefinition(0).burstCount == 12 && sample.GetCount() == 2
+            && spark == 0 && trail == 1 && sample.Find("eat") < 0
+            && sample.GetDefinition(0).burstCount == 40 && sample.GetDefinition(0).spawnRate == 0.0f
+            && sample.GetDefinition(0).angle.min == -30.0f && sample.GetDefinition(1).spawnRate == 120.0f
+            && sample.GetDefinition(1).duration == 1.5f && sample.GetDefinition(1).burstCount == 0
+            && sample.GetCurves(1).color[0] == 0xFFFFFFFFu && sample.GetCurves(1).size[63] == 1.0f;
+
+        // Each must fail on its last line
+        const char* const bad[] = {
+            "burst 3\n",
+            "emitter a\nburst -1\n",
+            "emitter a\nburst 2.5\n",
+            "emitter a\nlifetime 0 1\n",
+            "emitter a\nspeed 5 1\n",
+            "emitter a\nsize 1\n",
+            "emitter a\nsize 1 2 3\n",
+            "emitter a\ncolor 0.5 1 1 1 1\ncolor 0.5 1 1 1 0\n",
+            "emitter a\ncolor 1.5 1 1 1 1\n",
+            "emitter a\nscale 0 -1\n",
+            "emitter a\nrate 10\n",
+            "emitter a\nsparkle 1\n",
+            "emitter a\nemitter a\n",
+            "emitter\n",
+        };
+        int accepted = 0;
+        for (const char* text : bad)
+        {
+            int lines = 0;
+            for (const char* c = text; *c; ++c)
+            {
+                lines += (*c == '\n') ? 1 : 0;
+            }
+            try
+            {
+                EmitterLibrary::Parse(text);
+                accepted++;
+            }
+            catch (const std::runtime_error& error)
+            {
+                const std::string expected = "Bad emitter line " + std::to_string(lines) + ":";
+                accepted += (std::string(error.what()).compare(0, expected.size(), expected) == 0) ? 0 : 1;
+            }
+        }
+        ok &= accepted == 0;
+
+        printf("parse:          default + 2 sample emitters, %zu bad inputs, %d accepted or misreported  %s\n",
+            sizeof(bad) / sizeof(bad[0]), accepted, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Every baked sample against the keys evaluated at that sample's life fraction,
+    // and a drawn eat particle against the linear fade it had before curves
+    bool CheckCurves()
+    {
+        const EmitterLibrary sample = EmitterLibrary::Parse(c_sampleEmitters);
+        const ParticleCurves& curves = sample.GetCurves(0);
+
+        int wrong = 0;
+        for (size_t i = 0; i < ParticleCurves::c_sampleCount; ++i)
+        {
+            const float t = static_cast<float>(i) / static_cast<float>(ParticleCurves::c_sampleCount - 1);
+            const uint32_t expected = PackColor(SparkColor(t));
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                const int difference = static_cast<int>((curves.color[i] >> shift) & 0xFF) - static_cast<int>((expected >> shift) & 0xFF);
+                wrong += (std::abs(difference) > 1) ? 1 : 0;
+            }
+            wrong += (std::fabs(curves.size[i] - SparkScale(t)) > 1e-5f) ? 1 : 0;
+        }
+
+        // Eat particles drawn from the default curves fade as they did when alpha
+        // was lifetime / starting lifetime: within half a sample plus rounding
+        Effects2D effects;
+        effects.Reset(1);
+        effects.OnEatFood(Float2{ 100.0f, 100.0f });
+        std::vector<Particle> particles;
+        float worstFade = 0.0f;
+        for (int frame = 0; frame < 30; ++frame)
+        {
+            effects.Update(c_frameSeconds);
+            effects.ExportParticles(particles);
+            const ParticlePool& pool = effects.GetParticles();
+            for (size_t i = 0; i < particles.size(); ++i)
+            {
+                worstFade = std::max(worstFade, std::fabs(UnpackColor(particles[i].color).w - (1.0f - pool.GetLifeFraction(i))));
+            }
+        }
+        const float fadeTolerance = 0.5f / (ParticleCurves::c_sampleCount - 1) + 1.0f / 255.0f;
+        const bool ok = wrong == 0 && worstFade <= fadeTolerance;
+
+        printf("curves:         %zu samples, %d off the keys, eat fade off linear by %.4f (limit %.4f)  %s\n",
+            ParticleCurves::c_sampleCount, wrong, worstFade, fadeTolerance, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Bursts, running emitters (more than the pool holds) and updates for ten
+    // seconds of frames, counting heap allocations
+    bool CheckNoAllocations()
+    {
+        Effects2D effects;
+        effects.SetEmitterLibrary(EmitterLibrary::Parse(c_sampleEmitters));
+        effects.Reset(2);
+        const size_t spark = static_cast<size_t>(effects.GetEmitterLibrary().Find("spark"));
+        const size_t trail = static_cast<size_t>(effects.GetEmitterLibrary().Find("trail"));
+
+        size_t peakParticles = 0;
+        size_t peakEmitters = 0;
+        g_allocations = 0;
+        g_countAllocations = true;
+        for (int frame = 0; frame < 600; ++frame)
+        {
+            const Float2 pos = { static_cast<float>(frame % 800), static_cast<float>((frame * 7) % 600) };
+            effects.Emit(spark, pos);
+            effects.Emit(trail, pos);  // 1.5 s each: 90 wanted, the rest dropped
+            effects.Update(c_frameSeconds);
+            peakParticles = std::max(peakParticles, effects.GetParticleCount());
+            peakEmitters = std::max(peakEmitters, effects.GetEmitterCount());
+        }
+        g_countAllocations = false;
+
+        const bool ok = g_allocations == 0 && peakEmitters == Effects2D::c_maxEmitters;
+        printf("allocations:    600 frames, peak %zu particles / %zu emitters, %zu allocations  %s\n",
+            peakParticles, peakEmitters, g_allocations, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    void MeasureCosts()
+    {
+        Effects2D effects;
+        effects.SetEmitterLibrary(EmitterLibrary::Parse(c_sampleEmitters));
+        const size_t spark = static_cast<size_t>(effects.GetEmitterLibrary().Find("spark"));
+        const size_t trail = static_cast<size_t>(effects.GetEmitterLibrary().Find("trail"));
+
+        // Bursts into an emptied pool, so none are cut short
+        constexpr int bursts = 100000;
+        const size_t burstSize = effects.GetEmitterLibrary().GetDefinition(spark).burstCount;
+        double spawnSeconds = 0.0;
+        for (int i = 0; i < bursts; ++i)
+        {
+            if (effects.GetParticleCount() + burstSize > Effects2D::c_maxParticles)
+            {
+                effects.Reset(3);
+            }
+            Bench::Stopwatch timer;
+            effects.Emit(spark, Float2{ 400.0f, 300.0f });
+            spawnSeconds += timer.ElapsedSeconds();
+        }
+        Bench::DoNotOptimize(effects);
+
+        // Steady state with every emitter slot running (restarted as they finish)
+        effects.Reset(4);
+        std::vector<Particle> particles;
+        constexpr int frames = 2000;
+        double updateSeconds = 0.0;
+        double exportSeconds = 0.0;
+        size_t exported = 0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            while (effects.GetEmitterCount() < Effects2D::c_maxEmitters)
+            {
+                effects.Emit(trail, Float2{ static_cast<float>(effects.GetEmitterCount() * 12), 300.0f });
+            }
+            Bench::Stopwatch timer;
+            effects.Update(c_frameSeconds);
+            updateSeconds += timer.ElapsedSeconds();
+
+            timer.Restart();
+            effects.ExportParticles(particles);
+            exportSeconds += timer.ElapsedSeconds();
+            exported += particles.size();
+        }
+        Bench::DoNotOptimize(particles);
+
+        printf("\nspawn:          %.1f ns/particle (bursts of %zu)\n", spawnSeconds * 1e9 / (static_cast<double>(bursts) * burstSize), burstSize);
+        printf("update:         %.2f us/frame, %zu emitters running, ~%zu particles\n",
+            updateSeconds * 1e6 / frames, Effects2D::c_maxEmitters, exported / frames);
+        printf("export:         %.1f ns/particle (curve lookup and unpack)\n", exportSeconds * 1e9 / static_cast<double>(exported));
+    }
+}
+
+int RunEmitterBench()
+{
+    bool ok = true;
+    ok &= CheckParse();
+    ok &= CheckCurves();
+    ok &= CheckNoAllocations();
+    MeasureCosts();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+//
+// InputHistoryBench.cpp
+// InputRouter over a recorded reading history (MockInputBackend): taps lost by
+// polling only the current reading versus walking the history, then the cost of
+// walking long histories
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "InputRouter.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr uint64_t c_readingIntervalUs = 1000;  // Keyboard sampled at 1 kHz
+
+    struct Recording
+    {
+        std::vector<InputReading> readings;
+        int startTaps;  // Space taps (press and release)
+        int turnTaps;   // Arrow taps, each a new direction
+    };
+
+    InputReading KeyboardReading(uint64_t timestamp, const KeyBits& keys)
+    {
+        InputReading reading = {};
+        reading.timestamp = timestamp;
+        reading.kind = InputDeviceKind::Keyboard;
+        reading.keys = keys;
+        return reading;
+    }
+
+    // Short taps (1-3 readings held) with gaps of 1-40 readings: Space, or the next
+    // arrow in Up, Left, Down, Right order
+    Recording Record(size_t readingCount, uint64_t seed)
+    {
+        static const uint8_t arrows[] = { VirtualKey::Up, VirtualKey::Left, VirtualKey::Down, VirtualKey::Right };
+
+        Pcg32 random(seed);
+        Recording recording = {};
+        recording.readings.reserve(readingCount);
+        uint64_t timestamp = 0;
+        size_t arrow = 0;
+        while (recording.readings.size() < readingCount)
+        {
+            KeyBits keys = {};
+            for (uint32_t gap = 1 + random.NextBelow(40); gap > 0; --gap)
+            {
+                recording.readings.push_back(KeyboardReading(timestamp += c_readingIntervalUs, keys));
+            }
+
+            if (random.NextBelow(2) == 0)
+            {
+                keys.Set(VirtualKey::Space);
+                recording.startTaps++;
+            }
+            else
+            {
+                keys.Set(arrows[arrow++ % 4]);
+                recording.turnTaps++;
+            }
+            for (uint32_t held = 1 + random.NextBelow(3); held > 0; --held)
+            {
+                recording.readings.push_back(KeyboardReading(timestamp += c_readingIntervalUs, keys));
+            }
+        }
+
+        // Finish with everything released
+        recording.readings.push_back(KeyboardReading(timestamp + c_readingIntervalUs, KeyBits{}));
+        return recording;
+    }
+
+    struct Counts
+    {
+        int startPresses;
+        int turns;
+        bool ordered;  // Event timestamps never went backwards
+    };
+
+    // Poll once per frame (33 ms, with a 250 ms hitch every 64 frames). With
+    // currentOnly, only each frame's latest reading is visible, as with
+    // GetCurrentReading; otherwise the router walks every reading in the frame.
+    Counts PlayBack(const Recording& recording, bool currentOnly)
+    {
+        InputRouter router;
+        MockInputBackend backend;
+        std::vector<InputEvent> events;
+        Counts counts = { 0, 0, true };
+        uint64_t lastTimestamp = 0;
+
+        size_t next = 0;
+        uint64_t frameEnd = 0;
+        for (int frame = 0; next < recording.readings.size(); ++frame)
+        {
+            frameEnd += ((frame % 64) == 63) ? 250000 : 33333;
+
+            backend.Clear();
+            size_t last = next;
+            for (; next < recording.readings.size() && recording.readings[next].timestamp <= frameEnd; ++next)
+            {
+                last = next;
+                if (!currentOnly)
+                    backend.Push(recording.readings[next]);
+            }
+            if (currentOnly && last < next)
+            {
+                backend.Push(recording.readings[last]);
+            }
+
+            events.clear();
+            router.Poll(backend, &events);
+            for (const InputEvent& event : events)
+            {
+                counts.startPresses += event.input.startPressed ? 1 : 0;
+                counts.turns += event.input.dir.has_value() ? 1 : 0;
+                counts.ordered = counts.ordered && event.timestamp >= lastTimestamp;
+                lastTimestamp = event.timestamp;
+            }
+        }
+        return counts;
+    }
+
+    bool CheckTapsSurvive()
+    {
+        const Recording recording = Record(200000, 7);
+        const Counts history = PlayBack(recording, false);
+        const Counts current = PlayBack(recording, true);
+
+        const bool ok = history.startPresses == recording.startTaps && history.turns == recording.turnTaps && history.ordered;
+        printf("%-16s %10s %10s\n", "taps seen", "start", "turns");
+        printf("%-16s %10d %10d\n", "recorded", recording.startTaps, recording.turnTaps);
+        printf("%-16s %10d %10d  %s\n", "reading history", history.startPresses, history.turns, ok ? "ok" : "FAILED");
+        printf("%-16s %10d %10d\n", "current only", current.startPresses, current.turns);
+        return ok;
+    }
+
+    // Mean cost per reading of Poll over histories of `length` readings
+    double MeasureWalk(const Recording& recording, size_t length)
+    {
+        constexpr size_t totalReadings = 2000000;
+
+        InputRouter router;
+        MockInputBackend backend;
+        std::vector<InputEvent> events;
+        events.reserve(length);
+
+        double seconds = 0.0;
+        size_t walked = 0;
+        size_t offset = 0;
+        while (walked < totalReadings)
+        {
+            backend.Clear();
+            for (size_t i = 0; i < length; ++i)
+            {
+                backend.Push(recording.readings[(offset + i) % recording.readings.size()]);
+            }
+            offset += length;
+
+            events.clear();
+            Bench::Stopwatch timer;
+            const InputState merged = router.Poll(backend, &events);
+            seconds += timer.ElapsedSeconds();
+
+            Bench::DoNotOptimize(merged);
+            walked += length;
+        }
+        return seconds * 1e9 / static_cast<double>(walked);
+    }
+}
+
+int RunInputHistoryBench()
+{
+    const bool ok = CheckTapsSurvive();
+
+    const Recording recording = Record(1 << 16, 11);
+    printf("\n%10s %14s\n", "history", "ns/reading");
+    const size_t lengths[] = { 1, 16, 256, 4096 };
+    for (size_t length : lengths)
+    {
+        printf("%10zu %14.2f\n", length, MeasureWalk(recording, length));
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+//
+// InstanceStream.cpp
+// Sprite instance stream generation
+//
+
+#include "pch.h"
+#include "InstanceStream.h"
+#include "GameSession.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Runs are slower to write than cells per quad, so they only pay off once
+    // they save most of the quads
+    bool UseBodyRuns(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& bodyCorners, SnakeBodyStyle bodyStyle)
+    {
+        const size_t corners = bodyCorners.size();
+        return bodyStyle == SnakeBodyStyle::Runs && corners > 0 && corners * 2 < snapshot.segments.size();
+    }
+}
+
+void WriteParticleInstances(const Particle* particles, size_t count, Float2 offset, SpriteInstance* out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Particle& particle = particles[i];
+        const float half = particle.size * 0.5f;
+        out[i].pos = Float2{ particle.pos.x + offset.x - half, particle.pos.y + offset.y - half };
+        out[i].size = Float2{ particle.size, particle.size };
+        out[i].color = particle.color;
+    }
+}
+
+void WriteSegmentInstances(const GridCell* segments, const GridCell* previous, size_t count, float alpha,
+    float drawSize, uint32_t color, Float2 offset, SpriteInstance* out)
+{
+    // Cell (x, y) blended, scaled to pixels and moved to the square's corner:
+    // (from + (to - from) * alpha) * cellSize + (cellSize - drawSize) / 2 + offset
+    const float cellSize = SnakeGame::c_cellSize;
+    const float cornerX = (cellSize - drawSize) * 0.5f + offset.x;
+    const float cornerY = (cellSize - drawSize) * 0.5f + offset.y;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float fromX = static_cast<float>(previous[i].x);
+        const float fromY = static_cast<float>(previous[i].y);
+        const float toX = static_cast<float>(segments[i].x);
+        const float toY = static_cast<float>(segments[i].y);
+        out[i].pos = Float2{ (fromX + (toX - fromX) * alpha) * cellSize + cornerX, (fromY + (toY - fromY) * alpha) * cellSize + cornerY };
+        out[i].size = Float2{ drawSize, drawSize };
+        out[i].color = color;
+    }
+}
+
+void WriteSnapshotSegmentInstances(const GameSessionSnapshot& snapshot, size_t first, size_t count, float drawSize,
+    uint32_t color, Float2 offset, SpriteInstance* out)
+{
+    const GridCell* segments = snapshot.segments.data() + first;
+    const float alpha = snapshot.interpolationAlpha;
+    if (count == 0 || snapshot.previousHead == snapshot.segments[0])
+    {
+        // Not stepped yet: nothing moves
+        WriteSegmentInstances(segments, segments, count, alpha, drawSize, color, offset, out);
+        return;
+    }
+
+    // Every segment but the tail comes from the next one's cell
+    const size_t shifted = std::min(count, snapshot.segments.size() - 1 - first);
+    WriteSegmentInstances(segments, segments + 1, shifted, alpha, drawSize, color, offset, out);
+    if (shifted < count)
+    {
+        WriteSegmentInstances(segments + shifted, &snapshot.previousTail, 1, alpha, drawSize, color, offset, out + shifted);
+    }
+}
+
+size_t WriteBodyRunInstances(const GridCell* corners, size_t cornerCount, GridCell previousHead, GridCell previousTail,
+    float alpha, float thickness, uint32_t color, Float2 offset, SpriteInstance* out)
+{
+    if (cornerCount == 0)
+        return 0;
+
+    auto blend = [alpha](GridCell from, GridCell to)
+    {
+        const float fromX = static_cast<float>(from.x);
+        const float fromY = static_cast<float>(from.y);
+        return Float2{ fromX + (static_cast<float>(to.x) - fromX) * alpha, fromY + (static_cast<float>(to.y) - fromY) * alpha };
+    };
+
+    // Walk the polyline head, corner 1, ..., tail cell, blended tail in cell
+    // units, merging consecutive pieces along the same row or column into one
+    // run and skipping pieces the blend has shrunk to nothing
+    const float cellSize = SnakeGame::c_cellSize;
+    const float inset = (cellSize - thickness) * 0.5f;
+    size_t written = 0;
+    Float2 runMin = {};
+    Float2 runMax = {};
+    bool runHorizontal = false;
+    bool haveRun = false;
+    auto writeRun = [&]()
+    {
+        out[written++] = SpriteInstance{
+            Float2{ runMin.x * cellSize + inset + offset.x, runMin.y * cellSize + inset + offset.y },
+            Float2{ (runMax.x - runMin.x) * cellSize + thickness, (runMax.y - runMin.y) * cellSize + thickness },
+            color };
+    };
+
+    const Float2 head = blend(previousHead, corners[0]);
+    Float2 from = head;
+    auto lineTo = [&](Float2 to)
+    {
+        if (to.x == from.x && to.y == from.y)
+            return;
+
+        const bool horizontal = to.y == from.y;
+        const Float2 low = { std::min(from.x, to.x), std::min(from.y, to.y) };
+        const Float2 high = { std::max(from.x, to.x), std::max(from.y, to.y) };
+        if (haveRun && horizontal == runHorizontal && (horizontal ? low.y == runMin.y : low.x == runMin.x))
+        {
+            runMin = Float2{ std::min(runMin.x, low.x), std::min(runMin.y, low.y) };
+            runMax = Float2{ std::max(runMax.x, high.x), std::max(runMax.y, high.y) };
+        }
+        else
+        {
+            if (haveRun)
+            {
+                writeRun();
+            }
+            runMin = low;
+            runMax = high;
+            runHorizontal = horizontal;
+            haveRun = true;
+        }
+        from = to;
+    };
+
+    for (size_t i = 1; i < cornerCount; ++i)
+    {
+        lineTo(Float2{ static_cast<float>(corners[i].x), static_cast<float>(corners[i].y) });
+    }
+    lineTo(blend(previousTail, corners[cornerCount - 1]));
+
+    if (!haveRun)
+    {
+        // Every piece is empty (a one-cell snake): one square at the head
+        runMin = head;
+        runMax = head;
+    }
+    writeRun();
+    return written;
+}
+
+size_t CountSceneInstances(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& bodyCorners,
+    SnakeBodyStyle bodyStyle)
+{
+    size_t body = snapshot.segments.empty() ? 0 : snapshot.segments.size() - 1;
+    if (UseBodyRuns(snapshot, bodyCorners, bodyStyle))
+    {
+        body = bodyCorners.size();
+    }
+    return body + (snapshot.segments.empty() ? 0 : 1) + (snapshot.food.alive ? 1 : 0) + snapshot.particles.size();
+}
+
+size_t WriteSceneInstances(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& bodyCorners,
+    Float2 cameraOffset, SnakeBodyStyle bodyStyle, SpriteInstance* out, size_t capacity)
+{
+    size_t written = 0;
+    const size_t length = snapshot.segments.size();
+    if (length > 0)
+    {
+        // Body first so the head draws over it. Runs need room for every run;
+        // a buffer too short for them (or a snapshot without corners, or with
+        // too many) falls back to clipped cells.
+        const size_t corners = bodyCorners.size();
+        if (UseBodyRuns(snapshot, bodyCorners, bodyStyle) && corners <= capacity)
+        {
+            written += WriteBodyRunInstances(bodyCorners.data(), corners, snapshot.GetPreviousSegment(0),
+                snapshot.GetPreviousSegment(length - 1), snapshot.interpolationAlpha, c_segmentDrawSize, c_snakeBodyColor,
+                cameraOffset, out);
+        }
+        else
+        {
+            const size_t body = std::min(length - 1, capacity);
+            WriteSnapshotSegmentInstances(snapshot, 1, body, c_segmentDrawSize, c_snakeBodyColor, cameraOffset, out);
+            written += body;
+        }
+
+        const size_t head = std::min<size_t>(1, capacity - written);
+        WriteSnapshotSegmentInstances(snapshot, 0, head, c_segmentDrawSize, c_snakeHeadColor, cameraOffset, out + written);
+        written += head;
+    }
+
+    if (snapshot.food.alive && written < capacity)
+    {
+        const float cellSize = SnakeGame::c_cellSize;
+        const float corner = (cellSize - c_foodDrawSize) * 0.5f;
+        out[written++] = SpriteInstance{
+            Float2{ static_cast<float>(snapshot.food.cell.x) * cellSize + corner + cameraOffset.x,
+                static_cast<float>(snapshot.food.cell.y) * cellSize + corner + cameraOffset.y },
+            Float2{ c_foodDrawSize, c_foodDrawSize }, c_foodColor };
+    }
+
+    const size_t particles = std::min(snapshot.particles.size(), capacity - written);
+    WriteParticleInstances(snapshot.particles.data(), particles, cameraOffset, out + written);
+    return written + particles;
+}
@@ -0,0 +1,82 @@
+//
+// InstanceStream.h
+// Packed per-instance sprite records for one instanced draw of the scene. The
+// game has no instanced pipeline and draws per sprite (Game::RenderScene), so
+// only the benches write these: the cost of the stream and of body runs.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ParticlePool.h"
+#include "SnakeGame.h"
+
+struct GameSessionSnapshot;
+
+// One untextured rectangle: what a vertex shader needs to expand it into a quad.
+// 20 bytes of 4-byte fields, so a frame's stream can be copied or mapped into an
+// upload buffer as is and read with a 20-byte vertex stride.
+struct SpriteInstance
+{
+    Float2 pos;      // Top-left corner in pixels, camera offset applied
+    Float2 size;     // Width and height in pixels
+    uint32_t color;  // PackColor
+};
+
+static_assert(sizeof(SpriteInstance) == 20, "SpriteInstance is one 20-byte record");
+
+// How the snake's body is drawn
+enum class SnakeBodyStyle : uint8_t
+{
+    Cells,  // One square per segment, with the visual gap between cells (O(length) quads)
+    Runs,   // One quad per straight run, the gap kept only along the sides (O(turns) quads),
+            // when there are fewer than half as many corners as segments; else Cells
+};
+
+// Scene colors and sizes (the DirectX::Colors the scene was drawn with)
+constexpr uint32_t c_snakeBodyColor = PackColor(Float4{ 0.564705908f, 0.933333397f, 0.564705908f, 1.0f });  // LightGreen
+constexpr uint32_t c_snakeHeadColor = PackColor(Float4{ 0.0f, 1.0f, 1.0f, 1.0f });                          // Cyan
+constexpr uint32_t c_foodColor = PackColor(Float4{ 1.0f, 0.843137324f, 0.0f, 1.0f });                       // Gold
+constexpr float c_segmentDrawSize = SnakeGame::c_cellSize * 0.9f;  // Slightly smaller than a cell for a visual gap
+constexpr float c_foodDrawSize = SnakeGame::c_cellSize * 0.8f;
+
+// The particle and segment writers are plain loops over their inputs with no
+// calls or branches per instance, so the compiler can vectorize them; each
+// writes exactly `count` records to out.
+
+// Particles centered on their positions
+void WriteParticleInstances(const Particle* particles, size_t count, Float2 offset, SpriteInstance* out);
+
+// Snake segments centered in their cells, blended from previous[i] to
+// segments[i] by alpha (as SnakeGame::GetPreviousSegment and the interpolation
+// alpha describe), all drawSize wide and one color
+void WriteSegmentInstances(const GridCell* segments, const GridCell* previous, size_t count, float alpha,
+    float drawSize, uint32_t color, Float2 offset, SpriteInstance* out);
+
+// Snapshot segments [first, first + count), blended from their previous cells
+// (GameSessionSnapshot::GetPreviousSegment, taken as the segments shifted by
+// one) as WriteSegmentInstances does
+void WriteSnapshotSegmentInstances(const GameSessionSnapshot& snapshot, size_t first, size_t count, float drawSize,
+    uint32_t color, Float2 offset, SpriteInstance* out);
+
+// The body as one quad per straight run, thickness pixels wide, from the head
+// (moved from previousHead by alpha) through the corners (SnakeGame::GetCorner,
+// head first) to the tail (moved from previousTail by alpha), so it covers the
+// cells WriteSegmentInstances would draw without the gaps between them. Writes
+// at most max(cornerCount, 1) records and returns how many it wrote.
+size_t WriteBodyRunInstances(const GridCell* corners, size_t cornerCount, GridCell previousHead, GridCell previousTail,
+    float alpha, float thickness, uint32_t color, Float2 offset, SpriteInstance* out);
+
+// Records WriteSceneInstances writes for this snapshot at most
+size_t CountSceneInstances(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& bodyCorners,
+    SnakeBodyStyle bodyStyle);
+
+// The whole scene in draw order (body, head, food, particles), offset by the
+// camera. bodyCorners are the snake's SnakeGame::GetCorner, head first (only
+// read for SnakeBodyStyle::Runs). Writes at most capacity records, dropping
+// particles first, and returns how many it wrote.
+size_t WriteSceneInstances(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& bodyCorners,
+    Float2 cameraOffset, SnakeBodyStyle bodyStyle, SpriteInstance* out, size_t capacity);
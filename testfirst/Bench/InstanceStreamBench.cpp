@@ -0,0 +1,229 @@
+//
+// InstanceStreamBench.cpp
+// Scene instance stream: records against the sprite positions and colors the
+// per-sprite draw calls used, then the cost of writing the stream against a
+// SpriteBatch::Draw-shaped call per sprite
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "GameSession.h"
+#include "InstanceStream.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // A snapshot with a snake of `length` cells mid-step and `particleCount`
+    // particles of random position, size and color
+    void MakeSnapshot(GameSessionSnapshot& snapshot, size_t length, size_t particleCount, uint64_t seed)
+    {
+        Pcg32 random(seed);
+        snapshot.segments.resize(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            snapshot.segments[i] = GridCell{ static_cast<int16_t>(random.NextBelow(64)), static_cast<int16_t>(random.NextBelow(48)) };
+        }
+        snapshot.previousHead = snapshot.segments.size() > 1 ? snapshot.segments[1] : GridCell{ 0, 0 };
+        snapshot.previousTail = GridCell{ static_cast<int16_t>(random.NextBelow(64)), static_cast<int16_t>(random.NextBelow(48)) };
+        snapshot.interpolationAlpha = 0.375f;
+        snapshot.food = Food{ GridCell{ 12, 7 }, true };
+        snapshot.particles.resize(particleCount);
+        for (Particle& particle : snapshot.particles)
+        {
+            particle.pos = Float2{ random.NextFloat() * 1280.0f, random.NextFloat() * 720.0f };
+            particle.size = 2.0f + random.NextFloat() * 22.0f;
+            particle.color = PackColor(Float4{ random.NextFloat(), random.NextFloat(), random.NextFloat(), random.NextFloat() });
+        }
+    }
+
+    // What Game::RenderScene hands SpriteBatch::Draw for each sprite: top-left
+    // corner, color and size, in draw order
+    struct DrawArgs
+    {
+        Float2 pos;
+        float size;
+        Float4 color;
+    };
+
+    // The per-sprite arithmetic RenderScene does
+    template<typename Draw>
+    void DrawScenePerSprite(const GameSessionSnapshot& snapshot, Float2 offset, Draw&& draw)
+    {
+        const float cellSize = SnakeGame::c_cellSize;
+        const Float4 body = { 0.564705908f, 0.933333397f, 0.564705908f, 1.0f };
+        const Float4 head = { 0.0f, 1.0f, 1.0f, 1.0f };
+        const Float4 gold = { 1.0f, 0.843137324f, 0.0f, 1.0f };
+        auto cellCenter = [cellSize](GridCell cell)
+        {
+            return Float2{ static_cast<float>(cell.x) * cellSize + cellSize * 0.5f, static_cast<float>(cell.y) * cellSize + cellSize * 0.5f };
+        };
+        auto segmentCenter = [&](size_t index)
+        {
+            const Float2 from = cellCenter(snapshot.GetPreviousSegment(index));
+            const Float2 to = cellCenter(snapshot.segments[index]);
+            const float alpha = snapshot.interpolationAlpha;
+            return Float2{ from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha };
+        };
+        auto square = [&](Float2 center, float size, const Float4& color)
+        {
+            draw(DrawArgs{ Float2{ center.x + offset.x - size * 0.5f, center.y + offset.y - size * 0.5f }, size, color });
+        };
+
+        const float segmentSize = cellSize * 0.9f;
+        for (size_t i = 1; i < snapshot.segments.size(); ++i)
+        {
+            square(segmentCenter(i), segmentSize, body);
+        }
+        if (!snapshot.segments.empty())
+        {
+            square(segmentCenter(0), segmentSize, head);
+        }
+        if (snapshot.food.alive)
+        {
+            square(cellCenter(snapshot.food.cell), cellSize * 0.8f, gold);
+        }
+        for (const Particle& particle : snapshot.particles)
+        {
+            square(particle.pos, particle.size, UnpackColor(particle.color));
+        }
+    }
+
+    // Every record against the per-sprite arguments: corners within float
+    // rounding, sizes exact, colors exactly the packed argument color
+    bool CheckAgainstPerSprite()
+    {
+        GameSessionSnapshot snapshot = {};
+        MakeSnapshot(snapshot, 300, 5000, 1);
+        const Float2 offset = { -3.25f, 5.5f };
+
+        std::vector<DrawArgs> expected;
+        DrawScenePerSprite(snapshot, offset, [&](const DrawArgs& args) { expected.push_back(args); });
+
+        std::vector<SpriteInstance> instances(CountSceneInstances(snapshot, {}, SnakeBodyStyle::Cells));
+        const size_t written = WriteSceneInstances(snapshot, {}, offset, SnakeBodyStyle::Cells, instances.data(), instances.size());
+
+        int wrong = 0;
+        float worstPos = 0.0f;
+        for (size_t i = 0; i < std::min(written, expected.size()); ++i)
+        {
+            const float error = std::max(std::fabs(instances[i].pos.x - expected[i].pos.x), std::fabs(instances[i].pos.y - expected[i].pos.y));
+            worstPos = std::max(worstPos, error);
+            wrong += (error > 1e-3f || instances[i].size.x != expected[i].size || instances[i].size.y != expected[i].size
+                || instances[i].color != PackColor(expected[i].color)) ? 1 : 0;
+        }
+
+        // A short buffer keeps the snake and food and drops particles
+        std::vector<SpriteInstance> shortBuffer(snapshot.segments.size() + 10);
+        const size_t clipped = WriteSceneInstances(snapshot, {}, offset, SnakeBodyStyle::Cells, shortBuffer.data(), shortBuffer.size());
+        const bool clippedOk = clipped == shortBuffer.size() && shortBuffer.back().color == instances[clipped - 1].color
+            && shortBuffer[snapshot.segments.size()].color == c_foodColor;
+
+        const bool ok = wrong == 0 && written == expected.size() && clippedOk;
+        printf("vs per sprite:  %zu records, %d differ, worst corner error %.2g px, clipped buffer %s  %s\n",
+            written, wrong, worstPos, clippedOk ? "ok" : "wrong", ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Stand-in for SpriteBatch::Draw: the same arguments (texture handle, texture
+    // size, position, source rectangle, color vector, rotation, origin, scale,
+    // effects, depth) through a call the compiler cannot inline, queued as
+    // SpriteBatch queues them (an 80-byte record plus a pointer for sorting)
+    struct QueuedSprite
+    {
+        Float4 source;
+        Float4 destination;
+        Float4 color;
+        Float4 originRotationDepth;
+        uint64_t texture;
+        uint32_t flags;
+    };
+
+    struct SpriteQueue
+    {
+        std::vector<QueuedSprite> sprites;
+        std::vector<const QueuedSprite*> sorted;
+    };
+
+    void QueueSprite(SpriteQueue& queue, uint64_t texture, uint32_t textureWidth, uint32_t textureHeight, Float2 pos,
+        const Float4* source, Float4 color, float rotation, Float2 origin, float scale, uint32_t effects, float depth)
+    {
+        const Float4 full = { 0.0f, 0.0f, static_cast<float>(textureWidth), static_cast<float>(textureHeight) };
+        const Float4& rect = source ? *source : full;
+        queue.sprites.push_back(QueuedSprite{ rect, Float4{ pos.x, pos.y, scale, scale }, color,
+            Float4{ origin.x, origin.y, rotation, depth }, texture, effects });
+    }
+
+    using QueueSpriteFn = void (*)(SpriteQueue&, uint64_t, uint32_t, uint32_t, Float2, const Float4*, Float4, float, Float2, float, uint32_t, float);
+    QueueSpriteFn volatile g_queueSprite = &QueueSprite;
+
+    double MeasurePerSprite(const GameSessionSnapshot& snapshot, SpriteQueue& queue, int repeats)
+    {
+        Bench::Stopwatch timer;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            queue.sprites.clear();
+            queue.sorted.clear();
+            const QueueSpriteFn queueSprite = g_queueSprite;
+            DrawScenePerSprite(snapshot, Float2{ 1.0f, -1.0f }, [&](const DrawArgs& args)
+            {
+                queueSprite(queue, 0x1234, 1, 1, args.pos, nullptr, args.color, 0.0f, Float2{ 0.0f, 0.0f }, args.size, 0, 0.0f);
+            });
+            for (const QueuedSprite& sprite : queue.sprites)
+            {
+                queue.sorted.push_back(&sprite);
+            }
+            Bench::DoNotOptimize(queue);
+        }
+        return timer.ElapsedSeconds();
+    }
+
+    double MeasureStream(const GameSessionSnapshot& snapshot, std::vector<SpriteInstance>& instances, int repeats)
+    {
+        Bench::Stopwatch timer;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            instances.resize(CountSceneInstances(snapshot, {}, SnakeBodyStyle::Cells));
+            WriteSceneInstances(snapshot, {}, Float2{ 1.0f, -1.0f }, SnakeBodyStyle::Cells, instances.data(), instances.size());
+            Bench::DoNotOptimize(instances);
+        }
+        return timer.ElapsedSeconds();
+    }
+}
+
+int RunInstanceStreamBench()
+{
+    const bool ok = CheckAgainstPerSprite();
+
+    struct Scene
+    {
+        size_t length;
+        size_t particles;
+    };
+    const Scene scenes[] = { { 50, 100 }, { 500, 4096 }, { 3072, 4096 }, { 200, 100000 }, { 200, 1000000 } };
+
+    printf("\n%8s %10s %16s %16s %9s\n", "snake", "particles", "per sprite ns/i", "stream ns/i", "speedup");
+    for (const Scene& scene : scenes)
+    {
+        GameSessionSnapshot snapshot = {};
+        MakeSnapshot(snapshot, scene.length, scene.particles, 2);
+        const double count = static_cast<double>(CountSceneInstances(snapshot, {}, SnakeBodyStyle::Cells));
+        const int repeats = std::max(3, static_cast<int>(2e6 / count));
+
+        SpriteQueue queue;
+        std::vector<SpriteInstance> instances;
+        MeasurePerSprite(snapshot, queue, 1);  // Warm up: grow the buffers
+        MeasureStream(snapshot, instances, 1);
+        const double perSpriteNs = MeasurePerSprite(snapshot, queue, repeats) * 1e9 / (count * repeats);
+        const double streamNs = MeasureStream(snapshot, instances, repeats) * 1e9 / (count * repeats);
+        printf("%8zu %10zu %16.2f %16.2f %8.1fx\n", scene.length, scene.particles, perSpriteNs, streamNs, perSpriteNs / streamNs);
+    }
+    printf("(bytes per sprite: %zu queued + %zu sort pointer per sprite, %zu per stream record)\n",
+        sizeof(QueuedSprite), sizeof(const QueuedSprite*), sizeof(SpriteInstance));
+
+    return ok ? 0 : 1;
+}
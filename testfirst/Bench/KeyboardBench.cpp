@@ -0,0 +1,165 @@
+//
+// KeyboardBench.cpp
+// KeyboardMapper: aliasing check against the old 64-bit key mask, synthetic key
+// streams checked against a per-key reference, then Update throughput
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "KeyboardMapper.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // The mapping InputRouter used before KeyboardMapper: virtual keys folded into
+    // 64 bits with % 64, so keys 64 apart shared a bit
+    uint32_t FoldedActions(const KeyboardMapper& mapper, uint8_t key)
+    {
+        uint32_t actions = 0;
+        for (int bound = 0; bound < 256; ++bound)
+        {
+            const KeyAction action = mapper.GetBinding(static_cast<uint8_t>(bound));
+            if (action != KeyAction::None && (bound % 64) == (key % 64))
+            {
+                actions |= KeyboardMapper::ActionBit(action);
+            }
+        }
+        return actions;
+    }
+
+    // Press each key on its own: count keys that trigger an action they are not
+    // bound to
+    bool CheckAliasing()
+    {
+        KeyboardMapper mapper;
+        int foldedAliases = 0;
+        int aliases = 0;
+        for (int key = 0; key < 256; ++key)
+        {
+            const uint8_t virtualKey = static_cast<uint8_t>(key);
+            const KeyAction binding = mapper.GetBinding(virtualKey);
+            const uint32_t expected = (binding == KeyAction::None) ? 0 : KeyboardMapper::ActionBit(binding);
+
+            KeyBits down = {};
+            down.Set(virtualKey);
+            mapper.ResetKeys();
+            aliases += (mapper.Update(down) != expected) ? 1 : 0;
+            foldedAliases += (FoldedActions(mapper, virtualKey) != expected) ? 1 : 0;
+        }
+
+        printf("aliasing:       %d keys trigger the wrong action (64-bit folded mask: %d)  %s\n",
+            aliases, foldedAliases, aliases == 0 ? "ok" : "FAILED");
+        return aliases == 0;
+    }
+
+    // Random held-key sets: each poll toggles a few keys, biased towards the bound
+    // ones so actions actually fire
+    std::vector<KeyBits> MakeStream(size_t polls, uint64_t seed)
+    {
+        static const uint8_t bound[] = { VirtualKey::Up, VirtualKey::Down, VirtualKey::Left, VirtualKey::Right,
+            'W', 'A', 'S', 'D', VirtualKey::Space, VirtualKey::Return, VirtualKey::Escape };
+
+        Pcg32 random(seed);
+        std::vector<KeyBits> stream;
+        stream.reserve(polls);
+        KeyBits down = {};
+        for (size_t poll = 0; poll < polls; ++poll)
+        {
+            const uint32_t toggles = random.NextBelow(4);
+            for (uint32_t i = 0; i < toggles; ++i)
+            {
+                const uint8_t key = (random.NextBelow(2) == 0)
+                    ? bound[random.NextBelow(static_cast<uint32_t>(sizeof(bound)))]
+                    : static_cast<uint8_t>(random.NextBelow(256));
+                down.words[key >> 6] ^= 1ULL << (key & 63);
+            }
+            stream.push_back(down);
+        }
+        return stream;
+    }
+
+    // One key at a time through the binding table
+    uint32_t ReferenceActions(const KeyboardMapper& mapper, const KeyBits& down, const KeyBits& previous)
+    {
+        uint32_t actions = 0;
+        for (int key = 0; key < 256; ++key)
+        {
+            const uint8_t virtualKey = static_cast<uint8_t>(key);
+            const KeyAction action = mapper.GetBinding(virtualKey);
+            if (action != KeyAction::None && down.Test(virtualKey) && !previous.Test(virtualKey))
+            {
+                actions |= KeyboardMapper::ActionBit(action);
+            }
+        }
+        return actions;
+    }
+
+    bool CheckStreams()
+    {
+        constexpr size_t polls = 200000;
+        constexpr uint64_t streams = 8;
+
+        size_t mismatches = 0;
+        size_t actionPolls = 0;
+        for (uint64_t seed = 0; seed < streams; ++seed)
+        {
+            const std::vector<KeyBits> stream = MakeStream(polls, seed);
+            KeyboardMapper mapper;
+            KeyBits previous = {};
+            for (const KeyBits& down : stream)
+            {
+                const uint32_t expected = ReferenceActions(mapper, down, previous);
+                const uint32_t actions = mapper.Update(down);
+                mismatches += (actions != expected) ? 1 : 0;
+                actionPolls += (actions != 0) ? 1 : 0;
+                previous = down;
+            }
+        }
+
+        printf("streams:        %llu polls, %zu with actions, %zu mismatches  %s\n",
+            static_cast<unsigned long long>(polls * streams), actionPolls, mismatches, mismatches == 0 ? "ok" : "FAILED");
+        return mismatches == 0;
+    }
+
+    void MeasureUpdate()
+    {
+        constexpr size_t polls = 1 << 16;
+        constexpr int passes = 64;
+        const std::vector<KeyBits> stream = MakeStream(polls, 99);
+
+        KeyboardMapper mapper;
+        uint32_t sink = 0;
+        Bench::Stopwatch timer;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            for (const KeyBits& down : stream)
+            {
+                sink += mapper.Update(down);
+            }
+        }
+        const double mapperNs = timer.ElapsedSeconds() * 1e9 / (static_cast<double>(polls) * passes);
+
+        KeyBits previous = {};
+        timer.Restart();
+        for (const KeyBits& down : stream)
+        {
+            sink += ReferenceActions(mapper, down, previous);
+            previous = down;
+        }
+        const double referenceNs = timer.ElapsedSeconds() * 1e9 / static_cast<double>(polls);
+
+        Bench::DoNotOptimize(sink);
+        printf("update:         %.2f ns/poll (per-key reference %.1f ns/poll)\n", mapperNs, referenceNs);
+    }
+}
+
+int RunKeyboardBench()
+{
+    bool ok = true;
+    ok &= CheckAliasing();
+    ok &= CheckStreams();
+    MeasureUpdate();
+    return ok ? 0 : 1;
+}
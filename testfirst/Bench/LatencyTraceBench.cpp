@@ -0,0 +1,213 @@
+//
+// LatencyTraceBench.cpp
+// Input latency instrumentation: histogram percentiles against exact ones, stage
+// bookkeeping on a scripted pipeline, the per-frame cost of tracing, and (when
+// built with SNAKE_LATENCY_TRACE) a live SimulationThread traced end to end
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "LatencyTrace.h"
+#include "SimulationThread.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Log-uniform durations from 1 us to 1 s: every percentile must land in its
+    // bucket (at most 25% above the exact value)
+    bool CheckHistogram()
+    {
+        constexpr size_t samples = 200000;
+
+        Pcg32 random(5);
+        LatencyHistogram histogram;
+        std::vector<uint64_t> durations;
+        durations.reserve(samples);
+        uint64_t total = 0;
+        for (size_t i = 0; i < samples; ++i)
+        {
+            const double exponent = 3.0 + 6.0 * random.NextBelow(1u << 20) / static_cast<double>(1u << 20);
+            const uint64_t ns = static_cast<uint64_t>(std::pow(10.0, exponent));
+            histogram.Add(ns);
+            durations.push_back(ns);
+            total += ns;
+        }
+        std::sort(durations.begin(), durations.end());
+
+        int outside = 0;
+        const double percentiles[] = { 0.01, 0.1, 0.5, 0.9, 0.99, 0.999 };
+        for (double p : percentiles)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(p * samples)) - 1;
+            const double exactMs = static_cast<double>(durations[rank]) * 1e-6;
+            const double ms = histogram.GetPercentileMs(p);
+            outside += (ms < exactMs - 1e-3 || ms > exactMs * 1.25 + 1e-3) ? 1 : 0;
+        }
+        const double exactMeanMs = static_cast<double>(total) * 1e-6 / samples;
+        const bool ok = outside == 0 && histogram.GetCount() == samples
+            && std::fabs(histogram.GetMeanMs() - exactMeanMs) < 1e-9 * exactMeanMs + 1e-9
+            && histogram.GetMaxMs() == static_cast<double>(durations.back()) * 1e-6;
+
+        char line[128];
+        histogram.Format(line, sizeof(line));
+        printf("histogram:      %s  percentiles outside bucket %d  %s\n", line, outside, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Scripted pipeline with fixed stage times: one turn polled per frame, every
+    // fourth one dropped by the snake's queue, the rest stepped a frame later and
+    // drawn by the following frame. Each stage must come out at exactly its time.
+    bool CheckTracker()
+    {
+        constexpr int frames = 10000;
+        constexpr uint64_t frameNs = 16666667;
+        const uint64_t stageNs[c_latencyStageCount] = { 0, 3000000, 2000000, 50000000, 6000000, 4000000 };
+
+        LatencyTracker tracker;
+        std::vector<TurnTrace> inFlight;  // Queued by the "simulation", stepped next frame
+        uint64_t expectedTurns = 0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const uint64_t frameStart = 1000000000ull + static_cast<uint64_t>(frame) * frameNs;
+
+            // Steps from the simulation, then draw and present them
+            uint32_t lastStepped = 0;
+            for (const TurnTrace& trace : inFlight)
+            {
+                tracker.OnStepped(trace);
+                lastStepped = trace.id;
+            }
+            inFlight.clear();
+            tracker.OnRendered(lastStepped, frameStart + stageNs[1] + stageNs[2] + stageNs[3] + stageNs[4]);
+            tracker.OnPresented(frameStart + stageNs[1] + stageNs[2] + stageNs[3] + stageNs[4] + stageNs[5]);
+
+            // This frame's turn, timed to reach Stepped just as the next frame starts
+            // drawing (the stamps are synthetic, so they may run ahead of the frame)
+            const uint64_t reading = frameStart + frameNs;
+            TurnTrace trace = tracker.BeginTurn(reading, reading + stageNs[1]);
+            if ((frame % 4) != 3)
+            {
+                trace.Stamp(LatencyStage::Queued, trace.GetStamp(LatencyStage::Polled) + stageNs[2]);
+                trace.Stamp(LatencyStage::Stepped, trace.GetStamp(LatencyStage::Queued) + stageNs[3]);
+                inFlight.push_back(trace);
+                expectedTurns += (frame + 1 < frames) ? 1 : 0;
+            }
+        }
+
+        int wrong = 0;
+        uint64_t expectedTotal = 0;
+        for (size_t stage = 1; stage < c_latencyStageCount; ++stage)
+        {
+            const LatencyHistogram& histogram = tracker.GetStage(static_cast<LatencyStage>(stage));
+            wrong += (histogram.GetCount() != expectedTurns || histogram.GetMaxMs() != stageNs[stage] * 1e-6) ? 1 : 0;
+            expectedTotal += stageNs[stage];
+        }
+        wrong += (tracker.GetTotal().GetCount() != expectedTurns || tracker.GetTotal().GetMaxMs() != expectedTotal * 1e-6) ? 1 : 0;
+
+        const bool ok = wrong == 0 && tracker.GetDroppedCount() == 0;
+        printf("tracker:        %llu turns of %d polled, stages off %d  %s\n",
+            static_cast<unsigned long long>(tracker.GetTotal().GetCount()), frames, wrong, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Everything tracing adds to one frame with a turn in it: the clock reads and
+    // tracker calls on the main thread plus the two stamps on the simulation thread
+    bool MeasureFrameCost()
+    {
+        constexpr int frames = 1000000;
+        constexpr double budgetNs = 1000.0;
+
+        LatencyTracker tracker;
+        Bench::Stopwatch timer;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const uint64_t polled = LatencyNow();
+            TurnTrace trace = tracker.BeginTurn(polled, polled);
+            trace.Stamp(LatencyStage::Queued, LatencyNow());
+            trace.Stamp(LatencyStage::Stepped, LatencyNow());
+            tracker.OnStepped(trace);
+            tracker.OnRendered(trace.id, LatencyNow());
+            tracker.OnPresented(LatencyNow());
+        }
+        const double frameNs = timer.ElapsedSeconds() * 1e9 / frames;
+        Bench::DoNotOptimize(tracker);
+
+        const bool ok = frameNs < budgetNs;
+        printf("frame cost:     %.1f ns/frame with a turn (budget %.0f ns)  %s\n", frameNs, budgetNs, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+#if SNAKE_LATENCY_TRACE
+    // Steer a live SimulationThread (as SimThreadBench does) with traced input,
+    // "rendering" once a millisecond, and report what the tracker saw. The board is
+    // small so the cycle turns every few steps.
+    bool RunLivePipeline()
+    {
+        constexpr int screenWidth = 160;
+        constexpr int screenHeight = 160;
+        constexpr double runSeconds = 2.0;
+
+        auto simulation = std::make_unique<SimulationThread>();
+        simulation->Start(screenWidth, screenHeight, 1);
+        const int gridWidth = screenWidth / static_cast<int>(SnakeGame::c_cellSize);
+        const int gridHeight = screenHeight / static_cast<int>(SnakeGame::c_cellSize);
+
+        LatencyTracker tracker;
+        InputState start = {};
+        start.startPressed = true;
+        simulation->PushInput(start);
+
+        Bench::Stopwatch timer;
+        while (timer.ElapsedSeconds() < runSeconds)
+        {
+            const GameSessionSnapshot& snapshot = simulation->AcquireSnapshot();
+            TurnTrace stepped;
+            while (simulation->PopSteppedTurn(stepped))
+            {
+                tracker.OnStepped(stepped);
+            }
+            tracker.OnRendered(snapshot.lastSteppedTurn, LatencyNow());
+            tracker.OnPresented(LatencyNow());
+
+            if (snapshot.state == GameState::Playing && !snapshot.segments.empty())
+            {
+                const GridCell head = snapshot.segments[0];
+                InputState input = {};
+                input.dir = Bench::HamiltonianDirection(head.x, head.y, gridWidth, gridHeight);
+                const uint64_t now = LatencyNow();
+                simulation->PushInput(input, tracker.BeginTurn(now, now));
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        simulation->Stop();
+
+        printf("live pipeline:\n");
+        tracker.Dump(stdout);
+        const bool ok = tracker.GetTotal().GetCount() > 0;
+        printf("live pipeline:  %llu turns traced  %s\n",
+            static_cast<unsigned long long>(tracker.GetTotal().GetCount()), ok ? "ok" : "FAILED");
+        return ok;
+    }
+#endif
+}
+
+int RunLatencyTraceBench()
+{
+    bool ok = true;
+    ok &= CheckHistogram();
+    ok &= CheckTracker();
+    ok &= MeasureFrameCost();
+#if SNAKE_LATENCY_TRACE
+    ok &= RunLivePipeline();
+#else
+    printf("live pipeline:  skipped (configure with -DENABLE_LATENCY_TRACE=ON)\n");
+#endif
+    return ok ? 0 : 1;
+}
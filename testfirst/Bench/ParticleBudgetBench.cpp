@@ -0,0 +1,282 @@
+//
+// ParticleBudgetBench.cpp
+// ParticleBudget: the count cap split by priority only under pressure, the time
+// limit following scripted update costs, the count-only default giving the same
+// particles every run, and Effects2D held to a tight update budget under load
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "Effects2D.h"
+#include "ParticleBudget.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr float c_frameSeconds = 1.0f / 60.0f;
+
+    // One burst emitter and one running emitter per priority
+    const char* const c_loadEmitters =
+        "emitter p0\npriority 0\nburst 20\nlifetime 1 1\nspeed 50 100\n"
+        "emitter p1\npriority 1\nburst 20\nlifetime 1 1\nspeed 50 100\n"
+        "emitter p2\npriority 2\nburst 20\nlifetime 1 1\nspeed 50 100\n"
+        "emitter p3\npriority 3\nburst 20\nlifetime 1 1\nspeed 50 100\n"
+        "emitter trail0\npriority 0\nrate 200 2\nlifetime 1 1\nspeed 10 20\n"
+        "emitter trail3\npriority 3\nrate 200 2\nlifetime 1 1\nspeed 10 20\n";
+
+    // Bursts per priority whose particles die spread out, so the cap stays
+    // contended every frame instead of freeing in waves
+    const char* const c_priorityEmitters =
+        "emitter p0\npriority 0\nburst 20\nlifetime 0.5 1.5\nspeed 50 100\n"
+        "emitter p1\npriority 1\nburst 20\nlifetime 0.5 1.5\nspeed 50 100\n"
+        "emitter p2\npriority 2\nburst 20\nlifetime 0.5 1.5\nspeed 50 100\n"
+        "emitter p3\npriority 3\nburst 20\nlifetime 0.5 1.5\nspeed 50 100\n";
+
+    // Equal bursts at every priority against a 1000-particle cap and no time
+    // limit: the cap holds and, once it is full, the lower the priority the more
+    // is thinned (while it fills, every burst fits and nothing is)
+    bool CheckPriorities()
+    {
+        constexpr size_t cap = 1000;
+
+        Effects2D effects;
+        effects.SetEmitterLibrary(EmitterLibrary::Parse(c_priorityEmitters));
+        effects.SetParticleBudget(ParticleBudgetSettings{ cap, 0.0 });
+        effects.Reset(1);
+
+        size_t peak = 0;
+        for (int frame = 0; frame < 600; ++frame)
+        {
+            for (size_t emitter = 0; emitter < 4; ++emitter)
+            {
+                effects.Emit(emitter, Float2{ 400.0f, 300.0f });
+            }
+            effects.Update(c_frameSeconds);
+            peak = std::max(peak, effects.GetParticleCount());
+        }
+
+        const ParticleBudgetCounters& counters = effects.GetParticleBudget().GetCounters();
+        bool ordered = true;
+        printf("priorities:     cap %zu, peak %zu live\n", cap, peak);
+        for (size_t priority = 0; priority < ParticleBudget::c_priorityCount; ++priority)
+        {
+            printf("    priority %zu: %6llu requested, %5.1f%% thinned, %5.1f%% shortened\n", priority,
+                static_cast<unsigned long long>(counters.requested[priority]),
+                100.0 * counters.thinned[priority] / counters.requested[priority],
+                100.0 * counters.shortened[priority] / counters.requested[priority]);
+            ordered &= priority == 0 || counters.thinned[priority] <= counters.thinned[priority - 1];
+        }
+        // Ties are fine below the top, whose requests are never held back for another
+        constexpr size_t top = ParticleBudget::c_priorityCount - 1;
+        ordered &= counters.thinned[top] < counters.thinned[top - 1];
+
+        const bool ok = peak <= cap && ordered && counters.thinned[0] > 0;
+        printf("priorities:     cap held %s, thinned in priority order %s  %s\n",
+            peak <= cap ? "yes" : "no", ordered ? "yes" : "no", ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // One priority-0 emitter and nothing else: with no pressure it may fill the
+    // whole cap, and only what does not fit is thinned
+    bool CheckUncontended()
+    {
+        constexpr size_t cap = 1000;
+
+        Effects2D effects;
+        effects.SetEmitterLibrary(EmitterLibrary::Parse(c_loadEmitters));
+        effects.SetParticleBudget(ParticleBudgetSettings::Deterministic(cap));
+        effects.Reset(3);
+
+        size_t peak = 0;
+        for (int frame = 0; frame < 120; ++frame)
+        {
+            effects.Emit(0, Float2{ 400.0f, 300.0f });
+            effects.Update(c_frameSeconds);
+            peak = std::max(peak, effects.GetParticleCount());
+        }
+
+        const ParticleBudgetCounters& counters = effects.GetParticleBudget().GetCounters();
+        const double thinned = 100.0 * counters.thinned[0] / counters.requested[0];
+        const bool ok = peak == cap && thinned < 50.0;
+        printf("uncontended:    priority 0 alone peaks at %zu of %zu, %.1f%% thinned  %s\n", peak, cap, thinned, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Scripted update times against a 50 us budget: a single stall cuts nothing,
+    // a sustained overrun cuts the limit to what the smoothed cost affords, and
+    // frames within budget raise it back gradually
+    bool CheckTimeLimit()
+    {
+        constexpr size_t cap = 100000;
+        ParticleBudget budget(ParticleBudgetSettings{ cap, 0.05 });
+        const size_t unmeasured = budget.GetLimit();
+
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            budget.OnUpdate(40e-6, 1000);  // 40 ns a particle: within budget
+        }
+        budget.OnUpdate(2e-3, 1000);  // One preempted frame
+        const size_t stall = budget.GetLimit();
+        const ParticleBudget::Grant afterStall = budget.Request(3, 12, 1000);
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            budget.OnUpdate(40e-6, 1000);
+        }
+
+        size_t overrun = cap;
+        for (uint32_t frame = 0; frame < ParticleBudget::c_sustainedOverrun; ++frame)
+        {
+            budget.OnUpdate(100e-6, 1000);  // 100 ns a particle: 500 fit
+            overrun = budget.GetLimit();
+        }
+
+        int framesToRecover = 0;
+        while (budget.GetLimit() < cap && framesToRecover < 1000)
+        {
+            budget.OnUpdate(10e-6, 100);
+            framesToRecover++;
+        }
+
+        const bool ok = unmeasured == cap && stall == cap && afterStall.count == 12 && overrun == 500
+            && framesToRecover > 50 && framesToRecover < 200
+            && budget.GetCounters().framesOverBudget == 1 + ParticleBudget::c_sustainedOverrun;
+        printf("time limit:     unmeasured %zu, after a stall %zu (eat burst %zu of 12), sustained overrun %zu, back to %zu in %d frames  %s\n",
+            unmeasured, stall, afterStall.count, overrun, cap, framesToRecover, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Two runs of the same seed and emits with the default (count-only) budget
+    // give the same particles bit for bit, however long each Update took
+    bool CheckDeterministic()
+    {
+        std::vector<Particle> runs[2];
+        for (std::vector<Particle>& particles : runs)
+        {
+            Effects2D effects;
+            effects.SetEmitterLibrary(EmitterLibrary::Parse(c_loadEmitters));
+            effects.Reset(4);
+            for (int frame = 0; frame < 300; ++frame)
+            {
+                for (size_t emitter = 0; emitter < 4; ++emitter)
+                {
+                    effects.Emit(emitter, Float2{ 400.0f, 300.0f });
+                }
+                if ((frame % 60) == 0)
+                {
+                    effects.Emit(static_cast<size_t>(effects.GetEmitterLibrary().Find("trail0")), Float2{ 200.0f, 100.0f });
+                }
+                effects.Update(c_frameSeconds);
+            }
+            effects.ExportParticles(particles);
+        }
+
+        const bool ok = !runs[0].empty() && runs[0].size() == runs[1].size()
+            && memcmp(runs[0].data(), runs[1].data(), runs[0].size() * sizeof(Particle)) == 0;
+        printf("deterministic:  default budget, %zu particles after 300 frames, runs %s  %s\n", runs[0].size(),
+            ok ? "identical" : "DIFFER", ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    struct LoadResult
+    {
+        double meanUs;
+        double p95Us;
+        size_t meanLive;
+    };
+
+    // Running emitters at the lowest and highest priority restarted as they end,
+    // plus a burst of each priority every frame; Update times from the second
+    // half (after the limit has settled)
+    LoadResult RunLoad(double budgetMs, ParticleBudgetCounters& counters)
+    {
+        constexpr int frames = 1200;
+
+        Effects2D effects;
+        effects.SetEmitterLibrary(EmitterLibrary::Parse(c_loadEmitters));
+        effects.SetParticleBudget(ParticleBudgetSettings{ Effects2D::c_maxParticles, budgetMs });
+        effects.Reset(2);
+        const size_t trail0 = static_cast<size_t>(effects.GetEmitterLibrary().Find("trail0"));
+        const size_t trail3 = static_cast<size_t>(effects.GetEmitterLibrary().Find("trail3"));
+
+        std::vector<double> times;
+        size_t live = 0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            while (effects.GetEmitterCount() < Effects2D::c_maxEmitters)
+            {
+                effects.Emit((effects.GetEmitterCount() & 1) ? trail3 : trail0, Float2{ 400.0f, 300.0f });
+            }
+            for (size_t emitter = 0; emitter < 4; ++emitter)
+            {
+                effects.Emit(emitter, Float2{ 200.0f, 200.0f });
+            }
+
+            Bench::Stopwatch timer;
+            effects.Update(c_frameSeconds);
+            const double seconds = timer.ElapsedSeconds();
+            if (frame >= frames / 2)
+            {
+                times.push_back(seconds * 1e6);
+                live += effects.GetParticleCount();
+            }
+        }
+        counters = effects.GetParticleBudget().GetCounters();
+
+        std::sort(times.begin(), times.end());
+        double total = 0.0;
+        for (double us : times)
+        {
+            total += us;
+        }
+        return LoadResult{ total / times.size(), times[times.size() * 95 / 100], live / times.size() };
+    }
+
+    // The same overload with the time budget off and then at about a third of
+    // what it takes: the budgeted run must come out cheaper, and by shedding
+    bool CheckUnderLoad()
+    {
+        ParticleBudgetCounters unlimitedCounters;
+        const LoadResult unlimited = RunLoad(0.0, unlimitedCounters);
+        const double budgetMs = unlimited.meanUs * 1e-3 / 3.0;
+        ParticleBudgetCounters counters;
+        const LoadResult budgeted = RunLoad(budgetMs, counters);
+
+        uint64_t requested = 0;
+        uint64_t thinned = 0;
+        for (size_t priority = 0; priority < ParticleBudget::c_priorityCount; ++priority)
+        {
+            requested += counters.requested[priority];
+            thinned += counters.thinned[priority];
+        }
+
+        printf("\n%-10s %10s %10s %10s %12s\n", "budget", "mean us", "p95 us", "live", "over budget");
+        printf("%-10s %10.2f %10.2f %10zu %12s\n", "none", unlimited.meanUs, unlimited.p95Us, unlimited.meanLive, "-");
+        printf("%7.1f us %10.2f %10.2f %10zu %11.1f%%\n", budgetMs * 1e3, budgeted.meanUs, budgeted.p95Us, budgeted.meanLive,
+            100.0 * counters.framesOverBudget / counters.frames);
+        printf("shed:           %.1f%% of %llu requested, thinned p0 %llu p3 %llu, %llu requests thinned\n",
+            100.0 * thinned / requested, static_cast<unsigned long long>(requested),
+            static_cast<unsigned long long>(counters.thinned[0]), static_cast<unsigned long long>(counters.thinned[3]),
+            static_cast<unsigned long long>(counters.thinnedRequests));
+
+        const bool ok = budgeted.meanUs < unlimited.meanUs && budgeted.meanLive < unlimited.meanLive
+            && counters.thinned[0] > counters.thinned[3];
+        printf("under load:     %.2f us -> %.2f us per update  %s\n", unlimited.meanUs, budgeted.meanUs, ok ? "ok" : "FAILED");
+        return ok;
+    }
+}
+
+int RunParticleBudgetBench()
+{
+    bool ok = true;
+    ok &= CheckPriorities();
+    ok &= CheckUncontended();
+    ok &= CheckTimeLimit();
+    ok &= CheckDeterministic();
+    ok &= CheckUnderLoad();
+    return ok ? 0 : 1;
+}
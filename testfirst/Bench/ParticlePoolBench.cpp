@@ -0,0 +1,233 @@
+//
+// ParticlePoolBench.cpp
+// ParticlePool against the vector-of-structs particles Effects2D used before it:
+// same particles after the same frames, then the cost of a steady-state frame
+// from 100 to 1M live particles
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "ParticlePool.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    constexpr float c_frameSeconds = 1.0f / 60.0f;
+    constexpr float c_lifetime = 0.6f;
+    constexpr size_t c_burst = 12;
+
+    // The particles and Update loop Effects2D had before ParticlePool: 48-byte
+    // records, expired ones erased from the middle of the vector
+    struct LegacyParticle
+    {
+        Float2 pos;
+        Float2 velocity;
+        Float4 color;
+        float lifetime;
+        float maxLifetime;
+        float size;
+    };
+
+    void LegacyUpdate(std::vector<LegacyParticle>& particles, float elapsedTime)
+    {
+        for (auto it = particles.begin(); it != particles.end();)
+        {
+            LegacyParticle& p = *it;
+            p.lifetime -= elapsedTime;
+
+            if (p.lifetime <= 0.0f)
+            {
+                it = particles.erase(it);
+            }
+            else
+            {
+                p.pos.x += p.velocity.x * elapsedTime;
+                p.pos.y += p.velocity.y * elapsedTime;
+                p.color.w = p.lifetime / p.maxLifetime;
+                ++it;
+            }
+        }
+    }
+
+    // One burst's particles, spawned identically into either container
+    struct Spawn
+    {
+        Float2 pos;
+        Float2 velocity;
+        float lifetime;
+        float size;
+    };
+
+    Spawn MakeSpawn(Pcg32& random, Float2 pos, float lifetime)
+    {
+        const float angle = random.NextFloat() * 6.283185307f;
+        const float speed = 150.0f * (0.5f + random.NextFloat() * 0.5f);
+        return Spawn{ pos, Float2{ cosf(angle) * speed, sinf(angle) * speed }, lifetime,
+            12.0f + static_cast<float>(random.NextBelow(12)) };
+    }
+
+    void Add(ParticlePool& pool, const Spawn* spawns, size_t count)
+    {
+        const size_t first = pool.Append(count);
+        for (size_t i = first; i < pool.GetCount(); ++i)
+        {
+            const Spawn& spawn = spawns[i - first];
+            pool.Set(i, spawn.pos, spawn.velocity, spawn.lifetime, spawn.size, 0);
+        }
+    }
+
+    void Add(std::vector<LegacyParticle>& particles, const Spawn* spawns, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Spawn& spawn = spawns[i];
+            particles.push_back(LegacyParticle{ spawn.pos, spawn.velocity, Float4{ 1.0f, 0.84f, 0.0f, 1.0f },
+                spawn.lifetime, spawn.lifetime, spawn.size });
+        }
+    }
+
+    // Bursts of c_burst particles at random points until `target` are alive, with
+    // lifetimes spread over (0, c_lifetime] so a steady share expires every frame
+    template<typename Container>
+    void TopUp(Container& particles, size_t live, size_t target, Pcg32& random)
+    {
+        Spawn spawns[c_burst];
+        while (live < target)
+        {
+            const size_t count = std::min(c_burst, target - live);
+            const Float2 pos = { static_cast<float>(random.NextBelow(800)), static_cast<float>(random.NextBelow(600)) };
+            const float lifetime = c_lifetime * (1.0f - random.NextFloat());
+            for (size_t i = 0; i < count; ++i)
+            {
+                spawns[i] = MakeSpawn(random, pos, lifetime);
+            }
+            Add(particles, spawns, count);
+            live += count;
+        }
+    }
+
+    // Same spawns into both, bursts every few frames: the live particles (compared
+    // as sorted sets, since the pool does not keep order) must match every frame.
+    // The pool draws color from a curve table, so fade is compared as the share of
+    // life used rather than as drawn alpha.
+    bool CheckAgainstLegacy()
+    {
+        constexpr int frames = 600;
+
+        ParticlePool pool(4096);
+        std::vector<LegacyParticle> legacy;
+        Pcg32 random(3);
+        Spawn spawns[c_burst];
+
+        int mismatchedFrames = 0;
+        size_t peak = 0;
+        std::vector<Float4> a;
+        std::vector<Float4> b;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const uint32_t bursts = random.NextBelow(4);
+            for (uint32_t burst = 0; burst < bursts; ++burst)
+            {
+                const Float2 pos = { static_cast<float>(random.NextBelow(800)), static_cast<float>(random.NextBelow(600)) };
+                for (Spawn& spawn : spawns)
+                {
+                    spawn = MakeSpawn(random, pos, c_lifetime * (0.25f + 0.75f * random.NextFloat()));
+                }
+                Add(pool, spawns, c_burst);
+                Add(legacy, spawns, c_burst);
+            }
+
+            pool.Update(c_frameSeconds);
+            LegacyUpdate(legacy, c_frameSeconds);
+            peak = std::max(peak, pool.GetCount());
+
+            a.clear();
+            b.clear();
+            for (size_t i = 0; i < pool.GetCount(); ++i)
+            {
+                const Float2 pos = pool.GetPosition(i);
+                a.push_back(Float4{ pos.x, pos.y, pool.GetSize(i), pool.GetLifeFraction(i) });
+            }
+            for (const LegacyParticle& p : legacy)
+            {
+                b.push_back(Float4{ p.pos.x, p.pos.y, p.size, 1.0f - p.color.w });
+            }
+            auto byPosition = [](const Float4& l, const Float4& r) { return (l.x != r.x) ? l.x < r.x : (l.y != r.y) ? l.y < r.y : l.z < r.z; };
+            std::sort(a.begin(), a.end(), byPosition);
+            std::sort(b.begin(), b.end(), byPosition);
+
+            bool same = a.size() == b.size();
+            for (size_t i = 0; same && i < a.size(); ++i)
+            {
+                same = a[i].x == b[i].x && a[i].y == b[i].y && a[i].z == b[i].z && std::fabs(a[i].w - b[i].w) < 1e-5f;
+            }
+            mismatchedFrames += same ? 0 : 1;
+        }
+
+        const bool ok = mismatchedFrames == 0;
+        printf("vs legacy:      %d frames, peak %zu particles, %d frames differ  %s\n",
+            frames, peak, mismatchedFrames, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Mean time of a steady-state frame (update, then bursts to replace what
+    // expired) with `count` particles alive, over at least minSeconds
+    template<typename Container>
+    double MeasureFrame(Container& particles, size_t count, double minSeconds)
+    {
+        Pcg32 random(9);
+        TopUp(particles, 0, count, random);
+
+        int frames = 0;
+        Bench::Stopwatch timer;
+        do
+        {
+            if constexpr (std::is_same_v<Container, ParticlePool>)
+            {
+                particles.Update(c_frameSeconds);
+                TopUp(particles, particles.GetCount(), count, random);
+            }
+            else
+            {
+                LegacyUpdate(particles, c_frameSeconds);
+                TopUp(particles, particles.size(), count, random);
+            }
+            frames++;
+        } while (timer.ElapsedSeconds() < minSeconds || frames < 3);
+
+        return timer.ElapsedSeconds() * 1e6 / frames;
+    }
+}
+
+int RunParticlePoolBench()
+{
+    const bool ok = CheckAgainstLegacy();
+
+    // The legacy loop is quadratic (each erase shifts the tail), so it stops at 100k
+    constexpr size_t legacyLimit = 100000;
+    printf("\n%10s %14s %14s %10s\n", "particles", "pool us/frame", "legacy us/frame", "speedup");
+    const size_t counts[] = { 100, 1000, 10000, 100000, 1000000 };
+    for (size_t count : counts)
+    {
+        ParticlePool pool(count);
+        const double poolUs = MeasureFrame(pool, count, 0.2);
+        if (count <= legacyLimit)
+        {
+            std::vector<LegacyParticle> legacy;
+            const double legacyUs = MeasureFrame(legacy, count, 0.2);
+            printf("%10zu %14.2f %14.2f %9.1fx\n", count, poolUs, legacyUs, legacyUs / poolUs);
+        }
+        else
+        {
+            printf("%10zu %14.2f %14s %10s\n", count, poolUs, "-", "-");
+        }
+    }
+
+    return ok ? 0 : 1;
+}
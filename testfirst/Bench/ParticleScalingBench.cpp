@@ -0,0 +1,135 @@
+//
+// ParticleScalingBench.cpp
+// ParticlePool::Update on a ThreadPool: identical results for every thread count,
+// then update time from 1 to 16 threads and 10k to 2M particles
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "ParticlePool.h"
+#include "ThreadPool.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    constexpr float c_frameSeconds = 1.0f / 60.0f;
+    constexpr float c_lifetime = 0.6f;
+
+    // Fill the pool up to `target` with lifetimes spread over (0, c_lifetime], so
+    // a steady share expires every frame
+    void TopUp(ParticlePool& particles, size_t target, Pcg32& random)
+    {
+        const size_t first = particles.Append(target - std::min(target, particles.GetCount()));
+        for (size_t i = first; i < particles.GetCount(); ++i)
+        {
+            const float angle = random.NextFloat() * 6.283185307f;
+            const float speed = 150.0f * (0.5f + random.NextFloat() * 0.5f);
+            const Float2 pos = { static_cast<float>(random.NextBelow(800)), static_cast<float>(random.NextBelow(600)) };
+            particles.Set(i, pos, Float2{ cosf(angle) * speed, sinf(angle) * speed },
+                c_lifetime * (1.0f - random.NextFloat()), 12.0f, 0);
+        }
+    }
+
+    // Same seeds, same frames: every particle must match the inline run bit for bit
+    bool CheckDeterminism()
+    {
+        constexpr size_t count = 300000;
+        constexpr int frames = 40;
+        const size_t threadCounts[] = { 0, 1, 3, 8, 16 };  // 0 = inline
+
+        std::unique_ptr<ParticlePool> reference;
+        int mismatches = 0;
+        for (size_t threads : threadCounts)
+        {
+            std::unique_ptr<ThreadPool> pool = threads ? std::make_unique<ThreadPool>(threads) : nullptr;
+            auto particles = std::make_unique<ParticlePool>(count);
+            Pcg32 random(21);
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                TopUp(*particles, count, random);
+                particles->Update(c_frameSeconds, pool.get());
+            }
+
+            if (!reference)
+            {
+                reference = std::move(particles);
+                continue;
+            }
+
+            bool same = particles->GetCount() == reference->GetCount();
+            for (size_t i = 0; same && i < particles->GetCount(); ++i)
+            {
+                const Float2 a = particles->GetPosition(i);
+                const Float2 b = reference->GetPosition(i);
+                const float lifetimes[2] = { particles->GetLifetime(i), reference->GetLifetime(i) };
+                same = memcmp(&a, &b, sizeof(a)) == 0 && memcmp(&lifetimes[0], &lifetimes[1], sizeof(float)) == 0;
+            }
+            mismatches += same ? 0 : 1;
+        }
+
+        const bool ok = mismatches == 0;
+        printf("determinism:    %zu particles x %d frames, inline vs 1/3/8/16 threads, %d differ  %s\n",
+            count, frames, mismatches, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Mean Update time (the top-up between frames is not timed)
+    double MeasureUpdate(size_t count, ThreadPool* pool)
+    {
+        ParticlePool particles(count);
+        Pcg32 random(4);
+        TopUp(particles, count, random);
+
+        double seconds = 0.0;
+        int frames = 0;
+        while (seconds < 0.15 || frames < 5)
+        {
+            Bench::Stopwatch timer;
+            particles.Update(c_frameSeconds, pool);
+            seconds += timer.ElapsedSeconds();
+            frames++;
+            TopUp(particles, count, random);
+        }
+        return seconds * 1e3 / frames;
+    }
+}
+
+int RunParticleScalingBench()
+{
+    const bool ok = CheckDeterminism();
+
+    const size_t threadCounts[] = { 1, 2, 4, 8, 16 };
+    std::unique_ptr<ThreadPool> pools[5];
+    for (size_t i = 0; i < 5; ++i)
+    {
+        pools[i] = std::make_unique<ThreadPool>(threadCounts[i]);
+    }
+
+    printf("\nms/update (hardware threads: %u)\n%10s %9s", std::thread::hardware_concurrency(), "particles", "inline");
+    for (size_t threads : threadCounts)
+    {
+        printf(" %7zut", threads);
+    }
+    printf("\n");
+
+    const size_t counts[] = { 10000, 100000, 500000, 1000000, 2000000 };
+    for (size_t count : counts)
+    {
+        printf("%10zu %9.3f", count, MeasureUpdate(count, nullptr));
+        for (const auto& pool : pools)
+        {
+            printf(" %8.3f", MeasureUpdate(count, pool.get()));
+        }
+        printf("\n");
+    }
+    printf("(below %zu particles Update runs inline whatever the pool)\n", ParticlePool::c_minParallelCount);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+//
+// RandomBench.cpp
+// Global rand() vs a per-thread Pcg32, from one to several threads
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "Random.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int c_drawsPerThread = 4000000;
+    constexpr uint32_t c_bound = 1000;  // Typical free-cell-set sized draw
+
+    // Runs `work(threadIndex)` on `threadCount` threads and returns the wall time
+    template<typename TWork>
+    double RunThreads(unsigned int threadCount, const TWork& work)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+
+        Bench::Stopwatch timer;
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&work, t]() { work(t); });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        return timer.ElapsedSeconds();
+    }
+}
+
+int RunRandomBench()
+{
+    const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> threadCounts = { 1, 2, 4, 8 };
+    if (hardwareThreads > 8)
+        threadCounts.push_back(hardwareThreads);
+
+    printf("%8s %18s %18s %8s\n", "threads", "rand() draws/s", "Pcg32 draws/s", "speedup");
+
+    for (unsigned int threadCount : threadCounts)
+    {
+        std::vector<uint64_t> sums(threadCount, 0);
+
+        // Global rand(): one shared state (locked in most CRTs)
+        const double randSeconds = RunThreads(threadCount, [&sums](unsigned int t)
+        {
+            uint64_t sum = 0;
+            for (int i = 0; i < c_drawsPerThread; ++i)
+            {
+                sum += static_cast<uint32_t>(rand()) % c_bound;
+            }
+            sums[t] = sum;
+        });
+        Bench::DoNotOptimize(sums);
+
+        // One generator per thread, as each SnakeGame owns one
+        const double pcgSeconds = RunThreads(threadCount, [&sums](unsigned int t)
+        {
+            Pcg32 random(t);
+            uint64_t sum = 0;
+            for (int i = 0; i < c_drawsPerThread; ++i)
+            {
+                sum += random.NextBelow(c_bound);
+            }
+            sums[t] = sum;
+        });
+        Bench::DoNotOptimize(sums);
+
+        const double totalDraws = static_cast<double>(threadCount) * c_drawsPerThread;
+        printf("%8u %18.3e %18.3e %7.1fx\n", threadCount,
+            totalDraws / randSeconds, totalDraws / pcgSeconds, randSeconds / pcgSeconds);
+    }
+
+    printf("(%u hardware threads)\n", hardwareThreads);
+    return 0;
+}
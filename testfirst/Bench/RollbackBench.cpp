@@ -0,0 +1,198 @@
+//
+// RollbackBench.cpp
+// SnakeGame SaveState/LoadState: rollback over a loopback link with artificial latency,
+// and damaged snapshots refused without touching the game
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "SnakeAutopilot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr int c_screenWidth = 800;
+    constexpr int c_screenHeight = 600;
+    constexpr uint64_t c_seed = 99;
+    constexpr size_t c_maxTicks = 20000;
+
+    // One movement step per tick, so every re-simulated tick does real work
+    constexpr float c_tickTime = SnakeGame::c_moveInterval;
+
+    struct LoopbackResult
+    {
+        std::vector<double> rollbackSeconds;  // Load + re-simulation, per rollback
+        double saveSeconds;  // Total time spent in SaveState
+        size_t saves;
+        bool matches;  // Final state equals the reference run's
+    };
+
+    // Reference run: the autopilot plays one game; its per-tick input is the stream
+    // the "remote" end sends
+    std::vector<Direction> RecordInputs(std::vector<uint8_t>& outFinalState)
+    {
+        SnakeGame game;
+        game.Reset(c_screenWidth, c_screenHeight, c_seed);
+        SnakeAutopilot autopilot;
+        autopilot.Reset(game);
+
+        std::vector<Direction> inputs;
+        while (inputs.size() < c_maxTicks && !game.IsGameOver() && !game.IsWon())
+        {
+            const Direction dir = autopilot.Think(game);
+            inputs.push_back(dir);
+            game.QueueDirection(dir);
+            game.Update(c_tickTime);
+        }
+
+        outFinalState.resize(game.GetStateSize());
+        game.SaveState(outFinalState.data(), outFinalState.size());
+        return inputs;
+    }
+
+    // Input for tick t arrives `latency` ticks late. Each tick runs on a prediction
+    // (the last confirmed input); when a confirmation disagrees with what was used,
+    // the game rewinds to the snapshot taken before that tick and re-simulates up to
+    // the present. One snapshot per tick in flight, all allocated up front.
+    LoopbackResult RunLoopback(const std::vector<Direction>& inputs, const std::vector<uint8_t>& referenceState, size_t latency)
+    {
+        SnakeGame game;
+        game.Reset(c_screenWidth, c_screenHeight, c_seed);
+
+        const size_t ticks = inputs.size();
+        const size_t stateSize = game.GetStateSize();
+        const size_t slots = latency + 1;
+        std::vector<uint8_t> snapshots(stateSize * slots);
+        std::vector<Direction> used(ticks);
+
+        LoopbackResult result = {};
+        result.matches = true;
+        result.rollbackSeconds.reserve(ticks);
+
+        auto step = [&](size_t tick, Direction dir)
+        {
+            Bench::Stopwatch timer;
+            game.SaveState(&snapshots[(tick % slots) * stateSize], stateSize);
+            result.saveSeconds += timer.ElapsedSeconds();
+            result.saves++;
+
+            used[tick] = dir;
+            game.QueueDirection(dir);
+            game.Update(c_tickTime);
+        };
+
+        Direction latest = Direction::Right;  // Nothing confirmed yet: keep the initial heading
+        for (size_t now = 0; now < ticks + latency; ++now)
+        {
+            if (now >= latency)
+            {
+                const size_t confirmed = now - latency;
+                latest = inputs[confirmed];
+                if (used[confirmed] != latest)
+                {
+                    Bench::Stopwatch timer;
+                    if (!game.LoadState(&snapshots[(confirmed % slots) * stateSize], stateSize))
+                        result.matches = false;
+                    const size_t end = std::min(now, ticks);
+                    for (size_t tick = confirmed; tick < end; ++tick)
+                    {
+                        step(tick, latest);
+                    }
+                    result.rollbackSeconds.push_back(timer.ElapsedSeconds());
+                }
+            }
+
+            if (now < ticks)
+            {
+                step(now, latest);
+            }
+        }
+
+        std::vector<uint8_t> finalState(stateSize);
+        game.SaveState(finalState.data(), finalState.size());
+        result.matches &= (finalState == referenceState);
+        return result;
+    }
+
+    // Truncated, foreign and corrupt snapshots: each LoadState must return false
+    // and leave the game exactly as it was
+    bool CheckDamagedSnapshots(const std::vector<uint8_t>& referenceState)
+    {
+        SnakeGame game;
+        game.Reset(c_screenWidth, c_screenHeight, c_seed + 1);
+        game.Update(1.0f);
+        std::vector<uint8_t> before(game.GetStateSize());
+        game.SaveState(before.data(), before.size());
+
+        SnakeGame otherBoard;
+        otherBoard.Reset(c_screenWidth + 40, c_screenHeight, c_seed);
+        std::vector<uint8_t> foreign(otherBoard.GetStateSize());
+        otherBoard.SaveState(foreign.data(), foreign.size());
+
+        // The body comes last, head first, with room for the whole board
+        const size_t headOffset = referenceState.size() - static_cast<size_t>(game.GetLayout().CellCount()) * sizeof(GridCell);
+        std::vector<uint8_t> badHead = referenceState;
+        const GridCell offBoard = { 0x7fff, -1 };
+        memcpy(&badHead[headOffset], &offBoard, sizeof(offBoard));
+
+        const std::vector<uint8_t> garbage(referenceState.size(), 0xff);
+
+        int accepted = 0;
+        accepted += game.LoadState(referenceState.data(), referenceState.size() - 1) ? 1 : 0;
+        accepted += game.LoadState(foreign.data(), foreign.size()) ? 1 : 0;
+        accepted += game.LoadState(badHead.data(), badHead.size()) ? 1 : 0;
+        accepted += game.LoadState(garbage.data(), garbage.size()) ? 1 : 0;
+
+        std::vector<uint8_t> after(game.GetStateSize());
+        game.SaveState(after.data(), after.size());
+        const bool untouched = after == before;
+        const bool reloads = game.LoadState(referenceState.data(), referenceState.size());
+
+        const bool ok = accepted == 0 && untouched && reloads;
+        printf("damaged snapshots: %d of 4 accepted, game %s, good snapshot %s  %s\n", accepted,
+            untouched ? "untouched" : "CHANGED", reloads ? "loads" : "REFUSED", ok ? "ok" : "FAILED");
+        return ok;
+    }
+}
+
+int RunRollbackBench()
+{
+    std::vector<uint8_t> referenceState;
+    const std::vector<Direction> inputs = RecordInputs(referenceState);
+
+    int result = CheckDamagedSnapshots(referenceState) ? 0 : 1;
+
+    printf("%zu ticks, %zu byte snapshots\n", inputs.size(), referenceState.size());
+    printf("%8s %10s %10s %10s %10s %10s %8s\n", "latency", "rollbacks", "save us", "mean us", "p99 us", "max us", "match");
+
+    const size_t latencies[] = { 2, 4, 8, 12, 16 };
+    for (size_t latency : latencies)
+    {
+        LoopbackResult run = RunLoopback(inputs, referenceState, latency);
+
+        std::vector<double>& costs = run.rollbackSeconds;
+        const size_t count = costs.size();
+        double total = 0.0;
+        for (double cost : costs)
+        {
+            total += cost;
+        }
+        std::sort(costs.begin(), costs.end());
+        const double p99 = count ? costs[std::min(count - 1, count * 99 / 100)] : 0.0;
+        const double worst = count ? costs.back() : 0.0;
+
+        printf("%8zu %10zu %10.3f %10.3f %10.3f %10.3f %8s\n", latency, count,
+            run.saves ? run.saveSeconds * 1e6 / static_cast<double>(run.saves) : 0.0,
+            count ? total * 1e6 / static_cast<double>(count) : 0.0, p99 * 1e6, worst * 1e6,
+            run.matches ? "yes" : "NO");
+
+        if (!run.matches)
+            result = 1;
+    }
+
+    return result;
+}
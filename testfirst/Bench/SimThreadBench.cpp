@@ -0,0 +1,250 @@
+//
+// SimThreadBench.cpp
+// Stress checks for the simulation thread's channels: SPSC ring order and
+// throughput, triple-buffer torn reads, and a live SimulationThread driven from
+// this thread like Game::Update/Render drive it
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "SimulationThread.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    // Producer pushes 0..count-1, consumer checks it pops exactly that sequence
+    bool RunRingStress()
+    {
+        constexpr uint64_t count = 20000000;
+        auto ring = std::make_unique<SpscRing<uint64_t, 1024>>();
+
+        Bench::Stopwatch timer;
+        std::thread producer([&ring]()
+        {
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                while (!ring->TryPush(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint64_t expected = 0;
+        uint64_t outOfOrder = 0;
+        while (expected < count)
+        {
+            uint64_t value;
+            if (!ring->TryPop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            if (value != expected)
+            {
+                outOfOrder++;
+            }
+            expected = value + 1;
+        }
+        producer.join();
+        const double seconds = timer.ElapsedSeconds();
+
+        const bool ok = outOfOrder == 0 && ring->GetSize() == 0;
+        printf("spsc ring:      %llu items  %.1f M items/s  out of order %llu  %s\n",
+            static_cast<unsigned long long>(count), count / seconds * 1e-6,
+            static_cast<unsigned long long>(outOfOrder), ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Big enough that a torn copy would show up as mixed values
+    struct Payload
+    {
+        uint64_t values[64];
+    };
+
+    // Writer publishes payloads whose every field is the sequence number; the
+    // reader checks each acquired payload is whole and never older than the last
+    bool RunTripleBufferStress()
+    {
+        constexpr uint64_t count = 5000000;
+        auto buffer = std::make_unique<TripleBuffer<Payload>>();
+        for (int i = 0; i < 3; ++i)
+        {
+            for (uint64_t& value : buffer->GetSlot(i).values)
+            {
+                value = 0;
+            }
+        }
+
+        std::atomic<bool> done(false);
+        std::thread writer([&buffer, &done]()
+        {
+            for (uint64_t sequence = 1; sequence <= count; ++sequence)
+            {
+                for (uint64_t& value : buffer->GetBack().values)
+                {
+                    value = sequence;
+                }
+                buffer->Publish();
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+        uint64_t reads = 0;
+        uint64_t torn = 0;
+        uint64_t backwards = 0;
+        uint64_t distinct = 0;
+        uint64_t last = 0;
+        for (bool finished = false; !finished;)
+        {
+            // One more read after the writer is done, so the last value is seen
+            finished = done.load(std::memory_order_acquire);
+
+            const Payload& payload = buffer->Acquire();
+            const uint64_t sequence = payload.values[0];
+            for (uint64_t value : payload.values)
+            {
+                if (value != sequence)
+                {
+                    torn++;
+                    break;
+                }
+            }
+            if (sequence < last)
+            {
+                backwards++;
+            }
+            else if (sequence > last)
+            {
+                distinct++;
+            }
+            last = sequence;
+            reads++;
+        }
+        writer.join();
+
+        const bool ok = torn == 0 && backwards == 0 && last == count;
+        printf("triple buffer:  %llu reads  %llu distinct  torn %llu  backwards %llu  last %llu/%llu  %s\n",
+            static_cast<unsigned long long>(reads), static_cast<unsigned long long>(distinct),
+            static_cast<unsigned long long>(torn), static_cast<unsigned long long>(backwards),
+            static_cast<unsigned long long>(last), static_cast<unsigned long long>(count), ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Segments are a connected chain, and the previous head is the segment behind
+    // it (or the head itself before the first step) and the previous tail one cell
+    // from the tail
+    bool IsConsistent(const GameSessionSnapshot& snapshot)
+    {
+        const size_t length = snapshot.segments.size();
+        for (size_t i = 0; i + 1 < length; ++i)
+        {
+            const int distance = std::abs(snapshot.segments[i].x - snapshot.segments[i + 1].x)
+                + std::abs(snapshot.segments[i].y - snapshot.segments[i + 1].y);
+            if (distance != 1)
+                return false;
+        }
+
+        if (length > 0)
+        {
+            const GridCell head = snapshot.segments[0];
+            const GridCell tail = snapshot.segments[length - 1];
+            if (snapshot.previousHead == head)
+            {
+                if (!(snapshot.previousTail == tail))
+                    return false;
+            }
+            else
+            {
+                if (length > 1 && !(snapshot.previousHead == snapshot.segments[1]))
+                    return false;
+                if (std::abs(snapshot.previousTail.x - tail.x) + std::abs(snapshot.previousTail.y - tail.y) > 1)
+                    return false;
+            }
+        }
+        return snapshot.interpolationAlpha >= 0.0f && snapshot.interpolationAlpha <= 1.0f;
+    }
+
+    // Start a session, steer it along the board's Hamiltonian cycle from acquired
+    // snapshots (so it never dies) and check every snapshot and the update rate
+    bool RunSimulationThread()
+    {
+        constexpr int screenWidth = 800;
+        constexpr int screenHeight = 600;
+        constexpr double runSeconds = 2.0;
+
+        auto simulation = std::make_unique<SimulationThread>();
+        simulation->Start(screenWidth, screenHeight, 1);
+        const int gridWidth = screenWidth / static_cast<int>(SnakeGame::c_cellSize);
+        const int gridHeight = screenHeight / static_cast<int>(SnakeGame::c_cellSize);
+
+        InputState start = {};
+        start.startPressed = true;
+        simulation->PushInput(start);
+
+        Bench::Stopwatch timer;
+        uint64_t frames = 0;
+        uint64_t inconsistent = 0;
+        int foodEaten = 0;
+        int gameOvers = 0;
+        while (timer.ElapsedSeconds() < runSeconds)
+        {
+            const GameSessionSnapshot& snapshot = simulation->AcquireSnapshot();
+            if (!IsConsistent(snapshot))
+            {
+                inconsistent++;
+            }
+
+            if (snapshot.state == GameState::Playing && !snapshot.segments.empty())
+            {
+                const GridCell head = snapshot.segments[0];
+                InputState input = {};
+                input.dir = Bench::HamiltonianDirection(head.x, head.y, gridWidth, gridHeight);
+                simulation->PushInput(input);
+            }
+
+            SimulationFeedback feedback;
+            while (simulation->PopFeedback(feedback))
+            {
+                foodEaten += feedback.foodEaten;
+                gameOvers += feedback.gameOver ? 1 : 0;
+            }
+
+            frames++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const double seconds = timer.ElapsedSeconds();
+        simulation->Stop();
+
+        SimulationFeedback feedback;
+        while (simulation->PopFeedback(feedback))
+        {
+            foodEaten += feedback.foodEaten;
+            gameOvers += feedback.gameOver ? 1 : 0;
+        }
+
+        const ReplayResult result = simulation->GetResult();
+        const double expectedRate = static_cast<double>(SnakeGame::c_ticksPerSecond) / simulation->GetStepTicks();
+        const double rate = result.ticks / seconds;
+        const bool rateOk = rate > expectedRate * 0.9 && rate < expectedRate * 1.1;
+        const bool ok = inconsistent == 0 && gameOvers == 0 && foodEaten == result.score && rateOk;
+        printf("sim thread:     %llu updates (%.1f/s, expected %.0f/s)  %llu frames  inconsistent %llu  score %d  food fed back %d  %s\n",
+            static_cast<unsigned long long>(result.ticks), rate, expectedRate, static_cast<unsigned long long>(frames),
+            static_cast<unsigned long long>(inconsistent), result.score, foodEaten, ok ? "ok" : "FAILED");
+        return ok;
+    }
+}
+
+int RunSimThreadBench()
+{
+    bool ok = true;
+    ok &= RunRingStress();
+    ok &= RunTripleBufferStress();
+    ok &= RunSimulationThread();
+    return ok ? 0 : 1;
+}
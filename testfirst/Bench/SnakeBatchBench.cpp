@@ -0,0 +1,211 @@
+//
+// SnakeBatchBench.cpp
+// SnakeWorldBatch: step-for-step check against SnakeGame, then throughput
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "SnakeWorldBatch.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int c_screenWidth = 800;
+    constexpr int c_screenHeight = 600;
+
+    // Snapshot of one game after a step
+    struct GameSample
+    {
+        GridCell head;
+        GridCell food;
+        uint32_t length;
+        int32_t score;
+        uint8_t foodAlive;
+        uint8_t gameOver;
+        uint8_t won;
+    };
+
+    bool operator==(const GameSample& a, const GameSample& b)
+    {
+        return a.head == b.head && a.food == b.food && a.length == b.length && a.score == b.score &&
+            a.foodAlive == b.foodAlive && a.gameOver == b.gameOver && a.won == b.won;
+    }
+
+    // Every fourth game chases food greedily (and eventually dies), the rest follow
+    // the Hamiltonian cycle. Only state both implementations expose is used.
+    Direction PickDirection(size_t game, GridCell head, GridCell food, int gridWidth, int gridHeight)
+    {
+        if (game % 4 != 0)
+            return Bench::HamiltonianDirection(head.x, head.y, gridWidth, gridHeight);
+
+        if (food.x > head.x)
+            return Direction::Right;
+        if (food.x < head.x)
+            return Direction::Left;
+        return (food.y > head.y) ? Direction::Down : Direction::Up;
+    }
+
+    GameSample Sample(const SnakeGame& game)
+    {
+        return GameSample{ game.GetHead(), game.GetFood().cell, static_cast<uint32_t>(game.GetLength()), game.GetScore(),
+            static_cast<uint8_t>(game.GetFood().alive), static_cast<uint8_t>(game.IsGameOver()), static_cast<uint8_t>(game.IsWon()) };
+    }
+
+    GameSample Sample(const SnakeWorldBatch& batch, size_t game)
+    {
+        return GameSample{ batch.GetHead(game), batch.GetFood(game).cell, static_cast<uint32_t>(batch.GetLength(game)), batch.GetScore(game),
+            static_cast<uint8_t>(batch.GetFood(game).alive), static_cast<uint8_t>(batch.IsGameOver(game)), static_cast<uint8_t>(batch.IsWon(game)) };
+    }
+
+    int VerifyAgainstScalar()
+    {
+        constexpr size_t gameCount = 256;
+        constexpr int updates = 2000;
+        constexpr uint64_t seed = 1234;
+
+        // Frame times vary between a quarter and one move interval, so the move
+        // timers drift apart and games step on different updates (longer frames
+        // would take two steps on one queued direction and kill the cycle followers)
+        std::vector<float> frameTimes(updates);
+        Pcg32 frameRandom(seed);
+        for (float& frameTime : frameTimes)
+        {
+            frameTime = SnakeGame::c_moveInterval * (0.25f + 0.75f * frameRandom.NextFloat());
+        }
+
+        // Scalar reference run
+        std::vector<SnakeGame> games(gameCount);
+        for (size_t i = 0; i < gameCount; ++i)
+        {
+            games[i].Reset(c_screenWidth, c_screenHeight, SnakeWorldBatch::GameSeed(seed, i));
+        }
+
+        const int gridWidth = games[0].GetGridWidth();
+        const int gridHeight = games[0].GetGridHeight();
+
+        std::vector<GameSample> expected;
+        expected.reserve(gameCount * (updates + 1));
+        for (const SnakeGame& game : games)
+        {
+            expected.push_back(Sample(game));
+        }
+
+        for (int update = 0; update < updates; ++update)
+        {
+            for (size_t i = 0; i < gameCount; ++i)
+            {
+                SnakeGame& game = games[i];
+                game.QueueDirection(PickDirection(i, game.GetHead(), game.GetFood().cell, gridWidth, gridHeight));
+                game.Update(frameTimes[update]);
+                expected.push_back(Sample(game));
+            }
+        }
+
+        // Batched run from the same seed
+        SnakeWorldBatch batch;
+        batch.Reset(gameCount, c_screenWidth, c_screenHeight, seed);
+
+        size_t sampleIndex = 0;
+        for (size_t i = 0; i < gameCount; ++i, ++sampleIndex)
+        {
+            if (!(Sample(batch, i) == expected[sampleIndex]))
+            {
+                printf("verify: game %zu differs after Reset\n", i);
+                return 1;
+            }
+        }
+
+        for (int update = 0; update < updates; ++update)
+        {
+            for (size_t i = 0; i < gameCount; ++i)
+            {
+                batch.QueueDirection(i, PickDirection(i, batch.GetHead(i), batch.GetFood(i).cell, gridWidth, gridHeight));
+            }
+            batch.Update(frameTimes[update]);
+
+            for (size_t i = 0; i < gameCount; ++i, ++sampleIndex)
+            {
+                if (!(Sample(batch, i) == expected[sampleIndex]))
+                {
+                    printf("verify: game %zu differs at update %d\n", i, update);
+                    return 1;
+                }
+            }
+        }
+
+        size_t deaths = 0;
+        for (const SnakeGame& game : games)
+        {
+            deaths += game.IsGameOver() ? 1 : 0;
+        }
+        printf("verify: %zu games x %d updates match SnakeGame (%zu died)\n", gameCount, updates, deaths);
+        return 0;
+    }
+}
+
+int RunSnakeBatchBench()
+{
+    if (VerifyAgainstScalar() != 0)
+        return 1;
+
+    constexpr int updates = 500;
+    const size_t gameCounts[] = { 64, 1024, 8192 };
+
+    printf("%8s %10s %16s %16s %8s\n", "games", "updates", "scalar steps/s", "batch steps/s", "speedup");
+
+    for (size_t gameCount : gameCounts)
+    {
+        // Scalar: one SnakeGame object per game
+        std::vector<SnakeGame> games(gameCount);
+        for (size_t i = 0; i < gameCount; ++i)
+        {
+            games[i].Reset(c_screenWidth, c_screenHeight, SnakeWorldBatch::GameSeed(1, i));
+        }
+        const int gridWidth = games[0].GetGridWidth();
+        const int gridHeight = games[0].GetGridHeight();
+
+        Bench::Stopwatch timer;
+        for (int update = 0; update < updates; ++update)
+        {
+            for (SnakeGame& game : games)
+            {
+                const GridCell head = game.GetHead();
+                game.QueueDirection(Bench::HamiltonianDirection(head.x, head.y, gridWidth, gridHeight));
+                game.Update(SnakeGame::c_moveInterval);
+            }
+        }
+        const double scalarSeconds = timer.ElapsedSeconds();
+
+        // Batched
+        SnakeWorldBatch batch;
+        batch.Reset(gameCount, c_screenWidth, c_screenHeight, 1);
+
+        uint64_t batchSteps = 0;
+        timer.Restart();
+        for (int update = 0; update < updates; ++update)
+        {
+            for (size_t i = 0; i < gameCount; ++i)
+            {
+                const GridCell head = batch.GetHead(i);
+                batch.QueueDirection(i, Bench::HamiltonianDirection(head.x, head.y, gridWidth, gridHeight));
+            }
+            batchSteps += batch.Update(SnakeGame::c_moveInterval).steps;
+        }
+        const double batchSeconds = timer.ElapsedSeconds();
+
+        const double totalSteps = static_cast<double>(gameCount) * updates;
+        if (batchSteps != static_cast<uint64_t>(totalSteps))
+        {
+            printf("batch took %llu steps, expected %.0f\n", static_cast<unsigned long long>(batchSteps), totalSteps);
+            return 1;
+        }
+
+        printf("%8zu %10d %16.3e %16.3e %7.2fx\n", gameCount, updates,
+            totalSteps / scalarSeconds, totalSteps / batchSeconds, scalarSeconds / batchSeconds);
+    }
+
+    printf("(single thread: steps/s is per core)\n");
+    return 0;
+}
@@ -0,0 +1,219 @@
+//
+// SnakeBodyBench.cpp
+// Body storage: std::deque of pixel-space float pairs (previous layout) versus
+// the packed GridCell ring buffer used by SnakeGame
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+namespace
+{
+    // Pixel-space segment as previously stored (layout of DirectX::XMFLOAT2)
+    struct PixelSegment
+    {
+        float x;
+        float y;
+    };
+
+    size_t g_liveBytes = 0;
+    size_t g_peakBytes = 0;
+
+    // Allocator that records how much memory the deque holds
+    template<typename T>
+    struct CountingAllocator
+    {
+        using value_type = T;
+
+        CountingAllocator() = default;
+        template<typename U>
+        CountingAllocator(const CountingAllocator<U>&) {}
+
+        T* allocate(size_t count)
+        {
+            g_liveBytes += count * sizeof(T);
+            g_peakBytes = std::max(g_peakBytes, g_liveBytes);
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_t count)
+        {
+            g_liveBytes -= count * sizeof(T);
+            ::operator delete(ptr);
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U>&) const { return true; }
+        template<typename U>
+        bool operator!=(const CountingAllocator<U>&) const { return false; }
+    };
+
+    // Same ring layout as SnakeGame's body storage
+    class CellRing
+    {
+    public:
+        explicit CellRing(size_t cellCount) : m_head(0), m_length(0)
+        {
+            size_t capacity = 1;
+            while (capacity < cellCount)
+            {
+                capacity <<= 1;
+            }
+            m_cells.assign(capacity, GridCell{ 0, 0 });
+            m_mask = static_cast<uint32_t>(capacity - 1);
+        }
+
+        void PushHead(GridCell cell)
+        {
+            m_head = (m_head - 1) & m_mask;
+            m_cells[m_head] = cell;
+            m_length++;
+        }
+
+        GridCell PopTail()
+        {
+            m_length--;
+            return m_cells[(m_head + m_length) & m_mask];
+        }
+
+        GridCell Get(size_t index) const { return m_cells[(m_head + index) & m_mask]; }
+        size_t Size() const { return m_length; }
+        size_t Bytes() const { return m_cells.size() * sizeof(GridCell); }
+
+    private:
+        std::vector<GridCell> m_cells;
+        uint32_t m_mask;
+        uint32_t m_head;
+        size_t m_length;
+    };
+
+    struct BodyResult
+    {
+        double nsPerMove;
+        double nsPerSegmentVisit;
+        size_t bytes;
+    };
+
+    // Movement follows a serpentine over a c_gridWidth-wide board
+    constexpr int c_gridWidth = 512;
+
+    GridCell SerpentineCell(long long step)
+    {
+        const long long row = step / c_gridWidth;
+        const long long col = step % c_gridWidth;
+        const long long x = (row & 1) ? (c_gridWidth - 1 - col) : col;
+        return GridCell{ static_cast<int16_t>(x), static_cast<int16_t>(row & 0x3FFF) };
+    }
+
+    PixelSegment ToPixels(GridCell cell)
+    {
+        return PixelSegment{
+            static_cast<float>(cell.x) * SnakeGame::c_cellSize + SnakeGame::c_cellSize * 0.5f,
+            static_cast<float>(cell.y) * SnakeGame::c_cellSize + SnakeGame::c_cellSize * 0.5f };
+    }
+
+    // Times `moves` head pushes + tail pops, then whole-body walks (as the renderer does)
+    template<typename TBody, typename TPush, typename TPop, typename TVisit>
+    BodyResult RunBody(TBody& body, size_t length, int moves, TPush push, TPop pop, TVisit visit)
+    {
+        long long step = 0;
+        for (; step < static_cast<long long>(length); ++step)
+        {
+            push(body, SerpentineCell(step));
+        }
+
+        BodyResult result = {};
+
+        Bench::Stopwatch timer;
+        for (int move = 0; move < moves; ++move, ++step)
+        {
+            push(body, SerpentineCell(step));
+            pop(body);
+        }
+        result.nsPerMove = timer.ElapsedSeconds() * 1e9 / moves;
+
+        const int walks = std::max(1, static_cast<int>(2000000 / length));
+        float checksum = 0.0f;
+        timer.Restart();
+        for (int walk = 0; walk < walks; ++walk)
+        {
+            checksum += visit(body);
+        }
+        result.nsPerSegmentVisit = timer.ElapsedSeconds() * 1e9 / (static_cast<double>(walks) * static_cast<double>(length));
+
+        Bench::DoNotOptimize(checksum);
+        return result;
+    }
+
+    BodyResult RunDeque(size_t length, int moves)
+    {
+        g_liveBytes = 0;
+        g_peakBytes = 0;
+
+        using PixelDeque = std::deque<PixelSegment, CountingAllocator<PixelSegment>>;
+
+        BodyResult result = {};
+        {
+            PixelDeque body;
+            result = RunBody(body, length, moves,
+                [](PixelDeque& d, GridCell cell) { d.push_front(ToPixels(cell)); },
+                [](PixelDeque& d) { d.pop_back(); },
+                [](const PixelDeque& d)
+                {
+                    float sum = 0.0f;
+                    for (size_t i = 0; i < d.size(); ++i)
+                    {
+                        sum += d[i].x + d[i].y;
+                    }
+                    return sum;
+                });
+        }
+        result.bytes = g_peakBytes;
+        return result;
+    }
+
+    BodyResult RunRing(size_t length, int moves)
+    {
+        // Capacity for this length only; SnakeGame sizes it to the whole board
+        CellRing body(length);
+        BodyResult result = RunBody(body, length, moves,
+            [](CellRing& r, GridCell cell) { r.PushHead(cell); },
+            [](CellRing& r) { r.PopTail(); },
+            [](const CellRing& r)
+            {
+                int sum = 0;
+                for (size_t i = 0; i < r.Size(); ++i)
+                {
+                    const GridCell cell = r.Get(i);
+                    sum += cell.x + cell.y;
+                }
+                return static_cast<float>(sum);
+            });
+        result.bytes = body.Bytes();
+        return result;
+    }
+}
+
+int RunSnakeBodyBench()
+{
+    const size_t lengths[] = { 3, 100, 1000, 10000, 100000 };
+    constexpr int moves = 1000000;
+
+    printf("%10s %8s %12s %14s %12s\n", "length", "storage", "ns/move", "ns/seg visit", "bytes");
+
+    for (size_t length : lengths)
+    {
+        const BodyResult deque = RunDeque(length, moves);
+        const BodyResult ring = RunRing(length, moves);
+
+        printf("%10zu %8s %12.2f %14.3f %12zu\n", length, "deque", deque.nsPerMove, deque.nsPerSegmentVisit, deque.bytes);
+        printf("%10zu %8s %12.2f %14.3f %12zu\n", length, "ring", ring.nsPerMove, ring.nsPerSegmentVisit, ring.bytes);
+    }
+
+    printf("(deque bytes are peak block allocations; ring bytes are the next power of two of the length)\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+// SnakeEventsBench.cpp
+// SnakeGame step events: completeness check and cost with many steps per Update
+// (frames asking for more than SnakeGame::c_maxStepsPerUpdate steps are capped,
+// and nothing may be dropped)
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+
+#include <algorithm>
+#include <cstdio>
+
+int RunSnakeEventsBench()
+{
+    // A long two-row board with food allowed everywhere: the snake runs right for
+    // ~2000 steps per game and eats whatever food spawns ahead of it in its row
+    constexpr int gridWidth = 4096;
+    constexpr int gridHeight = 2;
+    constexpr int screenWidth = gridWidth * static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int screenHeight = gridHeight * static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int totalSteps = 1000000;
+
+    SnakeGame::Settings settings;
+    settings.spawnMargin = 0.0f;
+
+    const int stepsPerFrameList[] = { 1, 16, 256, 1024 };
+
+    printf("%14s %12s %12s %12s %12s %12s %10s\n", "steps/update", "ns/step", "food", "max steps", "max events", "dropped", "check");
+
+    int result = 0;
+    for (int stepsPerFrame : stepsPerFrameList)
+    {
+        // Half an interval of slack keeps float rounding from changing the step count
+        const float frameTime = (static_cast<float>(stepsPerFrame) + 0.5f) * SnakeGame::c_moveInterval;
+
+        SnakeGame game;
+        game.SetSettings(settings);
+        uint64_t seed = 1;
+        int steps = 0;
+        int food = 0;
+        int scoreTotal = 0;
+        int maxSteps = 0;
+        size_t maxEvents = 0;
+        size_t dropped = 0;
+        bool ok = true;
+        double seconds = 0.0;
+
+        while (steps < totalSteps && ok)
+        {
+            game.Reset(screenWidth, screenHeight, seed++);
+
+            Bench::Stopwatch timer;
+            while (!game.IsGameOver() && !game.IsWon())
+            {
+                const SnakeGameEvents events = game.Update(frameTime);
+                const SnakeEventBuffer& buffer = game.GetEvents();
+
+                // One Moved/Died per step, AteFood plus SpawnedFood/Won per food, in time order
+                const size_t expected = static_cast<size_t>(events.steps) + 2 * static_cast<size_t>(events.foodEaten);
+                ok &= (buffer.GetCount() + buffer.GetDroppedCount() == expected);
+                ok &= buffer.GetDroppedCount() == 0 && events.steps <= SnakeGame::c_maxStepsPerUpdate;
+                for (size_t i = 1; i < buffer.GetCount(); ++i)
+                {
+                    ok &= (buffer[i - 1].time <= buffer[i].time && buffer[i].time <= frameTime);
+                }
+
+                steps += events.steps;
+                food += events.foodEaten;
+                maxSteps = std::max(maxSteps, events.steps);
+                maxEvents = std::max(maxEvents, buffer.GetCount() + buffer.GetDroppedCount());
+                dropped += buffer.GetDroppedCount();
+            }
+            seconds += timer.ElapsedSeconds();
+            scoreTotal += game.GetScore();
+        }
+
+        ok &= (food == scoreTotal);
+        printf("%14d %12.1f %12d %12d %12zu %12zu %10s\n", stepsPerFrame, seconds * 1e9 / steps, food, maxSteps, maxEvents, dropped, ok ? "ok" : "FAILED");
+        if (!ok)
+            result = 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,57 @@
+//
+// SnakeFillBench.cpp
+// Step cost by board fill ratio, driven all the way to the board-full win
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+
+#include <cstdio>
+
+int RunSnakeFillBench()
+{
+    // Default 800x600 board (40 x 30 cells)
+    constexpr int screenWidth = 800;
+    constexpr int screenHeight = 600;
+    constexpr int gridWidth = screenWidth / static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int gridHeight = screenHeight / static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int cellCount = gridWidth * gridHeight;
+    constexpr int bucketCount = 10;
+
+    double bucketSeconds[bucketCount] = {};
+    long long bucketSteps[bucketCount] = {};
+
+    SnakeGame game;
+    game.Reset(screenWidth, screenHeight, 1);
+
+    // The cycle visits every cell, so the snake eventually eats every food
+    Bench::Stopwatch timer;
+    while (!game.IsGameOver() && !game.IsWon())
+    {
+        const int bucket = static_cast<int>(game.GetLength()) * bucketCount / (cellCount + 1);
+
+        timer.Restart();
+        Bench::SteerAndStep(game, gridWidth, gridHeight);
+        bucketSeconds[bucket] += timer.ElapsedSeconds();
+        bucketSteps[bucket]++;
+    }
+
+    if (!game.IsWon())
+    {
+        printf("snake died at length %zu before filling the board\n", game.GetLength());
+        return 1;
+    }
+
+    printf("%10s %12s %12s\n", "fill", "steps", "ns/step");
+    for (int bucket = 0; bucket < bucketCount; ++bucket)
+    {
+        if (bucketSteps[bucket] == 0)
+            continue;
+
+        printf("%8d%% %12lld %12.1f\n", bucket * 100 / bucketCount, bucketSteps[bucket],
+            bucketSeconds[bucket] * 1e9 / static_cast<double>(bucketSteps[bucket]));
+    }
+    printf("won at length %zu, score %d\n", game.GetLength(), game.GetScore());
+
+    return 0;
+}
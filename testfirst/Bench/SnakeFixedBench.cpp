@@ -0,0 +1,171 @@
+//
+// SnakeFixedBench.cpp
+// SnakeGameT: step-for-step check against SnakeGame (including frames longer than
+// SnakeGame::c_maxStepsPerUpdate steps), then step throughput of the fixed-size
+// specializations versus the dynamic game
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "SnakeGameT.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Every fourth game chases food greedily (and eventually dies), the rest follow
+    // the Hamiltonian cycle
+    template<typename Game>
+    Direction PickDirection(const Game& game, uint64_t seed)
+    {
+        const GridCell head = game.GetHead();
+        if (seed % 4 != 0)
+            return Bench::HamiltonianDirection(head.x, head.y, game.GetGridWidth(), game.GetGridHeight());
+
+        const GridCell food = game.GetFood().cell;
+        if (food.x > head.x)
+            return Direction::Right;
+        if (food.x < head.x)
+            return Direction::Left;
+        return (food.y > head.y) ? Direction::Down : Direction::Up;
+    }
+
+    template<typename FixedGame>
+    bool VerifyAgainstDynamic()
+    {
+        constexpr uint64_t games = 32;
+        constexpr int updates = 3000;
+
+        auto fixed = std::make_unique<FixedGame>();
+        SnakeGame dynamic;
+
+        for (uint64_t seed = 0; seed < games; ++seed)
+        {
+            fixed->Reset(seed);
+            dynamic.Reset(FixedGame::c_screenWidth, FixedGame::c_screenHeight, seed);
+
+            // Frame times between a quarter and one move interval (see SnakeBatchBench)
+            Pcg32 frameRandom(seed);
+            for (int update = 0; update < updates; ++update)
+            {
+                const uint64_t frameTicks = SnakeGame::c_moveIntervalTicks / 4 + frameRandom.NextBelow(static_cast<uint32_t>(SnakeGame::c_moveIntervalTicks * 3 / 4));
+                fixed->QueueDirection(PickDirection(*fixed, seed));
+                dynamic.QueueDirection(PickDirection(dynamic, seed));
+                fixed->UpdateTicks(frameTicks);
+                dynamic.UpdateTicks(frameTicks);
+
+                const bool same = fixed->GetHead() == dynamic.GetHead() && fixed->GetFood().cell == dynamic.GetFood().cell &&
+                    fixed->GetFood().alive == dynamic.GetFood().alive && fixed->GetLength() == dynamic.GetLength() &&
+                    fixed->GetScore() == dynamic.GetScore() && fixed->IsGameOver() == dynamic.IsGameOver() && fixed->IsWon() == dynamic.IsWon();
+                if (!same)
+                {
+                    printf("verify: %dx%d seed %llu diverged at update %d\n", FixedGame::c_gridWidth, FixedGame::c_gridHeight,
+                        static_cast<unsigned long long>(seed), update);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // One frame worth 400 steps on a board wide enough for the snake to live
+    // through them: both games stop at c_maxStepsPerUpdate and take the rest from
+    // the accumulator on the next calls
+    bool VerifyLongFrames()
+    {
+        using WideGame = SnakeGameT<1024, 4>;
+        constexpr uint64_t frameSteps = 400;
+
+        auto fixed = std::make_unique<WideGame>();
+        SnakeGame dynamic;
+        fixed->Reset(5);
+        dynamic.Reset(WideGame::c_screenWidth, WideGame::c_screenHeight, 5);
+
+        bool ok = true;
+        int firstSteps = 0;
+        uint64_t frameTicks = frameSteps * dynamic.GetMoveIntervalTicks();
+        for (int update = 0; update < 4 && ok; ++update)
+        {
+            const SnakeGameEvents fixedEvents = fixed->UpdateTicks(frameTicks);
+            const SnakeGameEvents dynamicEvents = dynamic.UpdateTicks(frameTicks);
+            firstSteps = (update == 0) ? dynamicEvents.steps : firstSteps;
+            frameTicks = 0;
+
+            ok = fixedEvents.steps == dynamicEvents.steps && fixed->GetHead() == dynamic.GetHead()
+                && fixed->GetLength() == dynamic.GetLength() && fixed->GetScore() == dynamic.GetScore()
+                && fixed->IsGameOver() == dynamic.IsGameOver();
+        }
+
+        ok &= firstSteps == SnakeGame::c_maxStepsPerUpdate;
+        printf("long frames:    %llu steps due, %d taken in the first update, fixed %s  %s\n",
+            static_cast<unsigned long long>(frameSteps), firstSteps, ok ? "matches" : "DIFFERS", ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // ns per step following the cycle from `length` segments
+    template<typename Game>
+    double MeasureSteps(Game& game, int gridWidth, int gridHeight, int length, int timedSteps)
+    {
+        game.Grow(length - static_cast<int>(game.GetLength()));
+        while (static_cast<int>(game.GetLength()) < length && !game.IsGameOver())
+        {
+            Bench::SteerAndStep(game, gridWidth, gridHeight);
+        }
+
+        Bench::Stopwatch timer;
+        int steps = 0;
+        for (; steps < timedSteps && !game.IsGameOver() && !game.IsWon(); ++steps)
+        {
+            Bench::SteerAndStep(game, gridWidth, gridHeight);
+        }
+        const double seconds = timer.ElapsedSeconds();
+
+        Bench::DoNotOptimize(game.GetScore());
+        return steps ? seconds * 1e9 / steps : 0.0;
+    }
+
+    template<typename FixedGame>
+    bool RunBoard()
+    {
+        constexpr int width = FixedGame::c_gridWidth;
+        constexpr int height = FixedGame::c_gridHeight;
+        constexpr int timedSteps = 200000;
+
+        const bool verified = VerifyAgainstDynamic<FixedGame>();
+
+        // Short snake, then one covering half the board
+        const int lengths[] = { 3, FixedGame::c_cellCount / 2 };
+        for (int length : lengths)
+        {
+            SnakeGame dynamic;
+            dynamic.Reset(FixedGame::c_screenWidth, FixedGame::c_screenHeight, 1);
+            const double dynamicNs = MeasureSteps(dynamic, width, height, length, timedSteps);
+
+            auto fixed = std::make_unique<FixedGame>();
+            fixed->Reset(1);
+            const double fixedNs = MeasureSteps(*fixed, width, height, length, timedSteps);
+
+            char board[16];
+            snprintf(board, sizeof(board), "%dx%d", width, height);
+            printf("%8s %8d %12.1f %12.1f %8.2fx %8s\n", board, length, dynamicNs, fixedNs,
+                fixedNs > 0.0 ? dynamicNs / fixedNs : 0.0, verified ? "match" : "DIFFER");
+        }
+
+        return verified;
+    }
+}
+
+int RunSnakeFixedBench()
+{
+    printf("%8s %8s %12s %12s %9s %8s\n", "board", "length", "dynamic ns", "fixed ns", "speedup", "verify");
+
+    bool ok = true;
+    ok &= RunBoard<SnakeGame40x30>();
+    ok &= RunBoard<SnakeGame64x36>();
+    ok &= RunBoard<SnakeGame96x54>();
+    ok &= VerifyLongFrames();
+
+    return ok ? 0 : 1;
+}
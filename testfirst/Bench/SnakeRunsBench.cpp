@@ -0,0 +1,352 @@
+//
+// SnakeRunsBench.cpp
+// Snake body as straight runs: the incremental corner ring against corners
+// rebuilt from the body, the run quads against per-cell squares on a pixel
+// grid, then quads and write time per frame against length (and the fallback
+// to cells when the body turns too often for runs to pay)
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+#include "GameSession.h"
+#include "InstanceStream.h"
+#include "SnakeAutopilot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int c_screenWidth = 1280;
+    constexpr int c_screenHeight = 960;
+    constexpr int c_gridWidth = c_screenWidth / static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int c_gridHeight = c_screenHeight / static_cast<int>(SnakeGame::c_cellSize);
+
+    // Corners from scratch: both ends and every cell where the body turns
+    void RebuildCorners(const SnakeGame& game, std::vector<GridCell>& corners)
+    {
+        corners.clear();
+        const size_t length = game.GetLength();
+        for (size_t i = 0; i < length; ++i)
+        {
+            const GridCell cell = game.GetSegment(i);
+            if (i == 0 || i + 1 == length)
+            {
+                corners.push_back(cell);
+                continue;
+            }
+            const GridCell before = game.GetSegment(i - 1);
+            const GridCell after = game.GetSegment(i + 1);
+            if (before.x - cell.x != cell.x - after.x || before.y - cell.y != cell.y - after.y)
+            {
+                corners.push_back(cell);
+            }
+        }
+    }
+
+    bool CornersMatch(const SnakeGame& game, const std::vector<GridCell>& expected)
+    {
+        if (game.GetCornerCount() != expected.size())
+            return false;
+
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            if (game.GetCorner(i) != expected[i])
+                return false;
+        }
+        return true;
+    }
+
+    // The render-side view of a game, as GameSession::CaptureSnapshot takes it,
+    // and its corners (which the snapshot does not carry)
+    void CaptureBody(const SnakeGame& game, float alpha, GameSessionSnapshot& snapshot, std::vector<GridCell>& corners)
+    {
+        snapshot.segments.resize(game.GetLength());
+        for (size_t i = 0; i < game.GetLength(); ++i)
+        {
+            snapshot.segments[i] = game.GetSegment(i);
+        }
+        snapshot.previousHead = game.GetPreviousSegment(0);
+        snapshot.previousTail = game.GetPreviousSegment(game.GetLength() - 1);
+        corners.resize(game.GetCornerCount());
+        for (size_t i = 0; i < game.GetCornerCount(); ++i)
+        {
+            corners[i] = game.GetCorner(i);
+        }
+        snapshot.interpolationAlpha = alpha;
+        snapshot.food.alive = false;
+        snapshot.particles.clear();
+    }
+
+    // Autopilot games (turning wherever the food leads) checked after every
+    // step, with a SaveState/LoadState round trip every few steps
+    bool CheckCorners()
+    {
+        SnakeGame game;
+        SnakeGame loaded;
+        SnakeAutopilot autopilot;
+        std::vector<GridCell> expected;
+        std::vector<uint8_t> state;
+
+        size_t steps = 0;
+        size_t mismatches = 0;
+        size_t loadMismatches = 0;
+        size_t peakCorners = 0;
+        for (uint64_t seed = 1; seed <= 4; ++seed)
+        {
+            game.Reset(c_screenWidth, c_screenHeight, seed);
+            loaded.Reset(c_screenWidth, c_screenHeight, seed);
+            autopilot.Reset(game);
+            state.resize(game.GetStateSize());
+            while (steps < 40000 * seed && !game.IsGameOver() && !game.IsWon())
+            {
+                game.QueueDirection(autopilot.Think(game));
+                if ((steps & 63) == 0)
+                {
+                    game.Grow(8);  // Longer than the food alone makes it, so the tail trails through more corners
+                }
+                game.Update(SnakeGame::c_moveInterval);
+                steps++;
+
+                RebuildCorners(game, expected);
+                mismatches += CornersMatch(game, expected) ? 0 : 1;
+                peakCorners = std::max(peakCorners, expected.size());
+
+                if ((steps % 97) == 0)
+                {
+                    game.SaveState(state.data(), state.size());
+                    const bool loadedOk = loaded.LoadState(state.data(), state.size());
+                    loadMismatches += (loadedOk && CornersMatch(loaded, expected)) ? 0 : 1;
+                }
+            }
+        }
+
+        const bool ok = mismatches == 0 && loadMismatches == 0;
+        printf("corners:        %zu steps, %zu mismatched, %zu after LoadState, up to %zu corners  %s\n",
+            steps, mismatches, loadMismatches, peakCorners, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // One bit per pixel of the screen; a rectangle covers the pixels whose
+    // centers it contains
+    class Coverage
+    {
+    public:
+        Coverage() : m_pixels(static_cast<size_t>(c_screenWidth) * c_screenHeight, 0) {}
+
+        void Clear() { std::fill(m_pixels.begin(), m_pixels.end(), uint8_t(0)); }
+
+        void Fill(const SpriteInstance* instances, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const SpriteInstance& instance = instances[i];
+                const int x0 = std::max(0, static_cast<int>(std::ceil(instance.pos.x - 0.5f)));
+                const int y0 = std::max(0, static_cast<int>(std::ceil(instance.pos.y - 0.5f)));
+                const int x1 = std::min(c_screenWidth, static_cast<int>(std::ceil(instance.pos.x + instance.size.x - 0.5f)));
+                const int y1 = std::min(c_screenHeight, static_cast<int>(std::ceil(instance.pos.y + instance.size.y - 0.5f)));
+                for (int y = y0; y < y1; ++y)
+                {
+                    std::fill(m_pixels.begin() + y * c_screenWidth + x0, m_pixels.begin() + y * c_screenWidth + std::max(x0, x1), uint8_t(1));
+                }
+            }
+        }
+
+        // Pixels covered here but not in other
+        size_t CountMissingFrom(const Coverage& other) const
+        {
+            size_t missing = 0;
+            for (size_t i = 0; i < m_pixels.size(); ++i)
+            {
+                missing += (m_pixels[i] & ~other.m_pixels[i]) & 1;
+            }
+            return missing;
+        }
+
+    private:
+        std::vector<uint8_t> m_pixels;
+    };
+
+    // Body and head drawn a full cell wide (no gaps), so both styles should paint
+    // the same pixels wherever the snake sits on whole cells
+    void RasterizeCells(const GameSessionSnapshot& snapshot, std::vector<SpriteInstance>& instances, Coverage& coverage)
+    {
+        instances.resize(snapshot.segments.size());
+        WriteSnapshotSegmentInstances(snapshot, 0, snapshot.segments.size(), SnakeGame::c_cellSize, c_snakeBodyColor,
+            Float2{ 0.0f, 0.0f }, instances.data());
+        coverage.Clear();
+        coverage.Fill(instances.data(), instances.size());
+    }
+
+    void RasterizeRuns(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& corners,
+        std::vector<SpriteInstance>& instances, Coverage& coverage)
+    {
+        instances.resize(corners.size() + 1);
+        size_t count = WriteBodyRunInstances(corners.data(), corners.size(),
+            snapshot.GetPreviousSegment(0), snapshot.GetPreviousSegment(snapshot.segments.size() - 1), snapshot.interpolationAlpha,
+            SnakeGame::c_cellSize, c_snakeBodyColor, Float2{ 0.0f, 0.0f }, instances.data());
+        WriteSnapshotSegmentInstances(snapshot, 0, 1, SnakeGame::c_cellSize, c_snakeHeadColor, Float2{ 0.0f, 0.0f },
+            instances.data() + count++);
+        coverage.Clear();
+        coverage.Fill(instances.data(), count);
+    }
+
+    // On whole cells (alpha 0 and 1) the runs paint exactly the cells' pixels;
+    // mid-step they paint at least those, plus the notches the sliding squares
+    // leave at each corner
+    bool CheckCoverage()
+    {
+        SnakeGame game;
+        SnakeAutopilot autopilot;
+        game.Reset(c_screenWidth, c_screenHeight, 7);
+        autopilot.Reset(game);
+
+        GameSessionSnapshot snapshot = {};
+        std::vector<GridCell> corners;
+        std::vector<SpriteInstance> instances;
+        Coverage cells;
+        Coverage runs;
+
+        size_t frames = 0;
+        size_t wholeDiffer = 0;
+        size_t midMissing = 0;
+        size_t midExtra = 0;
+        for (int step = 0; step < 6000 && !game.IsGameOver() && !game.IsWon(); ++step)
+        {
+            game.QueueDirection(autopilot.Think(game));
+            if ((step & 31) == 0)
+            {
+                game.Grow(8);
+            }
+            game.Update(SnakeGame::c_moveInterval);
+            if ((step % 50) != 0)
+                continue;
+
+            for (float alpha : { 0.0f, 0.5f, 1.0f })
+            {
+                CaptureBody(game, alpha, snapshot, corners);
+                RasterizeCells(snapshot, instances, cells);
+                RasterizeRuns(snapshot, corners, instances, runs);
+                const size_t missing = cells.CountMissingFrom(runs);
+                const size_t extra = runs.CountMissingFrom(cells);
+                if (alpha == 0.5f)
+                {
+                    midMissing += missing;
+                    midExtra += extra;
+                }
+                else
+                {
+                    wholeDiffer += missing + extra;
+                }
+                frames++;
+            }
+        }
+
+        const bool ok = frames > 0 && wholeDiffer == 0 && midMissing == 0;
+        printf("coverage:       %zu frames, %zu pixels differ on whole cells, mid-step %zu missing, %zu corner fill  %s\n",
+            frames, wholeDiffer, midMissing, midExtra, ok ? "ok" : "FAILED");
+        return ok;
+    }
+
+    // Snake of about `length` cells following the Hamiltonian cycle (one turn
+    // per board row once it is long)
+    void GrowAlongCycle(SnakeGame& game, size_t length)
+    {
+        game.Reset(c_screenWidth, c_screenHeight, 3);
+        game.Grow(static_cast<int>(length) - SnakeGame::c_initialSnakeLength);
+        while (game.GetLength() < length && !game.IsGameOver() && !game.IsWon())
+        {
+            Bench::SteerAndStep(game, c_gridWidth, c_gridHeight);
+        }
+    }
+
+    // The worst case for runs: a staircase, turning on every step
+    void GrowStaircase(SnakeGame& game, size_t length)
+    {
+        game.Reset(c_screenWidth, c_screenHeight, 3);
+        game.Grow(static_cast<int>(length) - SnakeGame::c_initialSnakeLength);
+        for (size_t step = 0; step < length; ++step)
+        {
+            game.QueueDirection((step & 1) ? Direction::Right : Direction::Up);
+            game.Update(SnakeGame::c_moveInterval);
+        }
+    }
+
+    double MeasureScene(const GameSessionSnapshot& snapshot, const std::vector<GridCell>& corners, SnakeBodyStyle style,
+        std::vector<SpriteInstance>& instances, size_t& quads, int repeats)
+    {
+        Bench::Stopwatch timer;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            instances.resize(CountSceneInstances(snapshot, corners, style));
+            quads = WriteSceneInstances(snapshot, corners, Float2{ 1.0f, -1.0f }, style, instances.data(), instances.size());
+            Bench::DoNotOptimize(instances);
+        }
+        return timer.ElapsedSeconds();
+    }
+
+    void ReportLength(const char* shape, const SnakeGame& game)
+    {
+        GameSessionSnapshot snapshot = {};
+        std::vector<GridCell> corners;
+        CaptureBody(game, 0.375f, snapshot, corners);
+        std::vector<SpriteInstance> instances;
+        size_t cellQuads = 0;
+        size_t runQuads = 0;
+        const int repeats = std::max(200, static_cast<int>(4e6 / static_cast<double>(game.GetLength())));
+
+        MeasureScene(snapshot, corners, SnakeBodyStyle::Cells, instances, cellQuads, 1);  // Warm up: grow the buffer
+        const double cellsNs = MeasureScene(snapshot, corners, SnakeBodyStyle::Cells, instances, cellQuads, repeats) * 1e9 / repeats;
+        const double runsNs = MeasureScene(snapshot, corners, SnakeBodyStyle::Runs, instances, runQuads, repeats) * 1e9 / repeats;
+        printf("%-10s %8zu %10zu %10zu %12.1f %12.1f %9.1fx\n", shape, game.GetLength(), cellQuads, runQuads,
+            cellsNs, runsNs, cellsNs / runsNs);
+    }
+
+    // A staircase has a corner on every cell, so runs would save nothing: asked
+    // for runs, the scene writer must draw the body as cell squares instead
+    bool CheckFallback()
+    {
+        SnakeGame game;
+        GrowStaircase(game, 40);
+        GameSessionSnapshot snapshot = {};
+        std::vector<GridCell> corners;
+        CaptureBody(game, 0.375f, snapshot, corners);
+
+        std::vector<SpriteInstance> instances(CountSceneInstances(snapshot, corners, SnakeBodyStyle::Runs));
+        const size_t quads = WriteSceneInstances(snapshot, corners, Float2{ 0.0f, 0.0f }, SnakeBodyStyle::Runs,
+            instances.data(), instances.size());
+        size_t squares = 0;
+        for (size_t i = 0; i < quads; ++i)
+        {
+            squares += (instances[i].size.x == c_segmentDrawSize && instances[i].size.y == c_segmentDrawSize) ? 1 : 0;
+        }
+
+        const bool ok = quads == game.GetLength() && squares == quads;
+        printf("fallback:       staircase of %zu cells, %zu corners: %zu quads, %zu cell squares  %s\n", game.GetLength(),
+            game.GetCornerCount(), quads, squares, ok ? "ok" : "FAILED");
+        return ok;
+    }
+}
+
+int RunSnakeRunsBench()
+{
+    bool ok = true;
+    ok &= CheckCorners();
+    ok &= CheckCoverage();
+    ok &= CheckFallback();
+
+    printf("\n%-10s %8s %10s %10s %12s %12s %10s\n", "shape", "length", "cell quads", "run quads", "cells ns/f", "runs ns/f", "speedup");
+    SnakeGame game;
+    for (size_t length : { 10, 100, 500, 1000, 2000, 3000 })
+    {
+        GrowAlongCycle(game, length);
+        ReportLength("cycle", game);
+    }
+    GrowStaircase(game, 40);
+    ReportLength("staircase", game);
+    printf("(quads include the head; %zu bytes per quad)\n", sizeof(SpriteInstance));
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+//
+// SnakeStepBench.cpp
+// Per-step cost of SnakeGame as the snake grows (should stay flat)
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+
+#include <cstdio>
+
+int RunSnakeStepBench()
+{
+    // 512 x 256 cells leaves room for a 100k segment snake
+    constexpr int gridWidth = 512;
+    constexpr int gridHeight = 256;
+    constexpr int screenWidth = gridWidth * static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int screenHeight = gridHeight * static_cast<int>(SnakeGame::c_cellSize);
+    constexpr int timedSteps = 100000;
+
+    const int lengths[] = { 3, 100, 1000, 10000, 100000 };
+
+    printf("%10s %12s %12s\n", "length", "steps", "ns/step");
+
+    for (int length : lengths)
+    {
+        SnakeGame game;
+        game.Reset(screenWidth, screenHeight, 1);
+        game.Grow(length - static_cast<int>(game.GetLength()));
+
+        // Walk the cycle until the requested length is reached (untimed)
+        while (static_cast<int>(game.GetLength()) < length && !game.IsGameOver())
+        {
+            Bench::SteerAndStep(game, gridWidth, gridHeight);
+        }
+
+        Bench::Stopwatch timer;
+        for (int step = 0; step < timedSteps && !game.IsGameOver(); ++step)
+        {
+            Bench::SteerAndStep(game, gridWidth, gridHeight);
+        }
+        const double seconds = timer.ElapsedSeconds();
+
+        if (game.IsGameOver())
+        {
+            printf("snake died at length %zu - steering bug\n", game.GetLength());
+            return 1;
+        }
+
+        Bench::DoNotOptimize(game.GetScore());
+        printf("%10zu %12d %12.1f\n", game.GetLength(), timedSteps, seconds * 1e9 / timedSteps);
+    }
+
+    return 0;
+}
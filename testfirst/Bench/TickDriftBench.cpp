@@ -0,0 +1,132 @@
+//
+// TickDriftBench.cpp
+// Movement timing over 24 simulated hours at fixed and mixed frame rates: the tick
+// clock against the old float accumulator
+//
+
+#include "pch.h"
+#include "BenchCommon.h"
+
+#include <cstdio>
+
+namespace
+{
+    constexpr uint64_t c_simulatedSeconds = 24 * 60 * 60;
+    constexpr uint64_t c_totalTicks = c_simulatedSeconds * SnakeGame::c_ticksPerSecond;
+
+    // A 64 x 48 board takes millions of steps to fill, so a cycle-following snake
+    // stays alive for the whole day
+    constexpr int c_gridWidth = 64;
+    constexpr int c_gridHeight = 48;
+
+    // Frame boundaries come from a display clock running at `hz`, read in whole
+    // ticks the way StepTimer does (so frames are 69444 or 69445 ticks at 144 Hz)
+    struct FrameClock
+    {
+        uint64_t frame = 0;
+        uint64_t hz = 60;
+
+        uint64_t NextFrameTicks()
+        {
+            const uint64_t start = frame * SnakeGame::c_ticksPerSecond / hz;
+            frame++;
+            return frame * SnakeGame::c_ticksPerSecond / hz - start;
+        }
+    };
+
+    struct DriftResult
+    {
+        uint64_t frames;
+        uint64_t steps;  // SnakeGame on ticks
+        uint64_t floatSteps;  // The pre-tick float accumulator fed the same frames
+        bool alive;
+    };
+
+    // mixedRates: every frame picks one of several display rates (frame pacing
+    // hiccups, refresh changes); otherwise a fixed rate
+    DriftResult Run(uint64_t hz, bool mixedRates)
+    {
+        SnakeGame game;
+        game.Reset(c_gridWidth * static_cast<int>(SnakeGame::c_cellSize), c_gridHeight * static_cast<int>(SnakeGame::c_cellSize), 3);
+
+        const uint64_t rates[] = { 30, 60, 144, 240 };
+        Pcg32 rateRandom(hz);
+        FrameClock clock;
+        clock.hz = mixedRates ? 60 : hz;
+
+        DriftResult result = {};
+        float floatAccumulator = 0.0f;
+        uint64_t elapsed = 0;
+
+        while (elapsed < c_totalTicks)
+        {
+            uint64_t frameTicks;
+            if (mixedRates)
+            {
+                const uint64_t rate = rates[rateRandom.NextBelow(4)];
+                frameTicks = SnakeGame::c_ticksPerSecond / rate + ((rateRandom.Next() & 1) ? 1 : 0);
+            }
+            else
+            {
+                frameTicks = clock.NextFrameTicks();
+            }
+            frameTicks = (elapsed + frameTicks > c_totalTicks) ? c_totalTicks - elapsed : frameTicks;
+            elapsed += frameTicks;
+            result.frames++;
+
+            const GridCell head = game.GetHead();
+            game.QueueDirection(Bench::HamiltonianDirection(head.x, head.y, c_gridWidth, c_gridHeight));
+            result.steps += static_cast<uint64_t>(game.UpdateTicks(frameTicks).steps);
+
+            // What Update(float) used to do with StepTimer::GetElapsedSeconds()
+            floatAccumulator += static_cast<float>(SnakeGame::TicksToSeconds(frameTicks));
+            while (floatAccumulator >= SnakeGame::c_moveInterval)
+            {
+                floatAccumulator -= SnakeGame::c_moveInterval;
+                result.floatSteps++;
+            }
+        }
+
+        result.alive = !game.IsGameOver();
+        return result;
+    }
+}
+
+int RunTickDriftBench()
+{
+    const uint64_t expectedSteps = c_totalTicks / SnakeGame::c_moveIntervalTicks;
+    printf("%llu simulated seconds, %llu steps expected\n",
+        static_cast<unsigned long long>(c_simulatedSeconds), static_cast<unsigned long long>(expectedSteps));
+    printf("%10s %12s %12s %10s %12s %10s %8s\n", "rate", "frames", "tick steps", "drift", "float steps", "drift", "check");
+
+    struct Profile
+    {
+        const char* name;
+        uint64_t hz;
+        bool mixed;
+    };
+    const Profile profiles[] =
+    {
+        { "60 Hz", 60, false },
+        { "144 Hz", 144, false },
+        { "240 Hz", 240, false },
+        { "mixed", 0, true },
+    };
+
+    int result = 0;
+    for (const Profile& profile : profiles)
+    {
+        const DriftResult run = Run(profile.hz, profile.mixed);
+        const long long drift = static_cast<long long>(run.steps) - static_cast<long long>(expectedSteps);
+        const long long floatDrift = static_cast<long long>(run.floatSteps) - static_cast<long long>(expectedSteps);
+        const bool ok = run.alive && drift == 0;
+
+        printf("%10s %12llu %12llu %10lld %12llu %10lld %8s\n", profile.name,
+            static_cast<unsigned long long>(run.frames), static_cast<unsigned long long>(run.steps), drift,
+            static_cast<unsigned long long>(run.floatSteps), floatDrift, ok ? "ok" : (run.alive ? "DRIFT" : "DIED"));
+        if (!ok)
+            result = 1;
+    }
+
+    return result;
+}
@@ -5,61 +5,71 @@
 
 #include "pch.h"
 #include "Effects2D.h"
-#include <SpriteBatch.h>
-#include <DirectXMath.h>
-#include <DirectXColors.h>
-#include <cstdlib>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
-using namespace DirectX;
-
 Effects2D::Effects2D()
-    : m_shakeIntensity(0.0f)
+    : m_particles(c_maxParticles)
+    , m_library(EmitterLibrary::CreateDefault())
+    , m_eatEmitter(m_library.Find("eat"))
+    , m_emitters{}
+    , m_emitterCount(0)
+    , m_budget(ParticleBudgetSettings::Deterministic(c_maxParticles))
+    , m_shakeIntensity(0.0f)
     , m_shakeTimeLeft(0.0f)
     , m_shakeDuration(0.0f)
 {
-    m_cameraOffset = XMFLOAT2(0.0f, 0.0f);
+    m_cameraOffset = Float2{ 0.0f, 0.0f };
 }
 
-void Effects2D::OnEatFood(const DirectX::XMFLOAT2& foodPos)
+void Effects2D::Reset(uint64_t seed)
 {
-    SpawnEatParticles(foodPos);
+    m_particles.Clear();
+    m_emitterCount = 0;
+    m_cameraOffset = Float2{ 0.0f, 0.0f };
+    m_shakeIntensity = 0.0f;
+    m_shakeTimeLeft = 0.0f;
+    m_shakeDuration = 0.0f;
+    m_random.Seed(seed);
+}
+
+void Effects2D::SetEmitterLibrary(EmitterLibrary library)
+{
+    m_library = std::move(library);
+    m_eatEmitter = m_library.Find("eat");
+    m_particles.Clear();
+    m_emitterCount = 0;
+}
+
+void Effects2D::OnEatFood(const Float2& foodPos)
+{
+    if (m_eatEmitter >= 0)
+    {
+        Emit(static_cast<size_t>(m_eatEmitter), foodPos);
+    }
     StartScreenShake(c_shakeIntensity, c_shakeDuration);
-#ifdef _DEBUG
+#if defined(_DEBUG) && (defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX))
     // Log particle count for debugging
     char debugMsg[128];
     sprintf_s(debugMsg, "Effects2D: Spawned %d particles, shake intensity=%.1f\n", 
-        static_cast<int>(m_particles.size()), c_shakeIntensity);
+        static_cast<int>(m_particles.GetCount()), c_shakeIntensity);
     OutputDebugStringA(debugMsg);
 #endif
 }
 
 void Effects2D::Update(float elapsedTime)
 {
-    // Update particles
-    for (auto it = m_particles.begin(); it != m_particles.end();)
-    {
-        Particle& p = *it;
-        p.lifetime -= elapsedTime;
-
-        if (p.lifetime <= 0.0f)
-        {
-            // Particle expired, remove it
-            it = m_particles.erase(it);
-        }
-        else
-        {
-            // Update position
-            p.pos.x += p.velocity.x * elapsedTime;
-            p.pos.y += p.velocity.y * elapsedTime;
-
-            // Fade out color based on lifetime
-            float t = p.lifetime / p.maxLifetime;
-            p.color.w = t; // Alpha fade
-
-            ++it;
-        }
-    }
+    // Update particles, then spawn this frame's share from running emitters; the
+    // time it takes is what a time budget limits (the clock is only read then, so
+    // a count-only budget stays deterministic)
+    const bool timed = m_budget.GetSettings().updateBudgetMs > 0.0;
+    const auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    const size_t particleCount = m_particles.GetCount();
+    m_particles.Update(elapsedTime);
+    UpdateEmitters(elapsedTime);
+    const double seconds = timed ? std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() : 0.0;
+    m_budget.OnUpdate(seconds, particleCount);
 
     // Update screen shake
     if (m_shakeTimeLeft > 0.0f)
@@ -73,8 +83,8 @@ void Effects2D::Update(float elapsedTime)
             float currentIntensity = m_shakeIntensity * t;
 
             // Random offset in range [-currentIntensity, currentIntensity]
-            float angle = static_cast<float>(rand()) / RAND_MAX * XM_2PI;
-            float distance = static_cast<float>(rand()) / RAND_MAX * currentIntensity;
+            float angle = m_random.NextFloat() * c_twoPi;
+            float distance = m_random.NextFloat() * currentIntensity;
 
             m_cameraOffset.x = cosf(angle) * distance;
             m_cameraOffset.y = sinf(angle) * distance;
@@ -82,67 +92,66 @@ void Effects2D::Update(float elapsedTime)
         else
         {
             // Shake finished
-            m_cameraOffset = XMFLOAT2(0.0f, 0.0f);
+            m_cameraOffset = Float2{ 0.0f, 0.0f };
             m_shakeTimeLeft = 0.0f;
         }
     }
 }
 
-void Effects2D::Draw(
-    DirectX::DX12::SpriteBatch* spriteBatch,
-    D3D12_GPU_DESCRIPTOR_HANDLE placeholderSRV,
-    const DirectX::XMFLOAT2& cameraOffset) const
+void Effects2D::Emit(size_t emitter, const Float2& pos)
 {
-    if (!spriteBatch || placeholderSRV.ptr == 0)
-        return;
+    const EmitterDefinition& definition = m_library.GetDefinition(emitter);
+    SpawnParticles(emitter, pos, definition.burstCount);
+
+    if (definition.spawnRate > 0.0f && definition.duration > 0.0f && m_emitterCount < c_maxEmitters)
+    {
+        m_emitters[m_emitterCount++] = EmitterInstance{ static_cast<uint16_t>(emitter), pos, definition.duration, 0.0f };
+    }
+}
 
-    // Draw all particles
-    for (const auto& particle : m_particles)
+void Effects2D::UpdateEmitters(float elapsedTime)
+{
+    for (size_t i = 0; i < m_emitterCount;)
     {
-        // Apply camera offset to particle position
-        XMFLOAT2 drawPos;
-        drawPos.x = particle.pos.x + cameraOffset.x - particle.size * 0.5f;
-        drawPos.y = particle.pos.y + cameraOffset.y - particle.size * 0.5f;
-
-        // Convert color to XMVECTOR
-        XMVECTOR colorVec = XMVectorSet(
-            particle.color.x,
-            particle.color.y,
-            particle.color.z,
-            particle.color.w);
-
-        spriteBatch->Draw(
-            placeholderSRV,
-            XMUINT2(1, 1),
-            drawPos,
-            nullptr,
-            colorVec,
-            0.0f,
-            XMFLOAT2(0.0f, 0.0f),
-            particle.size);
+        EmitterInstance& instance = m_emitters[i];
+        const EmitterDefinition& definition = m_library.GetDefinition(instance.definition);
+
+        // Spawn for the part of the frame the emitter was still running
+        instance.spawnCredit += definition.spawnRate * std::min(elapsedTime, instance.timeLeft);
+        const float count = floorf(instance.spawnCredit);
+        instance.spawnCredit -= count;
+        SpawnParticles(instance.definition, instance.pos, static_cast<size_t>(count));
+
+        instance.timeLeft -= elapsedTime;
+        if (instance.timeLeft <= 0.0f)
+        {
+            // Swap-remove; the moved-in instance is updated next iteration
+            m_emitters[i] = m_emitters[--m_emitterCount];
+        }
+        else
+        {
+            ++i;
+        }
     }
 }
 
-void Effects2D::SpawnEatParticles(const DirectX::XMFLOAT2& pos)
+void Effects2D::SpawnParticles(size_t emitter, const Float2& pos, size_t count)
 {
-    for (int i = 0; i < c_particlesPerEat; ++i)
+    constexpr float degreesToRadians = c_twoPi / 360.0f;
+    const EmitterDefinition& definition = m_library.GetDefinition(emitter);
+    const ParticleBudget::Grant grant = m_budget.Request(definition.priority, count, m_particles.GetCount());
+
+    // One append for the whole burst, then fill it in place
+    const size_t first = m_particles.Append(grant.count);
+    for (size_t i = first; i < m_particles.GetCount(); ++i)
     {
-        Particle p;
-        p.pos = pos;
-        p.maxLifetime = c_particleLifetime;
-        p.lifetime = c_particleLifetime;
-        p.size = 12.0f + static_cast<float>(rand() % 12); // Random size 12-24 (increased for visibility)
-
-        // Random velocity in all directions
-        float angle = static_cast<float>(rand()) / RAND_MAX * XM_2PI;
-        float speed = c_particleSpeed * (0.5f + static_cast<float>(rand()) / RAND_MAX * 0.5f); // 50-100% speed
-        p.velocity.x = cosf(angle) * speed;
-        p.velocity.y = sinf(angle) * speed;
-
-        // Gold color with full alpha
-        p.color = XMFLOAT4(1.0f, 0.84f, 0.0f, 1.0f); // Gold
-
-        m_particles.push_back(p);
+        const float angle = definition.angle.Lerp(m_random.NextFloat()) * degreesToRadians;
+        const float speed = definition.speed.Lerp(m_random.NextFloat());
+        const Float2 velocity = { cosf(angle) * speed, sinf(angle) * speed };
+        const float lifetime = definition.lifetime.Lerp(m_random.NextFloat()) * grant.lifetimeScale;
+        const float size = definition.size.Lerp(m_random.NextFloat());
+
+        m_particles.Set(i, pos, velocity, lifetime, size, static_cast<uint16_t>(emitter));
     }
 }
 
@@ -5,68 +5,111 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
-#include <DirectXMath.h>
 
-// Forward declarations
-namespace DirectX
-{
-    namespace DX12
-    {
-        class SpriteBatch;
-    }
-}
-
-// Particle structure
-struct Particle
-{
-    DirectX::XMFLOAT2 pos;
-    DirectX::XMFLOAT2 velocity;
-    DirectX::XMFLOAT4 color;
-    float lifetime;  // Remaining lifetime in seconds
-    float maxLifetime;  // Total lifetime in seconds
-    float size;
-};
+#include "ParticleBudget.h"
+#include "ParticleEmitter.h"
+#include "ParticlePool.h"
+#include "Random.h"
 
-// Effects system for 2D rendering (particles + screen shake)
+// Effects system for 2D rendering (particles + screen shake).
+// Particles come from emitters defined in an EmitterLibrary: Emit spawns a
+// definition's burst, and one with a spawn rate also takes an instance from a
+// fixed pool that keeps spawning for its duration. Neither allocates. Every
+// spawn first asks the ParticleBudget how much of it the frame can afford. By
+// default that is a count cap only, so the same seed and calls give the same
+// particles on any machine; with a time budget (SetParticleBudget) the budget
+// also learns the cost of particles from the measured time of Update, and what
+// is shed then depends on the host.
 class Effects2D
 {
 public:
+    static constexpr size_t c_maxParticles = 4096;
+    static constexpr size_t c_maxEmitters = 64;  // Running (rate-based) emitters
+    static constexpr double c_updateBudgetMs = 0.5;  // Update time budget for interactive use (not the default)
+
     Effects2D();
     ~Effects2D() = default;
 
+    // Clear all particles, emitters and shake, and seed the effects RNG
+    void Reset(uint64_t seed);
+
+    // Replace the emitter definitions (the default library until then); clears
+    // particles and running emitters, since their curves may be gone
+    void SetEmitterLibrary(EmitterLibrary library);
+    const EmitterLibrary& GetEmitterLibrary() const { return m_library; }
+
     // Trigger effects
-    void OnEatFood(const DirectX::XMFLOAT2& foodPos);
+    void OnEatFood(const Float2& foodPos);
+
+    // Spawn the burst of definition `emitter` (a library index) at pos and, if it
+    // has a spawn rate, keep spawning there for its duration (dropped when
+    // c_maxEmitters are already running)
+    void Emit(size_t emitter, const Float2& pos);
 
     // Update effects
     void Update(float elapsedTime);
 
-    // Draw particles (requires SpriteBatch and placeholder texture SRV)
-    void Draw(
-        DirectX::DX12::SpriteBatch* spriteBatch,
-        D3D12_GPU_DESCRIPTOR_HANDLE placeholderSRV,
-        const DirectX::XMFLOAT2& cameraOffset) const;
-
     // Get current camera offset from screen shake
-    DirectX::XMFLOAT2 GetCameraOffset() const { return m_cameraOffset; }
+    Float2 GetCameraOffset() const { return m_cameraOffset; }
+
+    // Number of live particles
+    size_t GetParticleCount() const { return m_particles.GetCount(); }
+
+    // Limits on live particles and Update time (default:
+    // ParticleBudgetSettings::Deterministic(c_maxParticles), no clock read);
+    // maxParticles past c_maxParticles has no effect
+    void SetParticleBudget(const ParticleBudgetSettings& settings) { m_budget.SetSettings(settings); }
+
+    // The budget's limit and shedding counters
+    const ParticleBudget& GetParticleBudget() const { return m_budget; }
+
+    // Number of running (rate-based) emitters
+    size_t GetEmitterCount() const { return m_emitterCount; }
+
+    // Live particles (their curve indices refer to GetEmitterLibrary().GetCurves())
+    const ParticlePool& GetParticles() const { return m_particles; }
+
+    // Drawable copy of the live particles (e.g. for a GameSessionSnapshot)
+    void ExportParticles(std::vector<Particle>& particles) const { m_particles.Export(particles, m_library.GetCurves()); }
 
 private:
-    void SpawnEatParticles(const DirectX::XMFLOAT2& pos);
+    // A rate-based emitter still spawning
+    struct EmitterInstance
+    {
+        uint16_t definition;
+        Float2 pos;
+        float timeLeft;     // Seconds of spawning left
+        float spawnCredit;  // Fraction of a particle carried to the next frame
+    };
+
+    void SpawnParticles(size_t emitter, const Float2& pos, size_t count);
+    void UpdateEmitters(float elapsedTime);
     void StartScreenShake(float intensity, float duration);
 
-    // Particles
-    std::vector<Particle> m_particles;
+    // Particles (bursts past c_maxParticles are cut short)
+    ParticlePool m_particles;
+
+    // Emitter definitions and the running instances, [0, m_emitterCount) live
+    EmitterLibrary m_library;
+    int m_eatEmitter;  // -1 when the library has no "eat" emitter
+    std::array<EmitterInstance, c_maxEmitters> m_emitters;
+    size_t m_emitterCount;
+
+    ParticleBudget m_budget;
 
     // Screen shake
-    DirectX::XMFLOAT2 m_cameraOffset;
+    Float2 m_cameraOffset;
     float m_shakeIntensity;
     float m_shakeTimeLeft;
     float m_shakeDuration;
 
+    // Particle spread and shake jitter (seeded by Reset)
+    Pcg32 m_random;
+
     // Constants
-    static constexpr int c_particlesPerEat = 12;  // Increased from 8 for more visible effect
-    static constexpr float c_particleLifetime = 0.6f;  // Increased from 0.5f
-    static constexpr float c_particleSpeed = 150.0f;  // Increased from 100.0f
     static constexpr float c_shakeIntensity = 8.0f;  // Increased from 5.0f for more visible shake
     static constexpr float c_shakeDuration = 0.2f;  // Increased from 0.15f
+    static constexpr float c_twoPi = 6.283185307f;
 };
@@ -28,10 +28,12 @@ using Microsoft::WRL::ComPtr;
 // Use full namespace qualification instead
 
 Game::Game() noexcept(false)
-    : m_state(GameState::Title)
-    , m_time(0.0f)
+    : m_time(0.0f)
     , m_gameInput(nullptr)
     , m_rumbleTimeLeft(0.0f)
+#if SNAKE_LATENCY_TRACE
+    , m_lastRenderedState(GameState::Title)
+#endif
 {
     m_deviceResources = std::make_unique<DX::DeviceResources>();
     // TODO: Provide parameters for swapchain format, depth/stencil format, and backbuffer count.
@@ -39,6 +41,37 @@ Game::Game() noexcept(false)
     //   Add DX::DeviceResources::c_EnableHDR for HDR10 display.
     //   Add DX::DeviceResources::c_ReverseDepth to optimize depth buffer clears for 0 instead of 1.
     m_deviceResources->RegisterDeviceNotify(this);
+
+    // The board covers the default window area
+    int width, height;
+    GetDefaultSize(width, height);
+    const uint64_t seed = static_cast<uint64_t>(time(nullptr));
+
+#if defined(_GAMING_DESKTOP)
+    // Record every run so reported issues can be replayed with snake_headless --replay
+    try
+    {
+        auto recorder = std::make_unique<ReplayRecorder>();
+        recorder->Start(c_replayPath, ReplayHeader{ seed, width, height });
+        m_replayRecorder = std::move(recorder);
+    }
+    catch (const std::exception& e)
+    {
+        AddLog(e.what());
+    }
+#endif
+
+    // Run the game flow on its own thread from here on (it shows the title screen
+    // until input arrives). Particles update inline on the simulation thread: the
+    // effects never hold enough for ParticlePool's parallel path to pay off.
+    static_assert(Effects2D::c_maxParticles < ParticlePool::c_minParallelCount,
+        "Effects2D can now reach ParticlePool's parallel path: give it a ThreadPool");
+    m_simulation = std::make_unique<SimulationThread>();
+    // Shed particles by measured update time as well as count. What is shed then
+    // depends on this machine, which only the visuals see: replays check gameplay,
+    // and snake_headless replays them with the deterministic count cap.
+    m_simulation->SetParticleBudget(ParticleBudgetSettings{ Effects2D::c_maxParticles, Effects2D::c_updateBudgetMs });
+    m_simulation->Start(width, height, seed, m_replayRecorder.get());
     
     // Initialize GameInput
 #if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
@@ -46,6 +79,7 @@ Game::Game() noexcept(false)
     if (SUCCEEDED(GameInput::v3::GameInputCreate(&gameInput)))
     {
         m_gameInput = gameInput;
+        m_inputBackend = std::make_unique<GameInputBackend>(gameInput);
     }
     else
     {
@@ -62,9 +96,21 @@ Game::~Game()
     {
         m_deviceResources->WaitForGpu();
     }
+
+    // Stop the simulation first: it records into the replay
+    if (m_simulation)
+    {
+        m_simulation->Stop();
+        if (m_replayRecorder)
+        {
+            m_replayRecorder->Finish(m_simulation->GetResult());
+        }
+    }
     
     // Release GameInput
 #if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+    m_inputBackend.reset();
+    m_activeGamepadDevice.Reset();
     if (m_gameInput)
     {
         static_cast<GameInput::v3::IGameInput*>(m_gameInput)->Release();
@@ -121,34 +167,31 @@ void Game::Update(DX::StepTimer const& timer)
     // Update rumble timer
     UpdateRumble(elapsedTime);
 
-    // Update effects
-    m_effects.Update(elapsedTime);
-
-    // Poll input using InputRouter
+    // Poll input using InputRouter: every reading since the last frame, so presses
+    // shorter than a frame (or made during a hitch) are not lost
+    m_inputEvents.clear();
 #if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
-    GameInput::v3::IGameInputDevice* activeDevice = nullptr;
-    InputState inputState = m_inputRouter.Poll(m_gameInput, &activeDevice);
-    
-    // Update active gamepad device for rumble
-    if (activeDevice)
+    if (m_inputBackend)
     {
-        m_activeGamepadDevice = activeDevice;
-        activeDevice->Release(); // Release extra reference from Poll
-        
-#ifdef _DEBUG
-        // Log device acquisition (only once)
-        static bool loggedDevice = false;
-        if (!loggedDevice && m_activeGamepadDevice)
+        m_inputRouter.Poll(*m_inputBackend, &m_inputEvents);
+
+        // Update active gamepad device for rumble
+        GameInput::v3::IGameInputDevice* activeDevice = m_inputBackend->GetGamepadDevice();
+        if (activeDevice && activeDevice != m_activeGamepadDevice.Get())
         {
+            m_activeGamepadDevice = activeDevice;
+
+#ifdef _DEBUG
+            // Log device acquisition
             const GameInput::v3::GameInputDeviceInfo* info = nullptr;
             m_activeGamepadDevice->GetDeviceInfo(&info);
             if (info)
             {
                 char debugMsg[256];
-                sprintf_s(debugMsg, "Gamepad device acquired: %p, Rumble motors: 0x%X\n", 
+                sprintf_s(debugMsg, "Gamepad device acquired: %p, Rumble motors: 0x%X\n",
                     m_activeGamepadDevice.Get(), info->supportedRumbleMotors);
                 AddLog(debugMsg);
-                
+
                 if (info->supportedRumbleMotors & (GameInput::v3::GameInputRumbleLowFrequency | GameInput::v3::GameInputRumbleHighFrequency))
                 {
                     AddLog("Device supports rumble motors\n");
@@ -158,79 +201,64 @@ void Game::Update(DX::StepTimer const& timer)
                     AddLog("WARNING: Device does not support rumble motors!\n");
                 }
             }
-            loggedDevice = true;
-        }
 #endif
+        }
     }
-#else
-    InputState inputState = m_inputRouter.Poll(m_gameInput, nullptr);
 #endif
 
-    // Handle state transitions based on input
-    if (inputState.startPressed)
+    // Hand the input to the simulation thread, one entry per reading that produced
+    // input. The simulation runs the game flow at its own fixed rate on integer
+    // ticks (so movement timing does not depend on the frame rate) and records it
+    // into the replay. The ring holds seconds of input, so a full ring means the
+    // simulation thread has stalled.
+#if SNAKE_LATENCY_TRACE
+    // Each input starts a trace: its reading time (moved from the device clock to
+    // the trace clock by its age) and this poll
+    const uint64_t polledTime = LatencyNow();
+    uint64_t backendNow = 0;
+#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+    if (m_inputBackend)
     {
-        if (m_state == GameState::Title)
-        {
-            m_state = GameState::Playing;
-            int width, height;
-            GetDefaultSize(width, height);
-            m_snakeGame.Reset(width, height);
-        }
-        else if (m_state == GameState::Paused)
-        {
-            m_state = GameState::Playing;
-        }
-        else if (m_state == GameState::Win || m_state == GameState::GameOver)
-        {
-            m_state = GameState::Playing;
-            int width, height;
-            GetDefaultSize(width, height);
-            m_snakeGame.Reset(width, height);
-        }
+        backendNow = m_inputBackend->GetCurrentTimestamp();
     }
-
-    if (inputState.pausePressed)
+#endif
+#endif
+    for (const InputEvent& event : m_inputEvents)
     {
-        if (m_state == GameState::Playing)
-        {
-            m_state = GameState::Paused;
-            StopRumble();
-        }
-        else if (m_state == GameState::Paused)
+#if SNAKE_LATENCY_TRACE
+        const uint64_t ageNs = (backendNow > event.timestamp) ? (backendNow - event.timestamp) * 1000 : 0;
+        const TurnTrace trace = m_latency.BeginTurn((polledTime > ageNs) ? polledTime - ageNs : 0, polledTime);
+        const bool pushed = m_simulation->PushInput(event.input, trace);
+#else
+        const bool pushed = m_simulation->PushInput(event.input);
+#endif
+        if (!pushed)
         {
-            m_state = GameState::Playing;
+#ifdef _DEBUG
+            AddLog("WARNING: Simulation input queue full - input dropped\n");
+#endif
+            break;
         }
     }
 
-    // Handle direction input and snake game update (only in Playing state)
-    if (m_state == GameState::Playing)
+    // Handle feedback from the updates the simulation ran since the last frame (one
+    // update can eat more than one food)
+    SimulationFeedback feedback;
+    while (m_simulation->PopFeedback(feedback))
     {
-        // Queue direction if input changed
-        if (inputState.dir.has_value())
-        {
-            m_snakeGame.QueueDirection(inputState.dir.value());
-        }
-
-        // Update snake game
-        SnakeGameEvents events = m_snakeGame.Update(elapsedTime);
-
-        // Handle events
-        if (events.ateFood)
+        if (feedback.foodEaten > 0)
         {
 #ifdef _DEBUG
             char debugMsg[256];
-            sprintf_s(debugMsg, "Food eaten at (%.1f, %.1f) - triggering effects\n", events.foodPos.x, events.foodPos.y);
+            sprintf_s(debugMsg, "Food eaten x%d - triggering effects\n", feedback.foodEaten);
             AddLog(debugMsg);
 #endif
-            // Trigger effects
-            m_effects.OnEatFood(events.foodPos);
-            // Trigger rumble
+            // Trigger rumble (restarted per update with food, so it lasts from the last one)
             StartRumble(0.6f, 0.7f, 0.0f, 0.0f, 0.08f);
         }
 
-        if (events.gameOver)
+        if (feedback.stopRumble)
         {
-            m_state = GameState::GameOver;
             StopRumble();
         }
     }
@@ -270,11 +298,31 @@ void Game::Render()
     {
         m_spriteBatch->Begin(commandList);
 
+        // Newest complete state from the simulation thread (never waits for it)
+        const GameSessionSnapshot& snapshot = m_simulation->AcquireSnapshot();
+
+#if SNAKE_LATENCY_TRACE
+        // Every turn stepped into this snapshot was pushed before it was published
+        TurnTrace stepped;
+        while (m_simulation->PopSteppedTurn(stepped))
+        {
+            m_latency.OnStepped(stepped);
+        }
+
+        if (snapshot.state == GameState::Paused && m_lastRenderedState != GameState::Paused)
+        {
+            DumpLatency();
+        }
+        m_lastRenderedState = snapshot.state;
+#endif
+
         // Get camera offset from effects (screen shake)
-        DirectX::XMFLOAT2 cameraOffset = m_effects.GetCameraOffset();
+        const Float2 shakeOffset = snapshot.cameraOffset;
+        DirectX::XMFLOAT2 cameraOffset(shakeOffset.x, shakeOffset.y);
 
         // Draw based on game state
-        switch (m_state)
+        const GameState state = snapshot.state;
+        switch (state)
         {
         case GameState::Title:
         // Draw title screen text
@@ -354,10 +402,10 @@ void Game::Render()
         case GameState::GameOver:
         case GameState::Win:
             // Draw scene (snake, food, particles) with camera offset
-            RenderScene(cameraOffset);
+            RenderScene(snapshot, cameraOffset);
 
             // Draw HUD (no camera offset)
-            RenderHUD();
+            RenderHUD(snapshot);
 
             // Draw state-specific text (no camera offset)
             if (m_spriteFont)
@@ -365,7 +413,7 @@ void Game::Render()
                 int width, height;
                 GetDefaultSize(width, height);
 
-                if (m_state == GameState::Paused)
+                if (state == GameState::Paused)
                 {
                     const wchar_t* pausedText = L"Paused - Press Start";
                     DirectX::XMVECTOR textSize = m_spriteFont->MeasureString(pausedText);
@@ -375,7 +423,7 @@ void Game::Render()
                     float y = (static_cast<float>(height) - textHeight) * 0.5f;
                     m_spriteFont->DrawString(m_spriteBatch.get(), pausedText, DirectX::XMFLOAT2(x, y), DirectX::Colors::White);
                 }
-                else if (m_state == GameState::GameOver)
+                else if (state == GameState::GameOver)
                 {
                     const wchar_t* gameOverText = L"Game Over - Press A to Restart";
                     DirectX::XMVECTOR textSize = m_spriteFont->MeasureString(gameOverText);
@@ -385,7 +433,7 @@ void Game::Render()
                     float y = (static_cast<float>(height) - textHeight) * 0.5f;
                     m_spriteFont->DrawString(m_spriteBatch.get(), gameOverText, DirectX::XMFLOAT2(x, y), DirectX::Colors::Red);
                 }
-                else if (m_state == GameState::Win)
+                else if (state == GameState::Win)
                 {
                     const wchar_t* winText = L"You Win - Press A to Restart";
                     DirectX::XMVECTOR textSize = m_spriteFont->MeasureString(winText);
@@ -448,6 +496,10 @@ void Game::Render()
     }
     
         m_spriteBatch->End();
+
+#if SNAKE_LATENCY_TRACE
+        m_latency.OnRendered(snapshot.lastSteppedTurn, LatencyNow());
+#endif
     }
 
     PIXEndEvent(commandList);
@@ -455,6 +507,9 @@ void Game::Render()
     // Show the new frame.
     PIXBeginEvent(m_deviceResources->GetCommandQueue(), PIX_COLOR_DEFAULT, L"Present");
     m_deviceResources->Present();
+#if SNAKE_LATENCY_TRACE
+    m_latency.OnPresented(LatencyNow());
+#endif
 
     // Commit graphics memory
     m_graphicsMemory->Commit(m_deviceResources->GetCommandQueue());
@@ -463,22 +518,39 @@ void Game::Render()
 }
 
 // Render scene (snake, food, particles) with camera offset
-void Game::RenderScene(const DirectX::XMFLOAT2& cameraOffset)
+void Game::RenderScene(const GameSessionSnapshot& snapshot, const DirectX::XMFLOAT2& cameraOffset)
 {
     if (!m_placeholderTexture || m_placeholderTextureSRV.ptr == 0)
         return;
 
-    const float cellSize = 20.0f; // Match SnakeGame::c_cellSize
+    const float cellSize = SnakeGame::c_cellSize;
     const float segmentSize = cellSize * 0.9f; // Slightly smaller than cell for visual gap
 
-    // Draw snake
-    const auto& snakeSegments = m_snakeGame.GetSnakeSegments();
-    if (!snakeSegments.empty())
+    // Cell coordinates -> pixel position of the cell center
+    auto cellCenter = [cellSize](GridCell cell)
+    {
+        return DirectX::XMFLOAT2(
+            static_cast<float>(cell.x) * cellSize + cellSize * 0.5f,
+            static_cast<float>(cell.y) * cellSize + cellSize * 0.5f);
+    };
+
+    // Draw snake, blended between the last two movement steps so motion stays
+    // smooth at display rates above the 10 Hz step rate
+    const size_t snakeLength = snapshot.segments.size();
+    const float alpha = snapshot.interpolationAlpha;
+    auto segmentCenter = [&](size_t index)
+    {
+        const DirectX::XMFLOAT2 from = cellCenter(snapshot.GetPreviousSegment(index));
+        const DirectX::XMFLOAT2 to = cellCenter(snapshot.segments[index]);
+        return DirectX::XMFLOAT2(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha);
+    };
+
+    if (snakeLength > 0)
     {
         // Draw snake body (all segments except head)
-        for (size_t i = 1; i < snakeSegments.size(); ++i)
+        for (size_t i = 1; i < snakeLength; ++i)
         {
-            const DirectX::XMFLOAT2& segment = snakeSegments[i];
+            const DirectX::XMFLOAT2 segment = segmentCenter(i);
             m_spriteBatch->Draw(
                 m_placeholderTextureSRV,
                 DirectX::XMUINT2(1, 1),
@@ -491,7 +563,7 @@ void Game::RenderScene(const DirectX::XMFLOAT2& cameraOffset)
         }
 
         // Draw snake head (first segment)
-        const DirectX::XMFLOAT2& head = snakeSegments.front();
+        const DirectX::XMFLOAT2 head = segmentCenter(0);
         m_spriteBatch->Draw(
             m_placeholderTextureSRV,
             DirectX::XMUINT2(1, 1),
@@ -504,14 +576,15 @@ void Game::RenderScene(const DirectX::XMFLOAT2& cameraOffset)
     }
 
     // Draw food
-    const Food& food = m_snakeGame.GetFood();
+    const Food& food = snapshot.food;
     if (food.alive)
     {
         const float foodSize = cellSize * 0.8f;
+        const DirectX::XMFLOAT2 foodPos = cellCenter(food.cell);
         m_spriteBatch->Draw(
             m_placeholderTextureSRV,
             DirectX::XMUINT2(1, 1),
-            DirectX::XMFLOAT2(food.pos.x + cameraOffset.x - foodSize * 0.5f, food.pos.y + cameraOffset.y - foodSize * 0.5f),
+            DirectX::XMFLOAT2(foodPos.x + cameraOffset.x - foodSize * 0.5f, foodPos.y + cameraOffset.y - foodSize * 0.5f),
             nullptr,
             DirectX::Colors::Gold, // Food color
             0.0f,
@@ -519,12 +592,24 @@ void Game::RenderScene(const DirectX::XMFLOAT2& cameraOffset)
             foodSize);
     }
 
-    // Draw particles
-    m_effects.Draw(m_spriteBatch.get(), m_placeholderTextureSRV, cameraOffset);
+    // Draw particles, centered on their positions
+    for (const Particle& particle : snapshot.particles)
+    {
+        const Float4 color = UnpackColor(particle.color);
+        m_spriteBatch->Draw(
+            m_placeholderTextureSRV,
+            DirectX::XMUINT2(1, 1),
+            DirectX::XMFLOAT2(particle.pos.x + cameraOffset.x - particle.size * 0.5f, particle.pos.y + cameraOffset.y - particle.size * 0.5f),
+            nullptr,
+            DirectX::XMVectorSet(color.x, color.y, color.z, color.w),
+            0.0f,
+            DirectX::XMFLOAT2(0.0f, 0.0f),
+            particle.size);
+    }
 }
 
 // Render HUD (FPS, Score, Length) - no camera offset
-void Game::RenderHUD()
+void Game::RenderHUD(const GameSessionSnapshot& snapshot)
 {
     if (!m_spriteFont)
         return;
@@ -541,16 +626,51 @@ void Game::RenderHUD()
 
     // Score
     wchar_t scoreText[64];
-    swprintf_s(scoreText, L"Score: %d", m_snakeGame.GetScore());
+    swprintf_s(scoreText, L"Score: %d", snapshot.score);
     m_spriteFont->DrawString(m_spriteBatch.get(), scoreText, DirectX::XMFLOAT2(10.0f, yPos), DirectX::Colors::Yellow);
     yPos += lineHeight;
 
     // Length
     wchar_t lengthText[64];
-    swprintf_s(lengthText, L"Length: %zu", m_snakeGame.GetLength());
+    swprintf_s(lengthText, L"Length: %zu", snapshot.segments.size());
     m_spriteFont->DrawString(m_spriteBatch.get(), lengthText, DirectX::XMFLOAT2(10.0f, yPos), DirectX::Colors::Yellow);
+
+#if SNAKE_LATENCY_TRACE
+    // Input latency: the whole trip, then the median time spent reaching each stage
+    yPos += lineHeight;
+    const LatencyHistogram& total = m_latency.GetTotal();
+    wchar_t latencyText[128];
+    swprintf_s(latencyText, L"Latency: p50 %.1f p99 %.1f ms (%llu turns)",
+        total.GetPercentileMs(0.5), total.GetPercentileMs(0.99), static_cast<unsigned long long>(total.GetCount()));
+    m_spriteFont->DrawString(m_spriteBatch.get(), latencyText, DirectX::XMFLOAT2(10.0f, yPos), DirectX::Colors::Yellow);
+    yPos += lineHeight;
+
+    wchar_t stagesText[160];
+    swprintf_s(stagesText, L"p50 poll %.1f queue %.1f step %.1f draw %.1f present %.1f",
+        m_latency.GetStage(LatencyStage::Polled).GetPercentileMs(0.5),
+        m_latency.GetStage(LatencyStage::Queued).GetPercentileMs(0.5),
+        m_latency.GetStage(LatencyStage::Stepped).GetPercentileMs(0.5),
+        m_latency.GetStage(LatencyStage::Rendered).GetPercentileMs(0.5),
+        m_latency.GetStage(LatencyStage::Presented).GetPercentileMs(0.5));
+    m_spriteFont->DrawString(m_spriteBatch.get(), stagesText, DirectX::XMFLOAT2(10.0f, yPos), DirectX::Colors::Yellow,
+        0.0f, DirectX::XMFLOAT2(0.0f, 0.0f), 0.6f);
+#endif
 }
 
+#if SNAKE_LATENCY_TRACE
+// Input latency histograms to the log (one line per stage, then the total)
+void Game::DumpLatency()
+{
+    AddLog("Input latency (time to reach each stage from the previous one):\n");
+    char line[160];
+    for (size_t stage = 1; stage <= c_latencyStageCount; ++stage)
+    {
+        m_latency.FormatStage(static_cast<LatencyStage>(stage), line, sizeof(line));
+        AddLog(line);
+    }
+}
+#endif
+
 // Start rumble feedback
 void Game::StartRumble(float lowFrequency, float highFrequency, float leftTrigger, float rightTrigger, float durationSeconds)
 {
@@ -14,9 +14,10 @@
 #include <vector>
 
 // Game modules
-#include "SnakeGame.h"
-#include "Effects2D.h"
+#include "GameSession.h"
 #include "InputRouter.h"
+#include "Replay.h"
+#include "SimulationThread.h"
 
 // Include GameInput header if available
 #if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
@@ -46,16 +47,6 @@ namespace DirectX
     }
 }
 
-// Game state enumeration
-enum class GameState
-{
-    Title,      // Title screen - "Press A to Start"
-    Playing,    // Game is running
-    Paused,     // Game is paused - "Paused - Press Start"
-    Win,        // Game won - "You Win - Press A to Restart" (kept for compatibility)
-    GameOver    // Game over - "Game Over - Press A to Restart"
-};
-
 // A basic game implementation that creates a D3D12 device and
 // provides a game loop.
 class Game final : public DX::IDeviceNotify
@@ -107,8 +98,11 @@ private:
     void AddLog(const char* message);
     
     // Rendering helpers
-    void RenderScene(const DirectX::XMFLOAT2& cameraOffset);  // Render snake, food, particles
-    void RenderHUD();  // Render HUD (FPS, Score, Length) - no camera offset
+    void RenderScene(const GameSessionSnapshot& snapshot, const DirectX::XMFLOAT2& cameraOffset);  // Render snake, food, particles
+    void RenderHUD(const GameSessionSnapshot& snapshot);  // Render HUD (FPS, Score, Length) - no camera offset
+#if SNAKE_LATENCY_TRACE
+    void DumpLatency();  // Input latency histograms to the log
+#endif
     
     // Rumble system
     void StartRumble(float lowFrequency, float highFrequency, float leftTrigger, float rightTrigger, float durationSeconds);
@@ -132,13 +126,17 @@ private:
     std::unique_ptr<DirectX::DescriptorHeap>    m_srvDescriptorHeap;
     
     // Game state
-    GameState                                   m_state;
     float                                       m_time;
     
-    // Game modules
-    SnakeGame                                   m_snakeGame;
-    Effects2D                                   m_effects;
+    // Game modules (the GameSession runs on the simulation thread; Update feeds it
+    // input and Render draws its latest snapshot)
+    std::unique_ptr<SimulationThread>           m_simulation;
     InputRouter                                 m_inputRouter;
+
+    // Input replay of the current run (desktop only, see c_replayPath), written
+    // from the simulation thread
+    std::unique_ptr<ReplayRecorder>              m_replayRecorder;
+    static constexpr const char*                 c_replayPath = "LastRun.snakereplay"; // Overwritten each run
     
     // Placeholder texture for player sprite (1x1 white texture)
     Microsoft::WRL::ComPtr<ID3D12Resource>      m_placeholderTexture;
@@ -147,11 +145,20 @@ private:
     // GameInput (forward declared to avoid header dependencies)
     void*                                        m_gameInput; // IGameInput* when GameInput is available
     
-    // Gamepad device for rumble (only when GameInput is available)
+    // Reading history and gamepad device for rumble (only when GameInput is available)
 #if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+    std::unique_ptr<GameInputBackend>           m_inputBackend;
     Microsoft::WRL::ComPtr<GameInput::v3::IGameInputDevice> m_activeGamepadDevice;
 #endif
+    std::vector<InputEvent>                      m_inputEvents; // Input from this frame's readings (reused)
     float                                        m_rumbleTimeLeft; // Remaining rumble time in seconds
+
+#if SNAKE_LATENCY_TRACE
+    // Reading-to-Present latency of each turn: shown in the HUD, dumped to the log
+    // whenever the game is paused
+    LatencyTracker                               m_latency;
+    GameState                                    m_lastRenderedState;
+#endif
     
     // Log buffer for on-screen display
     std::deque<std::string>                      m_logBuffer;
@@ -0,0 +1,164 @@
+//
+// GameSession.cpp
+// Game flow layer implementation
+//
+
+#include "pch.h"
+#include "GameSession.h"
+
+GameSession::GameSession()
+    : m_state(GameState::Title)
+    , m_screenWidth(800)
+    , m_screenHeight(600)
+    , m_seedState(0)
+{
+}
+
+void GameSession::Initialize(int screenWidth, int screenHeight, uint64_t seed)
+{
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_seedState = seed;
+    m_effects.Reset(SplitMix64(m_seedState));
+}
+
+GameSessionEvents GameSession::Update(uint64_t elapsedTicks, const InputState& input)
+{
+    GameSessionEvents events = {};
+    events.ateFood = false;
+    events.foodEaten = 0;
+    events.snakeEvents = nullptr;
+    events.stopRumble = false;
+    events.gameOver = false;
+    events.won = false;
+    events.restarted = false;
+    events.turnQueued = false;
+    events.turnsTaken = 0;
+
+    UpdateEffects(elapsedTicks);
+    HandleInput(input, events);
+    UpdateGameplay(elapsedTicks, events);
+
+    return events;
+}
+
+void GameSession::CaptureSnapshot(GameSessionSnapshot& snapshot) const
+{
+    snapshot.state = m_state;
+    snapshot.score = m_snakeGame.GetScore();
+
+    // The previous positions are the body shifted by one, so only its ends are copied
+    const size_t length = m_snakeGame.GetLength();
+    snapshot.segments.resize(length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        snapshot.segments[i] = m_snakeGame.GetSegment(i);
+    }
+    snapshot.previousHead = length ? m_snakeGame.GetPreviousSegment(0) : GridCell{ 0, 0 };
+    snapshot.previousTail = length ? m_snakeGame.GetPreviousSegment(length - 1) : GridCell{ 0, 0 };
+    snapshot.interpolationAlpha = m_snakeGame.GetInterpolationAlpha();
+
+    snapshot.food = m_snakeGame.GetFood();
+    snapshot.cameraOffset = m_effects.GetCameraOffset();
+    m_effects.ExportParticles(snapshot.particles);
+}
+
+void GameSession::UpdateEffects(uint64_t elapsedTicks)
+{
+    // Effects keep animating in every state (e.g. particles after game over); they
+    // are purely visual, so seconds are fine here
+    m_effects.Update(static_cast<float>(SnakeGame::TicksToSeconds(elapsedTicks)));
+}
+
+void GameSession::HandleInput(const InputState& input, GameSessionEvents& events)
+{
+    // Handle state transitions based on input
+    if (input.startPressed)
+    {
+        if (m_state == GameState::Title)
+        {
+            m_state = GameState::Playing;
+            Restart();
+            events.restarted = true;
+        }
+        else if (m_state == GameState::Paused)
+        {
+            m_state = GameState::Playing;
+        }
+        else if (m_state == GameState::Win || m_state == GameState::GameOver)
+        {
+            m_state = GameState::Playing;
+            Restart();
+            events.restarted = true;
+        }
+    }
+
+    if (input.pausePressed)
+    {
+        if (m_state == GameState::Playing)
+        {
+            m_state = GameState::Paused;
+            events.stopRumble = true;
+        }
+        else if (m_state == GameState::Paused)
+        {
+            m_state = GameState::Playing;
+        }
+    }
+
+    // Queue direction if input changed (only in Playing state)
+    if (m_state == GameState::Playing && input.dir.has_value())
+    {
+        events.turnQueued = m_snakeGame.QueueDirection(input.dir.value());
+    }
+}
+
+void GameSession::UpdateGameplay(uint64_t elapsedTicks, GameSessionEvents& events)
+{
+    if (m_state != GameState::Playing)
+        return;
+
+    // Update snake game
+    const uint64_t turnsBefore = m_snakeGame.GetTurnLatency().turns;
+    SnakeGameEvents snakeEvents = m_snakeGame.UpdateTicks(elapsedTicks);
+    events.turnsTaken = static_cast<int>(m_snakeGame.GetTurnLatency().turns - turnsBefore);
+
+    // Every food eaten during the frame gets its effect, not just the last one
+    for (const SnakeEvent& event : m_snakeGame.GetEvents())
+    {
+        if (event.type == SnakeEventType::AteFood)
+        {
+            // Effects work in pixels - convert the food cell to its center
+            const Float2 foodPos = {
+                static_cast<float>(event.cell.x) * SnakeGame::c_cellSize + SnakeGame::c_cellSize * 0.5f,
+                static_cast<float>(event.cell.y) * SnakeGame::c_cellSize + SnakeGame::c_cellSize * 0.5f };
+            m_effects.OnEatFood(foodPos);
+        }
+    }
+
+    events.snakeEvents = &m_snakeGame.GetEvents();
+    if (snakeEvents.ateFood)
+    {
+        events.ateFood = true;
+        events.foodCell = snakeEvents.foodCell;
+        events.foodEaten = snakeEvents.foodEaten;
+    }
+
+    if (snakeEvents.gameOver)
+    {
+        m_state = GameState::GameOver;
+        events.stopRumble = true;
+        events.gameOver = true;
+    }
+    else if (snakeEvents.won)
+    {
+        m_state = GameState::Win;
+        events.stopRumble = true;
+        events.won = true;
+    }
+}
+
+void GameSession::Restart()
+{
+    m_snakeGame.Reset(m_screenWidth, m_screenHeight, SplitMix64(m_seedState));
+}
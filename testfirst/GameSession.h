@@ -0,0 +1,117 @@
+//
+// GameSession.h
+// Game flow layer: title/playing/paused/win/game-over state machine driving
+// SnakeGame and Effects2D (no D3D12, no GameInput dependencies)
+//
+
+#pragma once
+
+#include <vector>
+
+#include "SnakeGame.h"
+#include "Effects2D.h"
+#include "InputRouter.h"
+#include "LatencyTrace.h"
+
+// Game state enumeration
+enum class GameState
+{
+    Title,      // Title screen - "Press A to Start"
+    Playing,    // Game is running
+    Paused,     // Game is paused - "Paused - Press Start"
+    Win,        // Board filled - "You Win - Press A to Restart"
+    GameOver    // Game over - "Game Over - Press A to Restart"
+};
+
+// Feedback for the platform layer (rumble, audio, logging) from one Update
+struct GameSessionEvents
+{
+    bool ateFood;       // Food was eaten this frame (start rumble)
+    GridCell foodCell;  // Cell where food was last eaten (if ateFood is true)
+    int foodEaten;      // Food eaten this frame
+    const SnakeEventBuffer* snakeEvents;  // Step events from this frame's gameplay update (null if it did not run)
+    bool stopRumble;    // Paused, died or won this frame
+    bool gameOver;      // The round ended in a game over this frame
+    bool won;           // The round ended with the board full this frame
+    bool restarted;     // A new round started this frame (before any turn was queued)
+    bool turnQueued;    // The snake's direction queue accepted this frame's direction
+    int turnsTaken;     // Queued directions the snake's steps took this frame
+};
+
+// Copy of everything the renderer reads from a GameSession, so a frame can be
+// drawn from a published copy while the session keeps updating on another thread
+// (see SimulationThread). Reused between captures; the vectors keep their capacity.
+struct GameSessionSnapshot
+{
+    GameState state;
+    int score;
+    std::vector<GridCell> segments;          // Head first
+    GridCell previousHead;                   // SnakeGame::GetPreviousSegment of the head...
+    GridCell previousTail;                   // ...and of the tail
+    float interpolationAlpha;
+    Food food;
+    Float2 cameraOffset;
+    std::vector<Particle> particles;
+#if SNAKE_LATENCY_TRACE
+    uint32_t lastSteppedTurn;  // TurnTrace id of the newest turn a step has taken (set by SimulationThread)
+#endif
+
+    // SnakeGame::GetPreviousSegment from the published ends: before the first step
+    // every segment is where it was, after one each is where the segment behind it
+    // is now and the tail was at previousTail
+    GridCell GetPreviousSegment(size_t index) const
+    {
+        if (previousHead == segments[0])
+            return segments[index];
+        return (index + 1 < segments.size()) ? segments[index + 1] : previousTail;
+    }
+};
+
+// Owns the gameplay modules and moves between game states from polled input
+class GameSession
+{
+public:
+    GameSession();
+    ~GameSession() = default;
+
+    // Set the board size in pixels (used on every restart) and the session seed.
+    // Each round and the effects get their own seed derived from it, so the same
+    // seed and input stream replay the same session.
+    void Initialize(int screenWidth, int screenHeight, uint64_t seed);
+
+    // Run one frame of elapsedTicks timer ticks (SnakeGame::c_ticksPerSecond per
+    // second): effects, input-driven state transitions, then gameplay
+    GameSessionEvents Update(uint64_t elapsedTicks, const InputState& input);
+
+    // The individual Update phases, in the order Update runs them
+    void UpdateEffects(uint64_t elapsedTicks);
+    void HandleInput(const InputState& input, GameSessionEvents& events);
+    void UpdateGameplay(uint64_t elapsedTicks, GameSessionEvents& events);
+
+    // Copy the renderer-visible state into snapshot (allocates only while the
+    // snapshot's vectors grow)
+    void CaptureSnapshot(GameSessionSnapshot& snapshot) const;
+
+    // Particle limits for the effects (see Effects2D::SetParticleBudget; the
+    // default count cap keeps a session deterministic)
+    void SetParticleBudget(const ParticleBudgetSettings& settings) { m_effects.SetParticleBudget(settings); }
+
+    // Getters
+    GameState GetState() const { return m_state; }
+    const SnakeGame& GetSnakeGame() const { return m_snakeGame; }
+    const Effects2D& GetEffects() const { return m_effects; }
+
+private:
+    void Restart();
+
+    GameState m_state;
+    SnakeGame m_snakeGame;
+    Effects2D m_effects;
+
+    // Board size in pixels
+    int m_screenWidth;
+    int m_screenHeight;
+
+    // SplitMix64 state that hands out per-round seeds
+    uint64_t m_seedState;
+};
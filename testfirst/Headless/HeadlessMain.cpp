@@ -0,0 +1,484 @@
+//
+// HeadlessMain.cpp
+// Console runner that drives GameSession without a window, device or GameInput
+//
+// Usage: snake_headless [--ticks N] [--dt seconds] [--seed S] [--script file]
+//                       [--width W] [--height H] [--record file] [--autopilot budget]
+//        snake_headless --replay file [--verify] [--record file]
+//
+// Without --script the runner plays with random input: it starts/restarts after
+// every death or win, turns at random and sometimes pauses. --autopilot steers with
+// SnakeAutopilot (expanding at most `budget` search nodes per tick) instead. A script is a text
+// file of "tick action" lines (action = start, pause, up, down, left, right;
+// lines starting with '#' are ignored) and is replayed in tick order.
+//
+// --record writes the run as a replay file; --replay plays one back as fast as
+// possible (seed, board size and timesteps come from the file) and --verify checks
+// the final score, length and game-over tick against the recording.
+//
+
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "GameSession.h"
+#include "Replay.h"
+#include "SnakeAutopilot.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Phase timings are sampled so the clock reads do not dominate a tick
+    constexpr uint64_t c_phaseSampleInterval = 16;
+
+    enum Phase
+    {
+        Phase_Input,
+        Phase_Effects,
+        Phase_StateMachine,
+        Phase_Gameplay,
+        Phase_Count
+    };
+
+    const char* const c_phaseNames[Phase_Count] =
+    {
+        "input",
+        "effects",
+        "state machine",
+        "gameplay",
+    };
+
+    struct Options
+    {
+        uint64_t ticks = 1000000;
+        float dt = 1.0f / 60.0f;
+        uint64_t seed = 1;
+        const char* scriptPath = nullptr;
+        const char* recordPath = nullptr;
+        const char* replayPath = nullptr;
+        bool verify = false;
+        int autopilotBudget = 0;  // 0 = random player
+        int width = 800;
+        int height = 600;
+    };
+
+    // One scripted input, applied on the given tick
+    struct ScriptEvent
+    {
+        uint64_t tick;
+        InputState input;
+    };
+
+    bool ParseAction(const std::string& action, InputState& input)
+    {
+        if (action == "start")
+            input.startPressed = true;
+        else if (action == "pause")
+            input.pausePressed = true;
+        else if (action == "up")
+            input.dir = Direction::Up;
+        else if (action == "down")
+            input.dir = Direction::Down;
+        else if (action == "left")
+            input.dir = Direction::Left;
+        else if (action == "right")
+            input.dir = Direction::Right;
+        else
+            return false;
+
+        return true;
+    }
+
+    std::vector<ScriptEvent> LoadScript(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error(std::string("Cannot open script: ") + path);
+        }
+
+        std::vector<ScriptEvent> events;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            ++lineNumber;
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream fields(line);
+            ScriptEvent event = {};
+            std::string action;
+            if (!(fields >> event.tick >> action) || !ParseAction(action, event.input))
+            {
+                throw std::runtime_error("Bad script line " + std::to_string(lineNumber) + ": " + line);
+            }
+
+            events.push_back(event);
+        }
+
+        std::stable_sort(events.begin(), events.end(),
+            [](const ScriptEvent& a, const ScriptEvent& b) { return a.tick < b.tick; });
+        return events;
+    }
+
+    // Autopilot player: restarts when the round ends and lets SnakeAutopilot steer
+    InputState AutopilotInput(const GameSession& session, SnakeAutopilot& autopilot)
+    {
+        InputState input = {};
+        if (session.GetState() == GameState::Playing)
+            input.dir = autopilot.Think(session.GetSnakeGame());
+        else
+            input.startPressed = session.GetState() != GameState::Paused;
+        input.pausePressed = session.GetState() == GameState::Paused;
+        return input;
+    }
+
+    // Random player: restarts when the round ends, turns now and then and sometimes pauses
+    InputState RandomInput(const GameSession& session, Pcg32& random)
+    {
+        InputState input = {};
+
+        switch (session.GetState())
+        {
+        case GameState::Title:
+        case GameState::GameOver:
+        case GameState::Win:
+            input.startPressed = true;
+            break;
+
+        case GameState::Paused:
+            input.pausePressed = random.NextBelow(8) == 0;
+            break;
+
+        case GameState::Playing:
+        {
+            const uint32_t roll = random.NextBelow(64);
+            if (roll < 4)
+                input.dir = static_cast<Direction>(roll);
+            else if (roll == 4 && random.NextBelow(64) == 0)
+                input.pausePressed = true;
+            break;
+        }
+        }
+
+        return input;
+    }
+
+    // Mean cost of one back-to-back pair of clock reads, subtracted from each phase
+    double ClockOverheadSeconds()
+    {
+        constexpr int c_samples = 4096;
+        double total = 0.0;
+        for (int i = 0; i < c_samples; ++i)
+        {
+            const Clock::time_point a = Clock::now();
+            const Clock::time_point b = Clock::now();
+            total += std::chrono::duration<double>(b - a).count();
+        }
+        return total / c_samples;
+    }
+
+    double PeakMemoryMiB()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters = {};
+        counters.cb = sizeof(counters);
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return static_cast<double>(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+        return 0.0;
+#else
+        rusage usage = {};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);  // bytes
+#else
+        return static_cast<double>(usage.ru_maxrss) / 1024.0;  // KiB
+#endif
+#endif
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (strcmp(arg, "--verify") == 0)
+            {
+                options.verify = true;
+                continue;
+            }
+
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (!value)
+                return false;
+
+            if (strcmp(arg, "--ticks") == 0)
+                options.ticks = strtoull(value, nullptr, 10);
+            else if (strcmp(arg, "--dt") == 0)
+                options.dt = strtof(value, nullptr);
+            else if (strcmp(arg, "--seed") == 0)
+                options.seed = strtoull(value, nullptr, 10);
+            else if (strcmp(arg, "--script") == 0)
+                options.scriptPath = value;
+            else if (strcmp(arg, "--record") == 0)
+                options.recordPath = value;
+            else if (strcmp(arg, "--replay") == 0)
+                options.replayPath = value;
+            else if (strcmp(arg, "--autopilot") == 0)
+                options.autopilotBudget = atoi(value);
+            else if (strcmp(arg, "--width") == 0)
+                options.width = atoi(value);
+            else if (strcmp(arg, "--height") == 0)
+                options.height = atoi(value);
+            else
+                return false;
+
+            ++i;
+        }
+
+        if (options.verify && !options.replayPath)
+            return false;
+
+        return options.dt > 0.0f && options.width > 0 && options.height > 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        printf("Usage: snake_headless [--ticks N] [--dt seconds] [--seed S] [--script file] [--width W] [--height H] [--record file] [--autopilot budget]\n");
+        printf("       snake_headless --replay file [--verify] [--record file]\n");
+        return 1;
+    }
+
+    std::vector<ScriptEvent> script;
+    ReplayReader replay;
+    ReplayRecorder recorder;
+    try
+    {
+        if (options.scriptPath)
+            script = LoadScript(options.scriptPath);
+
+        if (options.replayPath)
+        {
+            replay.Open(options.replayPath);
+            options.seed = replay.GetHeader().seed;
+            options.width = replay.GetHeader().screenWidth;
+            options.height = replay.GetHeader().screenHeight;
+        }
+
+        if (options.recordPath)
+            recorder.Start(options.recordPath, ReplayHeader{ options.seed, options.width, options.height });
+    }
+    catch (const std::exception& e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+
+    GameSession session;
+    session.Initialize(options.width, options.height, options.seed);
+
+    // The random player has its own generator so it does not disturb the session's
+    Pcg32 playerRandom(options.seed ^ 0x5A5A5A5Aull);
+    SnakeAutopilot autopilot(options.autopilotBudget);
+
+    double phaseSeconds[Phase_Count] = {};
+    uint64_t sampledTicks = 0;
+    uint64_t rounds = 0;
+    uint64_t foodEaten = 0;
+    uint64_t deaths = 0;
+    uint64_t wins = 0;
+    int bestScore = 0;
+    size_t peakParticles = 0;
+    TurnLatencyStats turnLatency = {};
+    TurnLatencyStats roundLatency = {};  // The current round's stats at the end of the last tick
+    size_t scriptIndex = 0;
+    int64_t lastGameOverTick = -1;
+    uint64_t tick = 0;
+
+    // The session is clocked in timer ticks; --dt is converted once
+    const uint64_t dtTicks = SnakeGame::SecondsToTicks(options.dt);
+
+    const Clock::time_point runStart = Clock::now();
+
+    for (;; ++tick)
+    {
+        const bool sample = (tick % c_phaseSampleInterval) == 0;
+        Clock::time_point t0;
+        if (sample)
+            t0 = Clock::now();
+
+        // Input: next replayed tick, every scripted event for this tick, or a random roll
+        InputState input = {};
+        uint64_t dt = dtTicks;
+        if (options.replayPath)
+        {
+            if (!replay.Next(input, dt))
+                break;
+        }
+        else if (tick >= options.ticks)
+        {
+            break;
+        }
+        else if (options.scriptPath)
+        {
+            while (scriptIndex < script.size() && script[scriptIndex].tick <= tick)
+            {
+                const InputState& scripted = script[scriptIndex].input;
+                input.startPressed |= scripted.startPressed;
+                input.pausePressed |= scripted.pausePressed;
+                if (scripted.dir.has_value())
+                    input.dir = scripted.dir;
+                ++scriptIndex;
+            }
+        }
+        else if (options.autopilotBudget > 0)
+        {
+            input = AutopilotInput(session, autopilot);
+        }
+        else
+        {
+            input = RandomInput(session, playerRandom);
+        }
+
+        recorder.Record(input, dt);
+
+        if (input.startPressed && session.GetState() != GameState::Playing && session.GetState() != GameState::Paused)
+            ++rounds;
+
+        // Same phase order as GameSession::Update
+        GameSessionEvents events = {};
+        Clock::time_point t1;
+        Clock::time_point t2;
+        Clock::time_point t3;
+        if (sample)
+            t1 = Clock::now();
+
+        session.UpdateEffects(dt);
+        if (sample)
+            t2 = Clock::now();
+
+        session.HandleInput(input, events);
+        if (sample)
+            t3 = Clock::now();
+
+        session.UpdateGameplay(dt, events);
+
+        if (sample)
+        {
+            const Clock::time_point t4 = Clock::now();
+            phaseSeconds[Phase_Input] += std::chrono::duration<double>(t1 - t0).count();
+            phaseSeconds[Phase_Effects] += std::chrono::duration<double>(t2 - t1).count();
+            phaseSeconds[Phase_StateMachine] += std::chrono::duration<double>(t3 - t2).count();
+            phaseSeconds[Phase_Gameplay] += std::chrono::duration<double>(t4 - t3).count();
+            ++sampledTicks;
+        }
+
+        // Round statistics
+        foodEaten += static_cast<uint64_t>(events.foodEaten);
+
+        if (events.gameOver)
+        {
+            ++deaths;
+            lastGameOverTick = static_cast<int64_t>(tick);
+        }
+        else if (events.won)
+        {
+            ++wins;
+        }
+
+        const SnakeGame& snakeGame = session.GetSnakeGame();
+        bestScore = std::max(bestScore, snakeGame.GetScore());
+        peakParticles = std::max(peakParticles, session.GetEffects().GetParticleCount());
+
+        // Turn latency is kept per round; a restart shows up as the count going back
+        const TurnLatencyStats& latency = snakeGame.GetTurnLatency();
+        if (latency.turns < roundLatency.turns)
+            roundLatency = TurnLatencyStats{};
+        turnLatency.turns += latency.turns - roundLatency.turns;
+        turnLatency.totalTicks += latency.totalTicks - roundLatency.totalTicks;
+        turnLatency.maxTicks = std::max(turnLatency.maxTicks, latency.maxTicks);
+        roundLatency = latency;
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+    const double clockOverhead = ClockOverheadSeconds();
+
+    const SnakeGame& finalGame = session.GetSnakeGame();
+    const ReplayResult result = { tick, finalGame.GetScore(), static_cast<uint32_t>(finalGame.GetLength()), lastGameOverTick };
+    recorder.Finish(result);
+
+    printf("ticks:          %llu\n", static_cast<unsigned long long>(tick));
+    printf("input:          %s\n", options.replayPath ? options.replayPath :
+        (options.scriptPath ? options.scriptPath : (options.autopilotBudget > 0 ? "autopilot" : "random")));
+    printf("wall time:      %.3f s\n", seconds);
+    printf("ticks/s:        %.0f\n", seconds > 0.0 ? static_cast<double>(tick) / seconds : 0.0);
+    printf("peak memory:    %.1f MiB\n", PeakMemoryMiB());
+    printf("rounds:         %llu (%llu game over, %llu won)\n",
+        static_cast<unsigned long long>(rounds), static_cast<unsigned long long>(deaths), static_cast<unsigned long long>(wins));
+    printf("food eaten:     %llu (best score %d)\n", static_cast<unsigned long long>(foodEaten), bestScore);
+    printf("peak particles: %zu\n", peakParticles);
+    char budgetLine[160];
+    session.GetEffects().GetParticleBudget().Format(budgetLine, sizeof(budgetLine));
+    printf("%s\n", budgetLine);
+    printf("turn latency:   %llu turns, mean %.0f ticks (%.1f ms), max %llu ticks (%.1f ms)\n",
+        static_cast<unsigned long long>(turnLatency.turns),
+        turnLatency.turns ? static_cast<double>(turnLatency.totalTicks) / static_cast<double>(turnLatency.turns) : 0.0,
+        turnLatency.turns ? SnakeGame::TicksToSeconds(turnLatency.totalTicks) * 1000.0 / static_cast<double>(turnLatency.turns) : 0.0,
+        static_cast<unsigned long long>(turnLatency.maxTicks), SnakeGame::TicksToSeconds(turnLatency.maxTicks) * 1000.0);
+
+    printf("phase timings (mean per tick, 1 in %llu ticks sampled, %.1f ns clock cost removed):\n",
+        static_cast<unsigned long long>(c_phaseSampleInterval), clockOverhead * 1e9);
+    for (int phase = 0; phase < Phase_Count; ++phase)
+    {
+        const double meanSeconds = sampledTicks ? phaseSeconds[phase] / static_cast<double>(sampledTicks) : 0.0;
+        const double nsPerTick = std::max(0.0, meanSeconds - clockOverhead) * 1e9;
+        printf("  %-14s %8.1f ns\n", c_phaseNames[phase], nsPerTick);
+    }
+
+    if (options.recordPath)
+        printf("recorded:       %s\n", options.recordPath);
+
+    if (options.verify)
+    {
+        if (!replay.HasResult())
+        {
+            printf("verify: replay has no recorded result (recording was not finished)\n");
+            return 1;
+        }
+
+        const ReplayResult& expected = replay.GetResult();
+        const bool match = expected.ticks == result.ticks && expected.score == result.score &&
+            expected.length == result.length && expected.lastGameOverTick == result.lastGameOverTick;
+        printf("verify: %s (ticks %llu/%llu, score %d/%d, length %u/%u, game-over tick %lld/%lld)\n",
+            match ? "OK" : "MISMATCH",
+            static_cast<unsigned long long>(result.ticks), static_cast<unsigned long long>(expected.ticks),
+            result.score, expected.score, result.length, expected.length,
+            static_cast<long long>(result.lastGameOverTick), static_cast<long long>(expected.lastGameOverTick));
+        if (!match)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+//
+// InputBackend.cpp
+// Input device layer implementation
+//
+
+#include "pch.h"
+#include "InputBackend.h"
+
+#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+#include <gameinput.h>
+#endif
+
+void MockInputBackend::Push(const InputReading& reading)
+{
+    m_readings.push_back(reading);
+    SetCurrentTimestamp(reading.timestamp);
+}
+
+void MockInputBackend::SetCurrentTimestamp(uint64_t timestamp)
+{
+    if (timestamp > m_currentTimestamp)
+        m_currentTimestamp = timestamp;
+}
+
+void MockInputBackend::Clear()
+{
+    m_readings.clear();
+    m_next = 0;
+}
+
+bool MockInputBackend::NextReading(InputReading& reading)
+{
+    if (m_next == m_readings.size())
+        return false;
+
+    reading = m_readings[m_next++];
+    return true;
+}
+
+#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+namespace
+{
+    GameInput::v3::GameInputKind ToGameInputKind(InputDeviceKind kind)
+    {
+        return (kind == InputDeviceKind::Gamepad) ? GameInput::v3::GameInputKindGamepad : GameInput::v3::GameInputKindKeyboard;
+    }
+}
+
+GameInputBackend::GameInputBackend(GameInput::v3::IGameInput* gameInput)
+    : m_gameInput(gameInput)
+{
+}
+
+GameInputBackend::~GameInputBackend()
+{
+}
+
+bool GameInputBackend::NextReading(InputReading& reading)
+{
+    if (!m_gameInput)
+        return false;
+
+    // Oldest pending reading across both devices
+    int next = -1;
+    uint64_t nextTimestamp = 0;
+    for (int kind = 0; kind < 2; ++kind)
+    {
+        Stream& stream = m_streams[kind];
+        if (!stream.pending)
+        {
+            Fetch(stream, static_cast<InputDeviceKind>(kind));
+        }
+        if (stream.pending && (next < 0 || stream.pending->GetTimestamp() < nextTimestamp))
+        {
+            next = kind;
+            nextTimestamp = stream.pending->GetTimestamp();
+        }
+    }
+
+    if (next < 0)
+        return false;
+
+    Stream& stream = m_streams[next];
+    Convert(stream.pending.Get(), static_cast<InputDeviceKind>(next), reading);
+    stream.last = std::move(stream.pending);
+    return true;
+}
+
+uint64_t GameInputBackend::GetCurrentTimestamp() const
+{
+    return m_gameInput ? m_gameInput->GetCurrentTimestamp() : 0;
+}
+
+void GameInputBackend::Fetch(Stream& stream, InputDeviceKind kind)
+{
+    const GameInput::v3::GameInputKind inputKind = ToGameInputKind(kind);
+
+    Microsoft::WRL::ComPtr<GameInput::v3::IGameInputReading> reading;
+    if (stream.last)
+    {
+        const HRESULT hr = m_gameInput->GetNextReading(stream.last.Get(), inputKind, nullptr, reading.GetAddressOf());
+        if (SUCCEEDED(hr))
+        {
+            stream.pending = std::move(reading);
+            return;
+        }
+        if (hr != GAMEINPUT_E_READING_NOT_FOUND)
+            return;  // Nothing newer yet
+
+        // The history no longer reaches back to the last reading: resume from the
+        // current one (readings in between are lost)
+    }
+
+    if (SUCCEEDED(m_gameInput->GetCurrentReading(inputKind, nullptr, reading.GetAddressOf())) && reading)
+    {
+        if (!stream.last || reading->GetTimestamp() > stream.last->GetTimestamp())
+        {
+            stream.pending = std::move(reading);
+        }
+    }
+}
+
+void GameInputBackend::Convert(GameInput::v3::IGameInputReading* source, InputDeviceKind kind, InputReading& reading)
+{
+    reading = {};
+    reading.timestamp = source->GetTimestamp();
+    reading.kind = kind;
+
+    if (kind == InputDeviceKind::Gamepad)
+    {
+        // Remember the pad for rumble
+        Microsoft::WRL::ComPtr<GameInput::v3::IGameInputDevice> device;
+        source->GetDevice(device.GetAddressOf());
+        if (device)
+        {
+            m_gamepadDevice = device;
+        }
+
+        GameInput::v3::GameInputGamepadState gamepadState = {};
+        if (SUCCEEDED(source->GetGamepadState(&gamepadState)))
+        {
+            reading.buttons |= (gamepadState.buttons & GameInput::v3::GameInputGamepadA) ? GamepadButton::A : 0u;
+            reading.buttons |= (gamepadState.buttons & GameInput::v3::GameInputGamepadMenu) ? GamepadButton::Menu : 0u;
+            reading.leftThumbstickX = gamepadState.leftThumbstickX;
+            reading.leftThumbstickY = gamepadState.leftThumbstickY;
+        }
+    }
+    else
+    {
+        // A virtual key is one byte, so at most 256 keys can be down at once
+        constexpr uint32_t maxKeys = 256;
+        GameInput::v3::GameInputKeyState keyState[maxKeys];
+        const uint32_t keyCount = source->GetKeyState(maxKeys, keyState);
+        for (uint32_t i = 0; i < keyCount; ++i)
+        {
+            reading.keys.Set(keyState[i].virtualKey);
+        }
+    }
+}
+#endif
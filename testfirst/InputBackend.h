@@ -0,0 +1,130 @@
+//
+// InputBackend.h
+// Input device layer: reading history from GameInput (or a recorded sequence)
+// as platform-free readings for InputRouter
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "KeyboardMapper.h"  // For KeyBits
+
+#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+namespace GameInput
+{
+    namespace v3
+    {
+        struct IGameInput;
+        struct IGameInputDevice;
+        struct IGameInputReading;
+    }
+}
+#endif
+
+enum class InputDeviceKind : uint8_t
+{
+    Gamepad,
+    Keyboard
+};
+
+// Gamepad buttons InputRouter reads (InputReading::buttons)
+namespace GamepadButton
+{
+    constexpr uint32_t A = 1u << 0;
+    constexpr uint32_t Menu = 1u << 1;
+}
+
+// One device reading: the full state of a gamepad or keyboard at `timestamp`
+struct InputReading
+{
+    uint64_t timestamp;    // Backend clock, microseconds
+    InputDeviceKind kind;
+
+    // Gamepad
+    uint32_t buttons;      // GamepadButton bits held down
+    float leftThumbstickX;
+    float leftThumbstickY; // Up is positive
+
+    // Keyboard
+    KeyBits keys;          // Virtual keys held down
+};
+
+// Source of device readings. NextReading hands out every reading taken since the
+// last one it returned, oldest first, so presses shorter than a frame are not lost.
+class IInputBackend
+{
+public:
+    virtual ~IInputBackend() = default;
+
+    // Next unprocessed reading; false once the backend has caught up
+    virtual bool NextReading(InputReading& reading) = 0;
+
+    // Now on the clock InputReading::timestamp uses (to tell how old a reading is)
+    virtual uint64_t GetCurrentTimestamp() const = 0;
+};
+
+// Plays back readings queued by the caller (recorded sequences, tests, benches)
+class MockInputBackend final : public IInputBackend
+{
+public:
+    MockInputBackend() : m_next(0), m_currentTimestamp(0) {}
+
+    // Queue a reading (timestamps must not go backwards); the clock advances to it
+    void Push(const InputReading& reading);
+
+    // Move the clock forward (it never goes back)
+    void SetCurrentTimestamp(uint64_t timestamp);
+
+    // Drop everything queued
+    void Clear();
+
+    bool NextReading(InputReading& reading) override;
+    uint64_t GetCurrentTimestamp() const override { return m_currentTimestamp; }
+
+    size_t GetPendingCount() const { return m_readings.size() - m_next; }
+
+private:
+    std::vector<InputReading> m_readings;
+    size_t m_next;  // First reading not yet handed out
+    uint64_t m_currentTimestamp;
+};
+
+#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+// Walks GameInput's reading history for the gamepad and keyboard, merged in
+// timestamp order.
+//
+// Each device kind remembers the last reading it handed out and asks for the one
+// after it (GetNextReading). The first poll, and any poll after GameInput's history
+// no longer holds that reading (a long hitch), starts again from the current reading.
+class GameInputBackend final : public IInputBackend
+{
+public:
+    explicit GameInputBackend(GameInput::v3::IGameInput* gameInput);  // Not owned
+    ~GameInputBackend() override;
+
+    GameInputBackend(const GameInputBackend&) = delete;
+    GameInputBackend& operator=(const GameInputBackend&) = delete;
+
+    bool NextReading(InputReading& reading) override;
+    uint64_t GetCurrentTimestamp() const override;
+
+    // Gamepad the last gamepad reading came from (for rumble; no reference added)
+    GameInput::v3::IGameInputDevice* GetGamepadDevice() const { return m_gamepadDevice.Get(); }
+
+private:
+    struct Stream
+    {
+        Microsoft::WRL::ComPtr<GameInput::v3::IGameInputReading> last;     // Last reading handed out
+        Microsoft::WRL::ComPtr<GameInput::v3::IGameInputReading> pending;  // Fetched, not handed out yet
+    };
+
+    void Fetch(Stream& stream, InputDeviceKind kind);
+    void Convert(GameInput::v3::IGameInputReading* source, InputDeviceKind kind, InputReading& reading);
+
+    GameInput::v3::IGameInput* m_gameInput;
+    Microsoft::WRL::ComPtr<GameInput::v3::IGameInputDevice> m_gamepadDevice;
+    Stream m_streams[2];  // Indexed by InputDeviceKind
+};
+#endif
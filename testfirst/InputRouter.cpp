@@ -6,15 +6,10 @@
 #include "pch.h"
 #include "InputRouter.h"
 
-#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
-#include <gameinput.h>
-#endif
-
 #include <cmath>
 
 InputRouter::InputRouter()
     : m_lastButtonState(0)
-    , m_lastKeyState(0)
     , m_lastDirection(Direction::Right)
 {
 }
@@ -23,150 +18,77 @@ InputRouter::~InputRouter()
 {
 }
 
-InputState InputRouter::Poll(
-    void* gameInput,
-#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
-    GameInput::v3::IGameInputDevice** outActiveGamepadDevice
-#else
-    void** outActiveGamepadDevice
-#endif
-)
+InputState InputRouter::Poll(IInputBackend& backend, std::vector<InputEvent>* events)
 {
-    InputState state = {};
-    state.startPressed = false;
-    state.pausePressed = false;
-    state.dir = std::nullopt;
-
-#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
-    if (outActiveGamepadDevice)
-        *outActiveGamepadDevice = nullptr;
-
-    if (!gameInput)
-        return state;
+    InputState merged = {};
 
-    GameInput::v3::IGameInput* gameInputPtr = static_cast<GameInput::v3::IGameInput*>(gameInput);
-
-    // Try gamepad first
-    GameInput::v3::IGameInputReading* reading = nullptr;
-    if (SUCCEEDED(gameInputPtr->GetCurrentReading(GameInput::v3::GameInputKindGamepad, nullptr, &reading)) && reading)
+    InputReading reading;
+    while (backend.NextReading(reading))
     {
-        // Get and cache the gamepad device for rumble
-        GameInput::v3::IGameInputDevice* device = nullptr;
-        reading->GetDevice(&device);
-        if (device && outActiveGamepadDevice)
-        {
-            *outActiveGamepadDevice = device;
-            // Note: Caller should AddRef if they want to keep it
-        }
+        const InputState input = ProcessReading(reading);
+        if (!HasInput(input))
+            continue;
 
-        GameInput::v3::GameInputGamepadState gamepadState = {};
-        if (SUCCEEDED(reading->GetGamepadState(&gamepadState)))
+        if (events)
         {
-            // Detect button presses
-            uint64_t buttonChanges = gamepadState.buttons & ~m_lastButtonState;
-
-            // A button = start
-            if (buttonChanges & GameInput::v3::GameInputGamepadA)
-            {
-                state.startPressed = true;
-            }
-
-            // Menu button = pause
-            if (buttonChanges & GameInput::v3::GameInputGamepadMenu)
-            {
-                state.pausePressed = true;
-            }
+            events->push_back(InputEvent{ reading.timestamp, input });
+        }
+        MergeInput(merged, input);
+    }
 
-            m_lastButtonState = gamepadState.buttons;
+    return merged;
+}
 
-            // Handle left thumbstick for direction input
-            const float threshold = 0.5f;
-            float leftX = gamepadState.leftThumbstickX;
-            float leftY = -gamepadState.leftThumbstickY; // Invert Y for screen coordinates
+InputState InputRouter::ProcessReading(const InputReading& reading)
+{
+    InputState state = {};
+    state.startPressed = false;
+    state.pausePressed = false;
+    state.dir = std::nullopt;
 
-            Direction newDir = m_lastDirection;
+    if (reading.kind == InputDeviceKind::Gamepad)
+    {
+        // Detect button presses
+        const uint32_t buttonChanges = reading.buttons & ~m_lastButtonState;
 
-            if (fabsf(leftX) > threshold || fabsf(leftY) > threshold)
-            {
-                if (fabsf(leftX) > fabsf(leftY))
-                {
-                    // Horizontal movement
-                    if (leftX > threshold)
-                        newDir = Direction::Right;
-                    else if (leftX < -threshold)
-                        newDir = Direction::Left;
-                }
-                else
-                {
-                    // Vertical movement
-                    if (leftY > threshold)
-                        newDir = Direction::Down;
-                    else if (leftY < -threshold)
-                        newDir = Direction::Up;
-                }
-
-                // Only report direction if it changed
-                if (newDir != m_lastDirection)
-                {
-                    state.dir = newDir;
-                    m_lastDirection = newDir;
-                }
-            }
+        // A button = start
+        if (buttonChanges & GamepadButton::A)
+        {
+            state.startPressed = true;
         }
 
-        reading->Release();
-    }
-
-    // Also check keyboard input as fallback
-    reading = nullptr;
-    if (SUCCEEDED(gameInputPtr->GetCurrentReading(GameInput::v3::GameInputKindKeyboard, nullptr, &reading)) && reading)
-    {
-        uint32_t keyCount = reading->GetKeyCount();
-        if (keyCount > 0)
+        // Menu button = pause
+        if (buttonChanges & GamepadButton::Menu)
         {
-            constexpr uint32_t maxKeys = 16;
-            GameInput::v3::GameInputKeyState keyState[maxKeys];
-            uint32_t actualCount = reading->GetKeyState(maxKeys, keyState);
-
-            // GetKeyState returns currently pressed keys
-            uint64_t currentKeyState = 0;
-            for (uint32_t i = 0; i < actualCount; ++i)
-            {
-                currentKeyState |= (1ULL << (keyState[i].virtualKey % 64));
-            }
+            state.pausePressed = true;
+        }
 
-            uint64_t keyChanges = currentKeyState & ~m_lastKeyState;
+        m_lastButtonState = reading.buttons;
 
-            // Space or Enter = start
-            if (keyChanges & ((1ULL << (VK_SPACE % 64)) | (1ULL << (VK_RETURN % 64))))
-            {
-                state.startPressed = true;
-            }
+        // Handle left thumbstick for direction input
+        const float threshold = 0.5f;
+        float leftX = reading.leftThumbstickX;
+        float leftY = -reading.leftThumbstickY; // Invert Y for screen coordinates
 
-            // Escape = pause
-            if (keyChanges & (1ULL << (VK_ESCAPE % 64)))
-            {
-                state.pausePressed = true;
-            }
-
-            // Arrow keys or WASD for direction input
-            Direction newDir = m_lastDirection;
+        Direction newDir = m_lastDirection;
 
-            if (keyChanges & (1ULL << (VK_UP % 64)) || keyChanges & (1ULL << ('W' % 64)))
-            {
-                newDir = Direction::Up;
-            }
-            else if (keyChanges & (1ULL << (VK_DOWN % 64)) || keyChanges & (1ULL << ('S' % 64)))
-            {
-                newDir = Direction::Down;
-            }
-            else if (keyChanges & (1ULL << (VK_LEFT % 64)) || keyChanges & (1ULL << ('A' % 64)))
+        if (fabsf(leftX) > threshold || fabsf(leftY) > threshold)
+        {
+            if (fabsf(leftX) > fabsf(leftY))
             {
-                newDir = Direction::Left;
+                // Horizontal movement
+                if (leftX > threshold)
+                    newDir = Direction::Right;
+                else if (leftX < -threshold)
+                    newDir = Direction::Left;
             }
-            else if (keyChanges & (1ULL << (VK_RIGHT % 64)) || keyChanges & (1ULL << ('D' % 64)))
+            else
             {
-                newDir = Direction::Right;
+                // Vertical movement
+                if (leftY > threshold)
+                    newDir = Direction::Down;
+                else if (leftY < -threshold)
+                    newDir = Direction::Up;
             }
 
             // Only report direction if it changed
@@ -175,13 +97,31 @@ InputState InputRouter::Poll(
                 state.dir = newDir;
                 m_lastDirection = newDir;
             }
+        }
+    }
+    else
+    {
+        // Press edges over all 256 keys, resolved through the bindings
+        const uint32_t actions = m_keyboard.Update(reading.keys);
 
-            m_lastKeyState = currentKeyState;
+        if (actions & KeyboardMapper::ActionBit(KeyAction::Start))
+        {
+            state.startPressed = true;
+        }
+
+        if (actions & KeyboardMapper::ActionBit(KeyAction::Pause))
+        {
+            state.pausePressed = true;
         }
 
-        reading->Release();
+        // Only report direction if it changed
+        const std::optional<Direction> newDir = KeyboardMapper::PressedDirection(actions);
+        if (newDir && *newDir != m_lastDirection)
+        {
+            state.dir = newDir;
+            m_lastDirection = *newDir;
+        }
     }
-#endif
 
     return state;
 }
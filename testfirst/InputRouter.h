@@ -1,24 +1,15 @@
 //
 // InputRouter.h
-// Input layer: GameInput + Keyboard -> simplified input events
+// Input layer: device readings (GameInput or recorded) -> simplified input events
 //
 
 #pragma once
 
 #include <optional>
+#include <vector>
 #include "SnakeGame.h"  // For Direction enum
-
-// Forward declarations
-#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
-namespace GameInput
-{
-    namespace v3
-    {
-        struct IGameInput;
-        struct IGameInputDevice;
-    }
-}
-#endif
+#include "KeyboardMapper.h"
+#include "InputBackend.h"
 
 // Simplified input state
 struct InputState
@@ -28,26 +19,51 @@ struct InputState
     std::optional<Direction> dir;  // Direction from left thumbstick or keys (only on change)
 };
 
-// Input router that processes GameInput and keyboard, outputs simplified events
+// True if the state carries any input
+inline bool HasInput(const InputState& input)
+{
+    return input.startPressed || input.pausePressed || input.dir.has_value();
+}
+
+// Fold input into merged: presses are kept, the later direction wins
+inline void MergeInput(InputState& merged, const InputState& input)
+{
+    merged.startPressed = merged.startPressed || input.startPressed;
+    merged.pausePressed = merged.pausePressed || input.pausePressed;
+    if (input.dir)
+    {
+        merged.dir = input.dir;
+    }
+}
+
+// Input from one device reading
+struct InputEvent
+{
+    uint64_t timestamp;  // Reading timestamp (backend clock)
+    InputState input;
+};
+
+// Input router that turns device readings into simplified events
 class InputRouter
 {
 public:
     InputRouter();
     ~InputRouter();
 
-    // Poll input and return simplified state
-    // Also returns the active gamepad device for rumble (if available)
-    InputState Poll(
-        void* gameInput,  // IGameInput* when GameInput is available
-#if defined(USING_GAMEINPUT) || defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
-        GameInput::v3::IGameInputDevice** outActiveGamepadDevice = nullptr
-#else
-        void** outActiveGamepadDevice = nullptr
-#endif
-    );
+    // Process every reading the backend has taken since the last poll, oldest
+    // first. Readings that produce input are appended to events (if given) with
+    // their timestamps, so a press and release between two polls still registers;
+    // the return value is all of them merged (see MergeInput).
+    InputState Poll(IInputBackend& backend, std::vector<InputEvent>* events = nullptr);
+
+    // Input from a single reading (edges against the previous reading of the same device)
+    InputState ProcessReading(const InputReading& reading);
+
+    // Keyboard bindings (rebind through this)
+    KeyboardMapper& GetKeyboardMapper() { return m_keyboard; }
 
 private:
-    uint64_t m_lastButtonState;  // Track button state to detect presses
-    uint64_t m_lastKeyState;  // Track keyboard state to detect presses
+    uint32_t m_lastButtonState;  // Track button state to detect presses
+    KeyboardMapper m_keyboard;  // Keyboard state and bindings
     Direction m_lastDirection;  // Track last direction to detect changes
 };
@@ -0,0 +1,74 @@
+//
+// KeyboardMapper.cpp
+// Keyboard bindings implementation
+//
+
+#include "pch.h"
+#include "KeyboardMapper.h"
+
+KeyboardMapper::KeyboardMapper()
+    : m_previous{}
+{
+    ClearBindings();
+    Bind(VirtualKey::Up, KeyAction::Up);
+    Bind('W', KeyAction::Up);
+    Bind(VirtualKey::Down, KeyAction::Down);
+    Bind('S', KeyAction::Down);
+    Bind(VirtualKey::Left, KeyAction::Left);
+    Bind('A', KeyAction::Left);
+    Bind(VirtualKey::Right, KeyAction::Right);
+    Bind('D', KeyAction::Right);
+    Bind(VirtualKey::Space, KeyAction::Start);
+    Bind(VirtualKey::Return, KeyAction::Start);
+    Bind(VirtualKey::Escape, KeyAction::Pause);
+}
+
+void KeyboardMapper::Bind(uint8_t virtualKey, KeyAction action)
+{
+    m_bindings[virtualKey] = (action < KeyAction::Count) ? action : KeyAction::None;
+    RebuildMasks();
+}
+
+void KeyboardMapper::ClearBindings()
+{
+    m_bindings.fill(KeyAction::None);
+    RebuildMasks();
+}
+
+uint32_t KeyboardMapper::Update(const KeyBits& down)
+{
+    const KeyBits pressed = down.AndNot(m_previous);
+    m_previous = down;
+
+    uint32_t actions = 0;
+    for (size_t action = 1; action < m_actionKeys.size(); ++action)
+    {
+        actions |= static_cast<uint32_t>(pressed.Intersects(m_actionKeys[action])) << action;
+    }
+    return actions;
+}
+
+std::optional<Direction> KeyboardMapper::PressedDirection(uint32_t actions)
+{
+    if (actions & ActionBit(KeyAction::Up))
+        return Direction::Up;
+    if (actions & ActionBit(KeyAction::Down))
+        return Direction::Down;
+    if (actions & ActionBit(KeyAction::Left))
+        return Direction::Left;
+    if (actions & ActionBit(KeyAction::Right))
+        return Direction::Right;
+    return std::nullopt;
+}
+
+void KeyboardMapper::RebuildMasks()
+{
+    for (KeyBits& keys : m_actionKeys)
+    {
+        keys = KeyBits{};
+    }
+    for (size_t key = 0; key < m_bindings.size(); ++key)
+    {
+        m_actionKeys[static_cast<size_t>(m_bindings[key])].Set(static_cast<uint8_t>(key));
+    }
+}
@@ -0,0 +1,98 @@
+//
+// KeyboardMapper.h
+// Keyboard bindings: 256-bit key state -> game actions (no GameInput dependency)
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "SnakeGame.h"  // For Direction enum
+
+// Windows virtual-key codes for the default bindings (same values as the VK_*
+// macros, so this header does not need Windows.h)
+namespace VirtualKey
+{
+    constexpr uint8_t Return = 0x0D;
+    constexpr uint8_t Escape = 0x1B;
+    constexpr uint8_t Space = 0x20;
+    constexpr uint8_t Left = 0x25;
+    constexpr uint8_t Up = 0x26;
+    constexpr uint8_t Right = 0x27;
+    constexpr uint8_t Down = 0x28;
+}
+
+// Set of keys, one bit per virtual-key code (bit k of words[k / 64])
+struct KeyBits
+{
+    std::array<uint64_t, 4> words;
+
+    void Set(uint8_t key) { words[key >> 6] |= 1ULL << (key & 63); }
+    bool Test(uint8_t key) const { return (words[key >> 6] >> (key & 63)) & 1ULL; }
+
+    // Keys in this set and not in other (e.g. down now and up last poll)
+    KeyBits AndNot(const KeyBits& other) const
+    {
+        return KeyBits{ { words[0] & ~other.words[0], words[1] & ~other.words[1], words[2] & ~other.words[2], words[3] & ~other.words[3] } };
+    }
+
+    bool Intersects(const KeyBits& other) const
+    {
+        return ((words[0] & other.words[0]) | (words[1] & other.words[1]) | (words[2] & other.words[2]) | (words[3] & other.words[3])) != 0;
+    }
+};
+
+// What a bound key does
+enum class KeyAction : uint8_t
+{
+    None,
+    Up,
+    Down,
+    Left,
+    Right,
+    Start,
+    Pause,
+    Count
+};
+
+// Turns the keys held down at each poll into the actions pressed since the last
+// poll.
+//
+// Bindings live in a 256-entry table (virtual key -> action). Binding rebuilds one
+// key mask per action from it, so a poll is a fixed number of word operations
+// whatever is held down: press edges are `down & ~previous` over all 256 keys, and
+// each action is one intersect of those edges with its mask. There is no
+// per-key loop and no aliasing between keys.
+class KeyboardMapper
+{
+public:
+    // Default bindings: arrows and WASD steer, Space/Enter start, Escape pauses
+    KeyboardMapper();
+
+    void Bind(uint8_t virtualKey, KeyAction action);
+    void ClearBindings();
+    KeyAction GetBinding(uint8_t virtualKey) const { return m_bindings[virtualKey]; }
+
+    // Take the keys down now; returns the actions pressed since the last call
+    // (bit 1 << KeyAction per action)
+    uint32_t Update(const KeyBits& down);
+
+    // Forget the held keys (e.g. on focus loss), so keys still down count as
+    // pressed again next poll
+    void ResetKeys() { m_previous = KeyBits{}; }
+
+    static constexpr uint32_t ActionBit(KeyAction action) { return 1u << static_cast<uint32_t>(action); }
+
+    // Direction pressed in an Update result (Up, Down, Left, Right priority when
+    // several are pressed in one poll)
+    static std::optional<Direction> PressedDirection(uint32_t actions);
+
+private:
+    void RebuildMasks();
+
+    std::array<KeyAction, 256> m_bindings;
+    std::array<KeyBits, static_cast<size_t>(KeyAction::Count)> m_actionKeys;  // Keys bound to each action
+    KeyBits m_previous;  // Keys down at the last Update
+};
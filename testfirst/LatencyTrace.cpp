@@ -0,0 +1,193 @@
+//
+// LatencyTrace.cpp
+// Input latency histograms and turn tracking
+//
+
+#include "pch.h"
+#include "LatencyTrace.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::Add(uint64_t nanoseconds)
+{
+    m_buckets[BucketOf(nanoseconds / 1000)]++;
+    m_count++;
+    m_totalNs += nanoseconds;
+    m_maxNs = std::max(m_maxNs, nanoseconds);
+}
+
+void LatencyHistogram::Reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_totalNs = 0;
+    m_maxNs = 0;
+}
+
+double LatencyHistogram::GetMeanMs() const
+{
+    return (m_count > 0) ? static_cast<double>(m_totalNs) * 1e-6 / static_cast<double>(m_count) : 0.0;
+}
+
+double LatencyHistogram::GetPercentileMs(double p) const
+{
+    if (m_count == 0)
+        return 0.0;
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(m_count))));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < c_bucketCount; ++bucket)
+    {
+        seen += m_buckets[bucket];
+        if (seen >= rank)
+            return std::min(static_cast<double>(BucketEndUs(bucket)) * 1e-3, GetMaxMs());
+    }
+    return GetMaxMs();
+}
+
+void LatencyHistogram::Format(char* buffer, size_t size) const
+{
+    snprintf(buffer, size, "n=%llu mean %.2f p50 %.2f p99 %.2f max %.2f ms",
+        static_cast<unsigned long long>(m_count), GetMeanMs(), GetPercentileMs(0.5), GetPercentileMs(0.99), GetMaxMs());
+}
+
+size_t LatencyHistogram::BucketOf(uint64_t microseconds)
+{
+    if (microseconds < 4)
+        return static_cast<size_t>(microseconds);
+
+    // Top bit picks the power of two, the two bits below it the quarter
+    int msb = 2;
+    while ((microseconds >> (msb + 1)) != 0)
+    {
+        ++msb;
+    }
+    const size_t bucket = static_cast<size_t>(msb - 1) * 4 + static_cast<size_t>((microseconds >> (msb - 2)) & 3);
+    return std::min(bucket, c_bucketCount - 1);
+}
+
+uint64_t LatencyHistogram::BucketEndUs(size_t bucket)
+{
+    if (bucket < 4)
+        return bucket + 1;
+
+    const int msb = static_cast<int>(bucket / 4) + 1;
+    return (5 + (bucket % 4)) << (msb - 2);
+}
+
+LatencyTracker::LatencyTracker()
+{
+    Reset();
+}
+
+void LatencyTracker::Reset()
+{
+    m_nextId = 1;  // The snapshot reports 0 before any turn is stepped
+    m_pending = {};
+    m_pendingCount = 0;
+    m_renderedCount = 0;
+    for (LatencyHistogram& stage : m_stages)
+    {
+        stage.Reset();
+    }
+    m_total.Reset();
+    m_dropped = 0;
+}
+
+TurnTrace LatencyTracker::BeginTurn(uint64_t readingTime, uint64_t polledTime)
+{
+    TurnTrace trace = {};
+    trace.id = m_nextId++;
+    trace.Stamp(LatencyStage::Reading, readingTime);
+    trace.Stamp(LatencyStage::Polled, polledTime);
+    return trace;
+}
+
+void LatencyTracker::OnStepped(const TurnTrace& trace)
+{
+    if (m_pendingCount == c_maxPending)
+    {
+        // Nothing is rendering (or nothing reports it): forget the oldest
+        std::move(m_pending.begin() + 1, m_pending.end(), m_pending.begin());
+        m_pendingCount--;
+        m_renderedCount -= (m_renderedCount > 0) ? 1 : 0;
+        m_dropped++;
+    }
+    m_pending[m_pendingCount++] = trace;
+}
+
+void LatencyTracker::OnRendered(uint32_t lastSteppedId, uint64_t now)
+{
+    // Turns come back in the order they were polled, so the drawn ones lead
+    while (m_renderedCount < m_pendingCount && m_pending[m_renderedCount].id <= lastSteppedId)
+    {
+        m_pending[m_renderedCount++].Stamp(LatencyStage::Rendered, now);
+    }
+}
+
+void LatencyTracker::OnPresented(uint64_t now)
+{
+    if (m_renderedCount == 0)
+        return;
+
+    for (size_t i = 0; i < m_renderedCount; ++i)
+    {
+        m_pending[i].Stamp(LatencyStage::Presented, now);
+        Record(m_pending[i]);
+    }
+    std::move(m_pending.begin() + static_cast<ptrdiff_t>(m_renderedCount), m_pending.begin() + static_cast<ptrdiff_t>(m_pendingCount), m_pending.begin());
+    m_pendingCount -= m_renderedCount;
+    m_renderedCount = 0;
+}
+
+void LatencyTracker::Record(const TurnTrace& trace)
+{
+    // Stamps come from different threads on the same steady clock; a reading time
+    // converted from the device clock can land slightly after the poll, so clamp
+    for (size_t stage = 1; stage < c_latencyStageCount; ++stage)
+    {
+        const uint64_t from = trace.stamps[stage - 1];
+        const uint64_t to = trace.stamps[stage];
+        m_stages[stage].Add((to > from) ? to - from : 0);
+    }
+
+    const uint64_t reading = trace.GetStamp(LatencyStage::Reading);
+    const uint64_t presented = trace.GetStamp(LatencyStage::Presented);
+    m_total.Add((presented > reading) ? presented - reading : 0);
+}
+
+const char* LatencyTracker::GetStageName(LatencyStage stage)
+{
+    switch (stage)
+    {
+    case LatencyStage::Reading:   return "Reading";
+    case LatencyStage::Polled:    return "Polled";
+    case LatencyStage::Queued:    return "Queued";
+    case LatencyStage::Stepped:   return "Stepped";
+    case LatencyStage::Rendered:  return "Rendered";
+    case LatencyStage::Presented: return "Presented";
+    default:                      return "Total";
+    }
+}
+
+void LatencyTracker::FormatStage(LatencyStage stage, char* buffer, size_t size) const
+{
+    char histogram[96];
+    ((stage == LatencyStage::Count) ? m_total : GetStage(stage)).Format(histogram, sizeof(histogram));
+    snprintf(buffer, size, "%-10s %s", GetStageName(stage), histogram);
+}
+
+void LatencyTracker::Dump(FILE* file) const
+{
+    char line[128];
+    for (size_t stage = 1; stage <= c_latencyStageCount; ++stage)
+    {
+        FormatStage(static_cast<LatencyStage>(stage), line, sizeof(line));
+        fprintf(file, "%s\n", line);
+    }
+    if (m_dropped > 0)
+    {
+        fprintf(file, "%llu turns dropped before they were drawn\n", static_cast<unsigned long long>(m_dropped));
+    }
+}
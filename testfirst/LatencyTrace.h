@@ -0,0 +1,144 @@
+//
+// LatencyTrace.h
+// End-to-end input latency: timestamps for each turn from the device reading to
+// Present, aggregated into per-stage histograms
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// The game stamps turns only when built with SNAKE_LATENCY_TRACE=1 (CMake option
+// ENABLE_LATENCY_TRACE); otherwise the instrumentation in Game and SimulationThread
+// compiles out and nothing here is used.
+#ifndef SNAKE_LATENCY_TRACE
+#define SNAKE_LATENCY_TRACE 0
+#endif
+
+// Pipeline stages a turn passes through, in order
+enum class LatencyStage : uint8_t
+{
+    Reading,    // Device reading taken (GameInput timestamp)
+    Polled,     // InputRouter::Poll handed it out
+    Queued,     // SnakeGame::QueueDirection accepted it (simulation thread)
+    Stepped,    // The step that applied the turn ran (simulation thread)
+    Rendered,   // The first Render that drew that step
+    Presented,  // DeviceResources::Present returned for that frame
+    Count
+};
+
+constexpr size_t c_latencyStageCount = static_cast<size_t>(LatencyStage::Count);
+
+// The clock every stage is stamped on: steady clock, nanoseconds
+inline uint64_t LatencyNow()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// One turn's trip through the pipeline
+struct TurnTrace
+{
+    uint32_t id;  // Assigned when polled, increasing
+    std::array<uint64_t, c_latencyStageCount> stamps;  // LatencyNow() at each stage reached so far
+
+    void Stamp(LatencyStage stage, uint64_t time) { stamps[static_cast<size_t>(stage)] = time; }
+    uint64_t GetStamp(LatencyStage stage) const { return stamps[static_cast<size_t>(stage)]; }
+};
+
+// Histogram of durations with four buckets per power of two microseconds, so the
+// relative error of a percentile stays under 25% from microseconds to seconds.
+// Count, mean and max are exact.
+class LatencyHistogram
+{
+public:
+    static constexpr size_t c_bucketCount = 128;  // Up to 2^32 us; longer clamps into the last bucket
+
+    LatencyHistogram() { Reset(); }
+
+    void Add(uint64_t nanoseconds);
+    void Reset();
+
+    uint64_t GetCount() const { return m_count; }
+    double GetMeanMs() const;
+    double GetMaxMs() const { return static_cast<double>(m_maxNs) * 1e-6; }
+
+    // Upper bound of the bucket holding the p-th fraction (0..1) of the samples
+    double GetPercentileMs(double p) const;
+
+    // "n=12 mean 3.10 p50 2.75 p99 9.50 max 9.87 ms"
+    void Format(char* buffer, size_t size) const;
+
+private:
+    static size_t BucketOf(uint64_t microseconds);
+    static uint64_t BucketEndUs(size_t bucket);
+
+    std::array<uint32_t, c_bucketCount> m_buckets;
+    uint64_t m_count;
+    uint64_t m_totalNs;
+    uint64_t m_maxNs;
+};
+
+// Collects the stages of each turn on the thread that polls, renders and presents
+// (Game's main thread) and records finished turns into the histograms.
+//
+// BeginTurn stamps a polled turn; the simulation thread adds Queued and Stepped and
+// hands it back through OnStepped. The snapshot a frame draws names the newest turn
+// stepped into it, so OnRendered marks every waiting turn up to that one, and
+// OnPresented completes the turns the frame drew. Turns the snake never takes
+// (dropped by its direction queue, or lost to a restart) never come back and are
+// simply not counted. Nothing here allocates.
+class LatencyTracker
+{
+public:
+    LatencyTracker();
+
+    // A turn polled at polledTime from a reading taken at readingTime
+    TurnTrace BeginTurn(uint64_t readingTime, uint64_t polledTime);
+
+    // A turn the simulation stepped (Queued and Stepped stamped). If more than
+    // c_maxPending turns are waiting to be drawn, the oldest is dropped.
+    void OnStepped(const TurnTrace& trace);
+
+    // A frame drew a snapshot whose newest stepped turn is lastSteppedId
+    void OnRendered(uint32_t lastSteppedId, uint64_t now);
+
+    // The frame drawn by the last OnRendered was presented
+    void OnPresented(uint64_t now);
+
+    // Time from the previous stage to this one (empty for Reading)
+    const LatencyHistogram& GetStage(LatencyStage stage) const { return m_stages[static_cast<size_t>(stage)]; }
+
+    // Reading to Presented
+    const LatencyHistogram& GetTotal() const { return m_total; }
+
+    // Turns dropped while waiting to be drawn
+    uint64_t GetDroppedCount() const { return m_dropped; }
+
+    // One line per stage and the total
+    void Dump(FILE* file) const;
+
+    // "Queued     n=12 mean ..." for one stage, or the total if stage is Count
+    void FormatStage(LatencyStage stage, char* buffer, size_t size) const;
+
+    static const char* GetStageName(LatencyStage stage);
+
+    void Reset();
+
+private:
+    static constexpr size_t c_maxPending = 64;
+
+    void Record(const TurnTrace& trace);
+
+    uint32_t m_nextId;
+    std::array<TurnTrace, c_maxPending> m_pending;  // Stepped, not presented yet; oldest first
+    size_t m_pendingCount;
+    size_t m_renderedCount;  // Leading m_pending entries already drawn
+
+    std::array<LatencyHistogram, c_latencyStageCount> m_stages;
+    LatencyHistogram m_total;
+    uint64_t m_dropped;
+};
@@ -0,0 +1,131 @@
+//
+// ParticleBudget.cpp
+// Particle budget implementation
+//
+
+#include "pch.h"
+#include "ParticleBudget.h"
+
+#include <algorithm>
+#include <cstdio>
+
+ParticleBudget::ParticleBudget(const ParticleBudgetSettings& settings)
+    : m_settings(settings)
+    , m_timeLimit(static_cast<double>(settings.maxParticles))
+    , m_costPerParticle(0.0)
+    , m_overrunFrames(0)
+    , m_frameRequests{}
+    , m_lastFrameRequests{}
+    , m_counters{}
+{
+}
+
+void ParticleBudget::SetSettings(const ParticleBudgetSettings& settings)
+{
+    m_settings = settings;
+    m_timeLimit = static_cast<double>(settings.maxParticles);
+    m_costPerParticle = 0.0;
+    m_overrunFrames = 0;
+    m_frameRequests = {};
+    m_lastFrameRequests = {};
+}
+
+bool ParticleBudget::IsUnderPressure(size_t level, size_t requested, size_t live) const
+{
+    size_t wanted = live + requested;
+    for (size_t higher = level + 1; higher < c_priorityCount; ++higher)
+    {
+        wanted += m_lastFrameRequests[higher];
+    }
+    if (wanted > GetLimit())
+        return true;
+
+    if (m_settings.updateBudgetMs <= 0.0)
+        return false;
+
+    const double budgetSeconds = m_settings.updateBudgetMs * 1e-3;
+    return m_overrunFrames > 0 || m_costPerParticle * static_cast<double>(wanted) > budgetSeconds;
+}
+
+ParticleBudget::Grant ParticleBudget::Request(uint32_t priority, size_t requested, size_t live)
+{
+    const size_t level = std::min<size_t>(priority, c_priorityCount - 1);
+    m_counters.requested[level] += requested;
+    m_frameRequests[level] += requested;
+    if (!IsUnderPressure(level, requested, live))
+        return Grant{ requested, 1.0f };
+
+    const size_t levelLimit = GetLimit() * (level + 1) / c_priorityCount;
+
+    Grant grant = { 0, 1.0f };
+    grant.count = (live < levelLimit) ? std::min(requested, levelLimit - live) : 0;
+    if (grant.count > 0)
+    {
+        const float fill = static_cast<float>(live + grant.count) / static_cast<float>(levelLimit);
+        if (fill > c_shortenFrom)
+        {
+            const float pressure = std::min(1.0f, (fill - c_shortenFrom) / (1.0f - c_shortenFrom));
+            grant.lifetimeScale = 1.0f - (1.0f - c_minLifetimeScale) * pressure;
+            m_counters.shortened[level] += grant.count;
+        }
+    }
+
+    m_counters.thinned[level] += requested - grant.count;
+    m_counters.thinnedRequests += (grant.count < requested) ? 1 : 0;
+    return grant;
+}
+
+void ParticleBudget::OnUpdate(double seconds, size_t particleCount)
+{
+    m_counters.frames++;
+    m_lastFrameRequests = m_frameRequests;
+    m_frameRequests = {};
+
+    if (m_settings.updateBudgetMs <= 0.0)
+        return;
+
+    const double cost = (particleCount > 0) ? seconds / static_cast<double>(particleCount) : 0.0;
+    if (particleCount > 0)
+    {
+        m_costPerParticle = (m_costPerParticle > 0.0) ? m_costPerParticle + (cost - m_costPerParticle) * c_costSmoothing : cost;
+    }
+
+    const double budgetSeconds = m_settings.updateBudgetMs * 1e-3;
+    if (seconds > budgetSeconds)
+    {
+        m_counters.framesOverBudget++;
+        m_overrunFrames++;
+        // The smoothed cost, or this frame's if higher (the average still lags a
+        // cost that has just gone up)
+        const double sustainedCost = std::max(m_costPerParticle, cost);
+        if (m_overrunFrames >= c_sustainedOverrun && sustainedCost > 0.0)
+        {
+            m_timeLimit = std::min(m_timeLimit, budgetSeconds / sustainedCost);
+        }
+    }
+    else
+    {
+        m_overrunFrames = 0;
+        m_timeLimit = std::min(static_cast<double>(m_settings.maxParticles), m_timeLimit * (1.0 + c_limitGrowth) + 1.0);
+    }
+}
+
+size_t ParticleBudget::GetLimit() const
+{
+    if (m_settings.updateBudgetMs <= 0.0)
+        return m_settings.maxParticles;
+
+    return std::min(m_settings.maxParticles, static_cast<size_t>(m_timeLimit));
+}
+
+void ParticleBudget::Format(char* buffer, size_t size) const
+{
+    const auto& thinned = m_counters.thinned;
+    const auto& shortened = m_counters.shortened;
+    snprintf(buffer, size, "particles: limit %zu, thinned %llu/%llu/%llu/%llu, shortened %llu/%llu/%llu/%llu",
+        GetLimit(),
+        static_cast<unsigned long long>(thinned[0]), static_cast<unsigned long long>(thinned[1]),
+        static_cast<unsigned long long>(thinned[2]), static_cast<unsigned long long>(thinned[3]),
+        static_cast<unsigned long long>(shortened[0]), static_cast<unsigned long long>(shortened[1]),
+        static_cast<unsigned long long>(shortened[2]), static_cast<unsigned long long>(shortened[3]));
+}
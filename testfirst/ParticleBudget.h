@@ -0,0 +1,112 @@
+//
+// ParticleBudget.h
+// Global particle budget: live-count cap, update-time budget and priority shedding
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct ParticleBudgetSettings
+{
+    size_t maxParticles;    // Live particles allowed at any time
+    double updateBudgetMs;  // Effects2D::Update time allowed per frame (0: no time limit)
+
+    // Count cap only: no clock is read, so the same seed and inputs always give
+    // the same particles (headless runs, replays, benches)
+    static ParticleBudgetSettings Deterministic(size_t maxParticles) { return ParticleBudgetSettings{ maxParticles, 0.0 }; }
+};
+
+// What the budget has refused so far, per emitter priority
+struct ParticleBudgetCounters
+{
+    static constexpr size_t c_priorityCount = 4;
+
+    std::array<uint64_t, c_priorityCount> requested;  // Particles emitters asked for
+    std::array<uint64_t, c_priorityCount> thinned;    // ...that were never spawned
+    std::array<uint64_t, c_priorityCount> shortened;  // ...spawned with a shortened lifetime
+    uint64_t thinnedRequests;   // Requests (bursts or a running emitter's frame) that lost particles
+    uint64_t frames;            // Updates measured
+    uint64_t framesOverBudget;  // ...that took longer than updateBudgetMs
+};
+
+// Decides, before anything spawns, how much of each spawn request the frame can
+// afford. Nothing is culled after spawning: particles already alive always run
+// out their lifetime.
+//
+// The limit on live particles is the lower of maxParticles and a time limit
+// fed from each frame's measured Effects2D::Update time. Each measured frame
+// feeds a smoothed cost per particle (c_costSmoothing of the new sample). Only
+// after c_sustainedOverrun frames in a row over the time budget is the time
+// limit cut, to what the budget affords at that smoothed cost or at the frame's
+// own cost, whichever is higher; a one-off stall, such as the OS preempting the
+// thread, sheds nothing. Each frame within budget raises the limit by
+// c_limitGrowth of itself, so it climbs back over a few dozen frames.
+//
+// Requests are granted in full while they fit: the live count, plus what
+// higher priorities asked for in the last frame, stays within the limit and,
+// with a time budget, neither is the last frame over it nor would the smoothed
+// cost of that count be. A request that does not fit is under pressure, and
+// priorities split the limit: a priority p request may only fill the pool up to
+// (p + 1) / c_priorityCount of it, so the lowest priority is thinned first and
+// the highest keeps the whole limit. Once such a request would take its level
+// past c_shortenFrom full, its particles also get shorter lifetimes (down to
+// c_minLifetimeScale at the top), which lowers the steady-state count of
+// running emitters without dropping as many of their particles.
+class ParticleBudget
+{
+public:
+    static constexpr size_t c_priorityCount = ParticleBudgetCounters::c_priorityCount;  // 0 sheds first
+    static constexpr float c_shortenFrom = 0.5f;
+    static constexpr float c_minLifetimeScale = 0.5f;
+    static constexpr double c_limitGrowth = 1.0 / 16.0;  // Per frame within budget
+    static constexpr double c_costSmoothing = 1.0 / 8.0;  // Weight of each frame's cost sample
+    static constexpr uint32_t c_sustainedOverrun = 4;  // Frames over budget in a row before the limit is cut
+
+    // How much of a request may spawn
+    struct Grant
+    {
+        size_t count;
+        float lifetimeScale;  // Multiplies the particles' lifetimes (1 = as defined)
+    };
+
+    explicit ParticleBudget(const ParticleBudgetSettings& settings);
+
+    // Change the limits (the time limit starts over; the counters are kept)
+    void SetSettings(const ParticleBudgetSettings& settings);
+    const ParticleBudgetSettings& GetSettings() const { return m_settings; }
+
+    // Grant for `requested` particles at `priority` (clamped to the highest) with
+    // `live` already alive; counts what is shed
+    Grant Request(uint32_t priority, size_t requested, size_t live);
+
+    // The last update took `seconds` for `particleCount` particles
+    void OnUpdate(double seconds, size_t particleCount);
+
+    // Live particles currently allowed (to the highest priority)
+    size_t GetLimit() const;
+
+    // Smoothed Update time per particle in seconds (0 until measured)
+    double GetCostPerParticle() const { return m_costPerParticle; }
+
+    const ParticleBudgetCounters& GetCounters() const { return m_counters; }
+    void ResetCounters() { m_counters = ParticleBudgetCounters{}; }
+
+    // "particles: limit 4096, thinned 0/0/12/0, shortened 0/0/40/0"
+    void Format(char* buffer, size_t size) const;
+
+private:
+    // True if `requested` more particles at `level`, on top of `live` and the
+    // higher priorities' requests of the last frame, would not fit
+    bool IsUnderPressure(size_t level, size_t requested, size_t live) const;
+
+    ParticleBudgetSettings m_settings;
+    double m_timeLimit;  // Particles the time budget affords, by the last frames
+    double m_costPerParticle;  // Smoothed seconds per particle (0: unmeasured)
+    uint32_t m_overrunFrames;  // Frames over budget in a row
+    std::array<size_t, c_priorityCount> m_frameRequests;  // Requested since the last OnUpdate, per priority
+    std::array<size_t, c_priorityCount> m_lastFrameRequests;  // ...and in the frame before
+    ParticleBudgetCounters m_counters;
+};
@@ -0,0 +1,271 @@
+//
+// ParticleEmitter.cpp
+// Emitter definition parsing and curve baking
+//
+
+#include "pch.h"
+#include "ParticleEmitter.h"
+#include "ParticleBudget.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const char* const c_defaultEmitters =
+        "# Food eaten: a gold burst that fades out\n"
+        "emitter eat\n"
+        "priority 3\n"
+        "burst 12\n"
+        "lifetime 0.6 0.6\n"
+        "speed 75 150\n"
+        "angle 0 360\n"
+        "size 12 24\n"
+        "color 0 1 0.84 0 1\n"
+        "color 1 1 0.84 0 0\n";
+
+    // A curve key: life fraction and up to four values
+    struct CurveKey
+    {
+        float t;
+        float value[4];
+    };
+
+    // Linear between keys, flat past either end; `fallback` with no keys
+    void EvaluateCurve(const std::vector<CurveKey>& keys, float t, const float* fallback, size_t width, float* out)
+    {
+        const float* value = fallback;
+        float blend[4];
+        if (!keys.empty())
+        {
+            size_t next = 0;
+            while (next < keys.size() && keys[next].t < t)
+            {
+                ++next;
+            }
+
+            if (next == 0)
+            {
+                value = keys.front().value;
+            }
+            else if (next == keys.size())
+            {
+                value = keys.back().value;
+            }
+            else
+            {
+                const CurveKey& a = keys[next - 1];
+                const CurveKey& b = keys[next];
+                const float s = (t - a.t) / (b.t - a.t);
+                for (size_t i = 0; i < width; ++i)
+                {
+                    blend[i] = a.value[i] + (b.value[i] - a.value[i]) * s;
+                }
+                value = blend;
+            }
+        }
+
+        for (size_t i = 0; i < width; ++i)
+        {
+            out[i] = value[i];
+        }
+    }
+
+    ParticleCurves BakeCurves(const std::vector<CurveKey>& colorKeys, const std::vector<CurveKey>& scaleKeys)
+    {
+        constexpr float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        constexpr float unitScale[1] = { 1.0f };
+
+        ParticleCurves curves;
+        for (size_t i = 0; i < ParticleCurves::c_sampleCount; ++i)
+        {
+            const float t = static_cast<float>(i) / static_cast<float>(ParticleCurves::c_sampleCount - 1);
+            Float4 color;
+            EvaluateCurve(colorKeys, t, white, 4, &color.x);
+            curves.color[i] = PackColor(color);
+            EvaluateCurve(scaleKeys, t, unitScale, 1, &curves.size[i]);
+        }
+        return curves;
+    }
+
+    EmitterDefinition MakeDefaultDefinition(const std::string& name)
+    {
+        EmitterDefinition definition = {};
+        definition.name = name;
+        definition.lifetime = FloatRange{ 1.0f, 1.0f };
+        definition.speed = FloatRange{ 0.0f, 0.0f };
+        definition.angle = FloatRange{ 0.0f, 360.0f };
+        definition.size = FloatRange{ 8.0f, 8.0f };
+        return definition;
+    }
+
+    // Reads exactly `count` numbers and nothing after them
+    bool ReadValues(std::istringstream& fields, float* values, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!(fields >> values[i]))
+                return false;
+        }
+        std::string extra;
+        return !(fields >> extra);
+    }
+
+    bool ReadRange(std::istringstream& fields, FloatRange& range)
+    {
+        float values[2];
+        if (!ReadValues(fields, values, 2) || values[0] > values[1])
+            return false;
+        range = FloatRange{ values[0], values[1] };
+        return true;
+    }
+
+    bool ReadKey(std::istringstream& fields, size_t width, std::vector<CurveKey>& keys)
+    {
+        float values[5];
+        if (!ReadValues(fields, values, width + 1) || values[0] < 0.0f || values[0] > 1.0f
+            || (!keys.empty() && values[0] <= keys.back().t))
+            return false;
+
+        CurveKey key = { values[0], { 0.0f, 0.0f, 0.0f, 0.0f } };
+        for (size_t i = 0; i < width; ++i)
+        {
+            key.value[i] = values[i + 1];
+        }
+        keys.push_back(key);
+        return true;
+    }
+}
+
+EmitterLibrary EmitterLibrary::Parse(const std::string& text)
+{
+    EmitterLibrary library;
+    std::vector<CurveKey> colorKeys;
+    std::vector<CurveKey> scaleKeys;
+    auto finish = [&]()
+    {
+        if (!library.m_definitions.empty())
+        {
+            library.m_curves.push_back(BakeCurves(colorKeys, scaleKeys));
+        }
+        colorKeys.clear();
+        scaleKeys.clear();
+    };
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line))
+    {
+        ++lineNumber;
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword) || keyword[0] == '#')
+            continue;
+
+        EmitterDefinition* definition = library.m_definitions.empty() ? nullptr : &library.m_definitions.back();
+        bool ok = definition != nullptr;
+        if (keyword == "emitter")
+        {
+            std::string name;
+            std::string extra;
+            ok = (fields >> name) && !(fields >> extra) && library.Find(name) < 0
+                && library.m_definitions.size() < c_maxDefinitions;
+            if (ok)
+            {
+                finish();
+                library.m_definitions.push_back(MakeDefaultDefinition(name));
+            }
+        }
+        else if (!ok)
+        {
+            // Fields before the first emitter line
+        }
+        else if (keyword == "priority")
+        {
+            float priority;
+            ok = ReadValues(fields, &priority, 1) && priority >= 0.0f && priority < ParticleBudget::c_priorityCount
+                && priority == static_cast<float>(static_cast<uint32_t>(priority));
+            definition->priority = ok ? static_cast<uint32_t>(priority) : 0;
+        }
+        else if (keyword == "burst")
+        {
+            float count;
+            ok = ReadValues(fields, &count, 1) && count >= 0.0f && count <= 65536.0f
+                && count == static_cast<float>(static_cast<uint32_t>(count));
+            definition->burstCount = ok ? static_cast<uint32_t>(count) : 0;
+        }
+        else if (keyword == "rate")
+        {
+            float values[2];
+            ok = ReadValues(fields, values, 2) && values[0] >= 0.0f && values[1] >= 0.0f;
+            definition->spawnRate = ok ? values[0] : 0.0f;
+            definition->duration = ok ? values[1] : 0.0f;
+        }
+        else if (keyword == "lifetime")
+        {
+            ok = ReadRange(fields, definition->lifetime) && definition->lifetime.min > 0.0f;
+        }
+        else if (keyword == "speed")
+        {
+            ok = ReadRange(fields, definition->speed);
+        }
+        else if (keyword == "angle")
+        {
+            ok = ReadRange(fields, definition->angle);
+        }
+        else if (keyword == "size")
+        {
+            ok = ReadRange(fields, definition->size) && definition->size.min >= 0.0f;
+        }
+        else if (keyword == "color")
+        {
+            ok = ReadKey(fields, 4, colorKeys);
+        }
+        else if (keyword == "scale")
+        {
+            ok = ReadKey(fields, 1, scaleKeys) && scaleKeys.back().value[0] >= 0.0f;
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            throw std::runtime_error("Bad emitter line " + std::to_string(lineNumber) + ": " + line);
+        }
+    }
+    finish();
+
+    return library;
+}
+
+EmitterLibrary EmitterLibrary::LoadFile(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open emitters: " + path);
+    }
+
+    std::ostringstream text;
+    text << file.rdbuf();
+    return Parse(text.str());
+}
+
+EmitterLibrary EmitterLibrary::CreateDefault()
+{
+    return Parse(c_defaultEmitters);
+}
+
+int EmitterLibrary::Find(const std::string& name) const
+{
+    for (size_t i = 0; i < m_definitions.size(); ++i)
+    {
+        if (m_definitions[i].name == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
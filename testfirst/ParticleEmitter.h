@@ -0,0 +1,84 @@
+//
+// ParticleEmitter.h
+// Data-driven particle emitter definitions
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ParticlePool.h"
+
+// Uniform random range [min, max]
+struct FloatRange
+{
+    float min;
+    float max;
+
+    float Lerp(float t) const { return min + (max - min) * t; }
+};
+
+// How an emitter spawns its particles. Color and size over life are given as
+// keys but only kept baked into the library's ParticleCurves.
+struct EmitterDefinition
+{
+    std::string name;
+    uint32_t priority;    // ParticleBudget shedding order: 0 (first shed) to c_priorityCount - 1
+    uint32_t burstCount;  // Particles spawned at once when emitted
+    float spawnRate;      // Particles per second after the burst...
+    float duration;       // ...for this many seconds (0: burst only)
+    FloatRange lifetime;  // Seconds
+    FloatRange speed;     // Pixels per second
+    FloatRange angle;     // Direction in degrees, 0 = +x, 90 = +y (down the screen)
+    FloatRange size;      // Pixels at birth
+};
+
+// A set of emitter definitions and their baked curves, read from text like:
+//
+//     # Comment
+//     emitter eat
+//     priority 3                 0 (shed first) to 3, see ParticleBudget
+//     burst 12
+//     rate 0 0                   particles per second, seconds
+//     lifetime 0.6 0.6
+//     speed 75 150
+//     angle 0 360
+//     size 12 24
+//     color 0 1 0.84 0 1         life fraction, r g b a (0-1)
+//     color 1 1 0.84 0 0
+//     scale 0 1                  life fraction, size multiplier
+//
+// Each `emitter` line starts a definition; the lines after it set its fields,
+// and anything left out keeps the defaults (priority 0, burst only, white, full
+// size). Curve keys are linear between keys, held flat past the first and last, and
+// must be in increasing life fraction order.
+class EmitterLibrary
+{
+public:
+    static constexpr size_t c_maxDefinitions = 0xFFFF;  // Curve indices are 16-bit
+
+    // Definitions from the text format above; throws std::runtime_error naming
+    // the bad line
+    static EmitterLibrary Parse(const std::string& text);
+    static EmitterLibrary LoadFile(const std::string& path);
+
+    // The effects the game ships with
+    static EmitterLibrary CreateDefault();
+
+    // Index of the named definition, or -1
+    int Find(const std::string& name) const;
+
+    size_t GetCount() const { return m_definitions.size(); }
+    const EmitterDefinition& GetDefinition(size_t index) const { return m_definitions[index]; }
+
+    // Baked curves, one per definition at the same index (ParticlePool::Export input)
+    const ParticleCurves* GetCurves() const { return m_curves.data(); }
+    const ParticleCurves& GetCurves(size_t index) const { return m_curves[index]; }
+
+private:
+    std::vector<EmitterDefinition> m_definitions;
+    std::vector<ParticleCurves> m_curves;
+};
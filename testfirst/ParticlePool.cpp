@@ -0,0 +1,152 @@
+//
+// ParticlePool.cpp
+// Fixed-capacity particle storage implementation
+//
+
+#include "pch.h"
+#include "ParticlePool.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+ParticlePool::ParticlePool(size_t capacity)
+    : m_capacity(capacity)
+    , m_count(0)
+{
+    if (capacity > std::numeric_limits<uint32_t>::max())
+        throw std::invalid_argument("ParticlePool capacity must fit in 32 bits");
+
+    // Whole chunks, so the last chunk's slice of m_expired is full size too
+    const size_t chunkCount = (capacity + c_chunkSize - 1) / c_chunkSize;
+    const size_t rounded = std::max<size_t>(1, chunkCount) * c_chunkSize;
+    m_posX = AllocateAligned<float>(rounded);
+    m_posY = AllocateAligned<float>(rounded);
+    m_velocityX = AllocateAligned<float>(rounded);
+    m_velocityY = AllocateAligned<float>(rounded);
+    m_lifetime = AllocateAligned<float>(rounded);
+    m_fadeRate = AllocateAligned<float>(rounded);
+    m_size = AllocateAligned<float>(rounded);
+    m_curves = AllocateAligned<uint16_t>(rounded);
+    m_expired = AllocateAligned<uint32_t>(rounded);
+    m_expiredCount.resize(std::max<size_t>(1, chunkCount));
+}
+
+size_t ParticlePool::Append(size_t count)
+{
+    const size_t first = m_count;
+    m_count += std::min(count, m_capacity - m_count);
+    return first;
+}
+
+void ParticlePool::Update(float elapsedTime, ThreadPool* pool)
+{
+    const size_t chunkCount = (m_count + c_chunkSize - 1) / c_chunkSize;
+    if (pool && m_count >= c_minParallelCount)
+    {
+        pool->ParallelFor(m_count, c_chunkSize, [this, elapsedTime](size_t begin, size_t end)
+        {
+            IntegrateChunk(begin, end, elapsedTime);
+        });
+    }
+    else
+    {
+        for (size_t begin = 0; begin < m_count; begin += c_chunkSize)
+        {
+            IntegrateChunk(begin, std::min(m_count, begin + c_chunkSize), elapsedTime);
+        }
+    }
+
+    RemoveExpired(chunkCount);
+}
+
+void ParticlePool::IntegrateChunk(size_t begin, size_t end, float elapsedTime)
+{
+    float* posX = m_posX.get();
+    float* posY = m_posY.get();
+    const float* velocityX = m_velocityX.get();
+    const float* velocityY = m_velocityY.get();
+    float* lifetime = m_lifetime.get();
+
+    // Integrate and age every particle, expired ones included (they are removed
+    // afterwards), so the loop has no branches
+    for (size_t i = begin; i < end; ++i)
+    {
+        posX[i] += velocityX[i] * elapsedTime;
+        posY[i] += velocityY[i] * elapsedTime;
+        lifetime[i] -= elapsedTime;
+    }
+
+    uint32_t* expired = m_expired.get() + begin;
+    uint32_t expiredCount = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        expired[expiredCount] = static_cast<uint32_t>(i);
+        expiredCount += (lifetime[i] <= 0.0f) ? 1 : 0;
+    }
+    m_expiredCount[begin / c_chunkSize] = expiredCount;
+}
+
+void ParticlePool::RemoveExpired(size_t chunkCount)
+{
+    // Holes in ascending order; each takes the last particle still alive, and
+    // expired ones found at the end are just dropped. Everything at or past
+    // `live` has been dealt with, so a hole there ends the pass.
+    size_t live = m_count;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        const uint32_t* expired = m_expired.get() + chunk * c_chunkSize;
+        for (uint32_t i = 0; i < m_expiredCount[chunk]; ++i)
+        {
+            const size_t hole = expired[i];
+            if (hole >= live)
+            {
+                m_count = live;
+                return;
+            }
+            while (live > hole + 1 && m_lifetime[live - 1] <= 0.0f)
+            {
+                --live;
+            }
+            if (live == hole + 1)
+            {
+                // Nothing alive after the hole: drop it with the rest
+                m_count = hole;
+                return;
+            }
+
+            --live;
+            Move(live, hole);
+        }
+    }
+    m_count = live;
+}
+
+void ParticlePool::Move(size_t from, size_t to)
+{
+    m_posX[to] = m_posX[from];
+    m_posY[to] = m_posY[from];
+    m_velocityX[to] = m_velocityX[from];
+    m_velocityY[to] = m_velocityY[from];
+    m_lifetime[to] = m_lifetime[from];
+    m_fadeRate[to] = m_fadeRate[from];
+    m_size[to] = m_size[from];
+    m_curves[to] = m_curves[from];
+}
+
+Particle ParticlePool::GetParticle(size_t index, const ParticleCurves* curves) const
+{
+    const ParticleCurves& curve = curves[m_curves[index]];
+    const size_t sample = ParticleCurves::GetSampleIndex(GetLifeFraction(index));
+    return Particle{ GetPosition(index), m_size[index] * curve.size[sample], curve.color[sample] };
+}
+
+void ParticlePool::Export(std::vector<Particle>& particles, const ParticleCurves* curves) const
+{
+    particles.resize(m_count);
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        particles[i] = GetParticle(i, curves);
+    }
+}
@@ -0,0 +1,183 @@
+//
+// ParticlePool.h
+// Fixed-capacity particle storage (structure-of-arrays)
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+class ThreadPool;
+
+// Plain vector types for the simulation (same layout as DirectX::XMFLOAT2/XMFLOAT4,
+// so the effects logic does not depend on DirectXMath)
+struct Float2
+{
+    float x;
+    float y;
+};
+
+struct Float4
+{
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+// A particle as drawn: what snapshots copy and the renderer reads
+struct Particle
+{
+    Float2 pos;
+    float size;
+    uint32_t color;  // PackColor, alpha included
+};
+
+// RGBA8 color, red in the low byte (DXGI_FORMAT_R8G8B8A8_UNORM order)
+constexpr uint32_t PackColor(const Float4& color)
+{
+    auto channel = [](float value) -> uint32_t
+    {
+        const float clamped = (value < 0.0f) ? 0.0f : (value > 1.0f) ? 1.0f : value;
+        return static_cast<uint32_t>(clamped * 255.0f + 0.5f);
+    };
+    return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+}
+
+inline Float4 UnpackColor(uint32_t color)
+{
+    constexpr float scale = 1.0f / 255.0f;
+    return Float4{ static_cast<float>(color & 0xFF) * scale, static_cast<float>((color >> 8) & 0xFF) * scale,
+        static_cast<float>((color >> 16) & 0xFF) * scale, static_cast<float>(color >> 24) * scale };
+}
+
+// Color and size over a particle's life, sampled at evenly spaced points from
+// birth (0) to death (1), so drawing a particle is a table lookup
+struct ParticleCurves
+{
+    static constexpr size_t c_sampleCount = 64;
+
+    std::array<uint32_t, c_sampleCount> color;  // PackColor, alpha included
+    std::array<float, c_sampleCount> size;      // Scales the particle's birth size
+
+    // Sample nearest to lifeFraction (0 at birth, 1 at death; clamped)
+    static size_t GetSampleIndex(float lifeFraction)
+    {
+        const float position = lifeFraction * static_cast<float>(c_sampleCount - 1) + 0.5f;
+        return (position <= 0.0f) ? 0 : std::min(static_cast<size_t>(position), c_sampleCount - 1);
+    }
+};
+
+// Up to a fixed number of live particles, stored as parallel arrays.
+//
+// Every field has its own array, so Update is one plain loop over contiguous
+// floats that the compiler can vectorize (integrate and age everything), then a
+// compaction pass that swap-removes the expired particles: each hole is filled
+// with the last live particle, so a frame costs O(count) however many expire.
+// Particle order is therefore not kept. Color and size over life are not stored
+// per particle: each particle names a ParticleCurves table and keeps its fade
+// rate (one over the starting lifetime), and drawing looks both up by how much
+// of its life has passed. Nothing allocates after construction.
+//
+// Given a ThreadPool and enough particles, Update integrates fixed chunks of
+// c_chunkSize particles on the pool (the arrays are cache-line aligned and the
+// chunk size is a whole number of lines, so no two jobs write the same line).
+// Each chunk lists its expired particles in its own slice of a scratch array,
+// and the holes are filled on the calling thread in index order, so the result
+// is the same bit for bit with any number of threads, or none.
+class ParticlePool
+{
+public:
+    static constexpr size_t c_cacheLineSize = 64;
+    static constexpr size_t c_chunkSize = 8192;  // Particles per job
+    static constexpr size_t c_minParallelCount = 2 * c_chunkSize;  // Fewer run inline
+
+    explicit ParticlePool(size_t capacity);
+
+    // Remove every particle
+    void Clear() { m_count = 0; }
+
+    // Make room for count new particles at the end (fewer if the pool fills up)
+    // and return the index of the first; the caller fills them in with Set
+    size_t Append(size_t count);
+
+    // Initialize particle `index` (lifetime in seconds; curves indexes the tables
+    // passed to Export)
+    void Set(size_t index, Float2 pos, Float2 velocity, float lifetime, float size, uint16_t curves)
+    {
+        m_posX[index] = pos.x;
+        m_posY[index] = pos.y;
+        m_velocityX[index] = velocity.x;
+        m_velocityY[index] = velocity.y;
+        m_lifetime[index] = lifetime;
+        m_fadeRate[index] = 1.0f / lifetime;
+        m_size[index] = size;
+        m_curves[index] = curves;
+    }
+
+    // Move every particle by elapsedTime and drop the ones whose lifetime ran out.
+    // With a pool (not owned; nothing else may be waiting on it) and at least
+    // c_minParallelCount particles, the chunks run on the pool's workers.
+    void Update(float elapsedTime, ThreadPool* pool = nullptr);
+
+    // Drawable copy of every live particle, colored and sized from curves[the
+    // particle's curves index] (particles is resized; it only allocates while it grows)
+    void Export(std::vector<Particle>& particles, const ParticleCurves* curves) const;
+
+    size_t GetCount() const { return m_count; }
+    size_t GetCapacity() const { return m_capacity; }
+
+    // Per-particle getters (index < GetCount())
+    Float2 GetPosition(size_t index) const { return Float2{ m_posX[index], m_posY[index] }; }
+    Float2 GetVelocity(size_t index) const { return Float2{ m_velocityX[index], m_velocityY[index] }; }
+    float GetLifetime(size_t index) const { return m_lifetime[index]; }  // Remaining, in seconds
+    float GetLifeFraction(size_t index) const { return 1.0f - m_lifetime[index] * m_fadeRate[index]; }  // 0 at birth
+    float GetSize(size_t index) const { return m_size[index]; }  // At birth
+    uint16_t GetCurves(size_t index) const { return m_curves[index]; }
+    Particle GetParticle(size_t index, const ParticleCurves* curves) const;
+
+private:
+    struct AlignedDelete
+    {
+        void operator()(void* memory) const { ::operator delete(memory, std::align_val_t(c_cacheLineSize)); }
+    };
+
+    template<typename T>
+    using AlignedArray = std::unique_ptr<T[], AlignedDelete>;
+
+    template<typename T>
+    static AlignedArray<T> AllocateAligned(size_t count)
+    {
+        return AlignedArray<T>(static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(c_cacheLineSize))));
+    }
+
+    // Integrate [begin, end) (one chunk) and list its expired particles
+    void IntegrateChunk(size_t begin, size_t end, float elapsedTime);
+
+    // Fill the holes the chunks listed with the last live particles
+    void RemoveExpired(size_t chunkCount);
+
+    void Move(size_t from, size_t to);
+
+    size_t m_capacity;
+    size_t m_count;
+
+    AlignedArray<float> m_posX;
+    AlignedArray<float> m_posY;
+    AlignedArray<float> m_velocityX;
+    AlignedArray<float> m_velocityY;
+    AlignedArray<float> m_lifetime;  // Remaining lifetime in seconds
+    AlignedArray<float> m_fadeRate;  // 1 / starting lifetime
+    AlignedArray<float> m_size;       // At birth
+    AlignedArray<uint16_t> m_curves;  // Index into the ParticleCurves passed to Export
+
+    // Update scratch: each chunk's expired indices, in its own slice of m_expired
+    AlignedArray<uint32_t> m_expired;
+    std::vector<uint32_t> m_expiredCount;  // Per chunk
+};
@@ -0,0 +1,80 @@
+//
+// Random.h
+// Small, fast, seedable PRNG owned per game/effects instance (PCG32)
+//
+
+#pragma once
+
+#include <cstdint>
+
+// PCG-XSH-RR 32-bit generator (64-bit state, fixed stream).
+//
+// Each SnakeGame / Effects2D / batch game owns one, so there is no hidden shared
+// state between modules or threads, and the same seed replays the same sequence
+// on every platform (unlike rand(), whose algorithm and range are CRT-specific).
+class Pcg32
+{
+public:
+    explicit Pcg32(uint64_t seed = 0) noexcept : m_state(0) { Seed(seed); }
+
+    void Seed(uint64_t seed) noexcept
+    {
+        m_state = 0;
+        Next();
+        m_state += seed;
+        Next();
+    }
+
+    // Uniform 32-bit value
+    uint32_t Next() noexcept
+    {
+        const uint64_t old = m_state;
+        m_state = old * c_multiplier + c_increment;
+        const uint32_t xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        const uint32_t rot = static_cast<uint32_t>(old >> 59u);
+        return (xorShifted >> rot) | (xorShifted << ((0u - rot) & 31u));
+    }
+
+    // Uniform value in [0, bound) without modulo bias (bound > 0)
+    uint32_t NextBelow(uint32_t bound) noexcept
+    {
+        uint64_t product = static_cast<uint64_t>(Next()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound)
+        {
+            const uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold)
+            {
+                product = static_cast<uint64_t>(Next()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Uniform float in [0, 1)
+    float NextFloat() noexcept
+    {
+        return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Raw state, for saving and restoring a generator
+    uint64_t GetState() const noexcept { return m_state; }
+    void SetState(uint64_t state) noexcept { m_state = state; }
+
+private:
+    static constexpr uint64_t c_multiplier = 6364136223846793005ull;
+    static constexpr uint64_t c_increment = 1442695040888963407ull;
+
+    uint64_t m_state;
+};
+
+// SplitMix64 step: turns one seed into a stream of well-mixed seeds
+// (used to give each sub-generator, e.g. each game in a batch, its own seed)
+inline uint64_t SplitMix64(uint64_t& state) noexcept
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,367 @@
+//
+// Replay.cpp
+// Input replay implementation
+//
+
+#include "pch.h"
+#include "Replay.h"
+
+namespace
+{
+    const uint8_t c_magic[4] = { 'S', 'N', 'R', 'P' };
+    constexpr uint8_t c_version = 3;  // 2: timestep in timer ticks instead of float seconds; 3: directions queued per step
+
+    // Record flags
+    constexpr uint8_t c_flagStart = 0x01;
+    constexpr uint8_t c_flagPause = 0x02;
+    constexpr uint8_t c_flagDirection = 0x04;  // Direction in bits 3-4
+    constexpr uint8_t c_directionShift = 3;
+    constexpr uint8_t c_flagTimestep = 0x20;   // Varint timestep (timer ticks) follows
+    constexpr uint8_t c_flagEnd = 0x80;        // Footer follows
+
+    uint64_t ZigZag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t UnZigZag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+}
+
+ReplayRecorder::ReplayRecorder()
+    : m_file(nullptr)
+    , m_ticks(0)
+    , m_emptyTicks(0)
+    , m_lastElapsedTicks(0)
+    , m_chunk(nullptr)
+    , m_chunkIndex(0)
+    , m_chunkUsed(0)
+    , m_chunkBytes{}
+    , m_freeRing{}
+    , m_fullRing{}
+    , m_freeHead(0)
+    , m_freeCount(0)
+    , m_fullHead(0)
+    , m_fullCount(0)
+    , m_stopWriter(false)
+{
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    if (m_file)
+    {
+        // Not finished explicitly: flush what we have, without a footer
+        if (m_chunkUsed > 0)
+        {
+            SubmitChunk();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopWriter = true;
+        }
+        m_chunkFull.notify_one();
+        m_writer.join();
+        fclose(m_file);
+    }
+}
+
+void ReplayRecorder::Start(const std::string& path, const ReplayHeader& header)
+{
+    if (m_file)
+    {
+        throw std::logic_error("ReplayRecorder: already recording");
+    }
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file)
+    {
+        throw std::runtime_error("ReplayRecorder: cannot open " + path);
+    }
+
+    m_chunkStorage.assign(c_chunkSize * c_chunkCount, 0);
+    m_freeHead = 0;
+    m_freeCount = 0;
+    m_fullHead = 0;
+    m_fullCount = 0;
+    for (size_t i = 1; i < c_chunkCount; ++i)
+    {
+        m_freeRing[m_freeCount++] = i;
+    }
+    m_chunkIndex = 0;
+    m_chunk = &m_chunkStorage[0];
+    m_chunkUsed = 0;
+    m_ticks = 0;
+    m_emptyTicks = 0;
+    m_lastElapsedTicks = 0;
+    m_stopWriter = false;
+
+    // The header goes into the first chunk like any other record
+    for (uint8_t byte : c_magic)
+    {
+        PutByte(byte);
+    }
+    PutByte(c_version);
+    PutVarint(header.seed);
+    PutVarint(static_cast<uint64_t>(header.screenWidth));
+    PutVarint(static_cast<uint64_t>(header.screenHeight));
+
+    m_writer = std::thread(&ReplayRecorder::WriterThread, this);
+}
+
+void ReplayRecorder::Record(const InputState& input, uint64_t elapsedTicks)
+{
+    if (!m_file)
+        return;
+
+    m_ticks++;
+
+    uint8_t flags = 0;
+    if (input.startPressed)
+        flags |= c_flagStart;
+    if (input.pausePressed)
+        flags |= c_flagPause;
+    if (input.dir.has_value())
+        flags |= static_cast<uint8_t>(c_flagDirection | (static_cast<uint8_t>(input.dir.value()) << c_directionShift));
+
+    const bool timestepChanged = (elapsedTicks != m_lastElapsedTicks);
+    if (flags == 0 && !timestepChanged)
+    {
+        m_emptyTicks++;
+        return;
+    }
+
+    if (timestepChanged)
+        flags |= c_flagTimestep;
+
+    FlushEmptyTicks(flags);
+    if (timestepChanged)
+    {
+        PutVarint(elapsedTicks);
+        m_lastElapsedTicks = elapsedTicks;
+    }
+}
+
+void ReplayRecorder::Finish(const ReplayResult& result)
+{
+    if (!m_file)
+        return;
+
+    FlushEmptyTicks(c_flagEnd);
+    PutVarint(result.ticks);
+    PutVarint(ZigZag(result.score));
+    PutVarint(result.length);
+    PutVarint(static_cast<uint64_t>(result.lastGameOverTick + 1));
+    SubmitChunk();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopWriter = true;
+    }
+    m_chunkFull.notify_one();
+    m_writer.join();
+
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+void ReplayRecorder::FlushEmptyTicks(uint8_t flags)
+{
+    EnsureSpace();
+    PutVarint(m_emptyTicks);
+    PutByte(flags);
+    m_emptyTicks = 0;
+}
+
+void ReplayRecorder::PutVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        PutByte(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    PutByte(static_cast<uint8_t>(value));
+}
+
+void ReplayRecorder::EnsureSpace()
+{
+    if (m_chunkUsed + c_maxRecordSize > c_chunkSize)
+    {
+        SubmitChunk();
+    }
+}
+
+void ReplayRecorder::SubmitChunk()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_chunkBytes[m_chunkIndex] = m_chunkUsed;
+    m_fullRing[(m_fullHead + m_fullCount) % c_chunkCount] = m_chunkIndex;
+    m_fullCount++;
+    m_chunkFull.notify_one();
+
+    // Only waits if the writer has fallen a whole pool behind
+    m_chunkFree.wait(lock, [this]() { return m_freeCount > 0; });
+    m_chunkIndex = m_freeRing[m_freeHead];
+    m_freeHead = (m_freeHead + 1) % c_chunkCount;
+    m_freeCount--;
+
+    m_chunk = &m_chunkStorage[m_chunkIndex * c_chunkSize];
+    m_chunkUsed = 0;
+}
+
+void ReplayRecorder::WriterThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_chunkFull.wait(lock, [this]() { return m_fullCount > 0 || m_stopWriter; });
+        if (m_fullCount == 0)
+            break;
+
+        const size_t index = m_fullRing[m_fullHead];
+        m_fullHead = (m_fullHead + 1) % c_chunkCount;
+        m_fullCount--;
+
+        lock.unlock();
+        fwrite(&m_chunkStorage[index * c_chunkSize], 1, m_chunkBytes[index], m_file);
+        lock.lock();
+
+        m_freeRing[(m_freeHead + m_freeCount) % c_chunkCount] = index;
+        m_freeCount++;
+        m_chunkFree.notify_one();
+    }
+
+    fflush(m_file);
+}
+
+ReplayReader::ReplayReader()
+    : m_offset(0)
+    , m_header{}
+    , m_result{}
+    , m_hasResult(false)
+    , m_emptyTicks(0)
+    , m_hasPending(false)
+    , m_pending{}
+    , m_pendingElapsedTicks(0)
+    , m_elapsedTicks(0)
+{
+}
+
+void ReplayReader::Open(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        throw std::runtime_error("ReplayReader: cannot open " + path);
+    }
+
+    m_data.clear();
+    uint8_t buffer[4096];
+    size_t bytesRead;
+    while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        m_data.insert(m_data.end(), buffer, buffer + bytesRead);
+    }
+    fclose(file);
+
+    m_offset = 0;
+    for (uint8_t byte : c_magic)
+    {
+        if (GetByte() != byte)
+        {
+            throw std::runtime_error("ReplayReader: not a replay file");
+        }
+    }
+    if (GetByte() != c_version)
+    {
+        throw std::runtime_error("ReplayReader: unsupported replay version");
+    }
+
+    m_header.seed = GetVarint();
+    m_header.screenWidth = static_cast<int>(GetVarint());
+    m_header.screenHeight = static_cast<int>(GetVarint());
+
+    m_result = ReplayResult{};
+    m_hasResult = false;
+    m_elapsedTicks = 0;
+    ReadRecord();
+}
+
+bool ReplayReader::Next(InputState& input, uint64_t& elapsedTicks)
+{
+    if (m_emptyTicks > 0)
+    {
+        m_emptyTicks--;
+        input = InputState{};
+        elapsedTicks = m_elapsedTicks;
+        return true;
+    }
+
+    if (!m_hasPending)
+        return false;
+
+    input = m_pending;
+    m_elapsedTicks = m_pendingElapsedTicks;
+    elapsedTicks = m_elapsedTicks;
+    ReadRecord();
+    return true;
+}
+
+void ReplayReader::ReadRecord()
+{
+    m_hasPending = false;
+    if (m_offset == m_data.size())
+    {
+        // Recording was not finished: play what was flushed
+        return;
+    }
+
+    m_emptyTicks = GetVarint();
+    const uint8_t flags = GetByte();
+
+    if (flags & c_flagEnd)
+    {
+        m_result.ticks = GetVarint();
+        m_result.score = static_cast<int>(UnZigZag(GetVarint()));
+        m_result.length = static_cast<uint32_t>(GetVarint());
+        m_result.lastGameOverTick = static_cast<int64_t>(GetVarint()) - 1;
+        m_hasResult = true;
+        return;
+    }
+
+    m_pending = InputState{};
+    m_pending.startPressed = (flags & c_flagStart) != 0;
+    m_pending.pausePressed = (flags & c_flagPause) != 0;
+    if (flags & c_flagDirection)
+    {
+        m_pending.dir = static_cast<Direction>((flags >> c_directionShift) & 3);
+    }
+    m_pendingElapsedTicks = (flags & c_flagTimestep) ? GetVarint() : m_elapsedTicks;
+    m_hasPending = true;
+}
+
+uint8_t ReplayReader::GetByte()
+{
+    if (m_offset >= m_data.size())
+    {
+        throw std::runtime_error("ReplayReader: replay file is truncated");
+    }
+    return m_data[m_offset++];
+}
+
+uint64_t ReplayReader::GetVarint()
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const uint8_t byte = GetByte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw std::runtime_error("ReplayReader: bad varint");
+}
@@ -0,0 +1,144 @@
+//
+// Replay.h
+// Input replay: compact recording of the per-tick input stream and playback
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InputRouter.h"
+
+// Session parameters stored at the start of a replay (enough to rebuild the session)
+struct ReplayHeader
+{
+    uint64_t seed;      // GameSession seed
+    int screenWidth;    // Board size in pixels
+    int screenHeight;
+};
+
+// Outcome stored at the end of a replay, checked by playback
+struct ReplayResult
+{
+    uint64_t ticks;          // Update calls recorded
+    int score;               // Final score
+    uint32_t length;         // Final snake length
+    int64_t lastGameOverTick;  // Tick of the last game over, or -1
+};
+
+// Records InputState + timestep per tick into a replay file.
+//
+// Encoding: ticks with no input and an unchanged timestep are only counted; every
+// other tick writes one record (varint count of skipped ticks, a flags byte with
+// start/pause/direction bits, and the timestep as varint timer ticks only when it
+// changed).
+// A steady 60 Hz session with occasional turns costs a few bytes per input.
+//
+// Record() only writes into preallocated chunks; full chunks go to a background
+// thread that writes them to the file, so recording never allocates or touches the
+// disk on the game thread. It only blocks if every chunk is still waiting to be
+// written.
+class ReplayRecorder
+{
+public:
+    ReplayRecorder();
+    ~ReplayRecorder();
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    // Open the file, write the header and start the writer thread (throws on failure)
+    void Start(const std::string& path, const ReplayHeader& header);
+
+    // Append one tick (the input and timestep passed to GameSession::Update)
+    void Record(const InputState& input, uint64_t elapsedTicks);
+
+    // Write the footer, flush everything and close the file
+    void Finish(const ReplayResult& result);
+
+    bool IsRecording() const { return m_file != nullptr; }
+    uint64_t GetTickCount() const { return m_ticks; }
+
+private:
+    void WriterThread();
+    void EnsureSpace();
+    void SubmitChunk();
+    void PutByte(uint8_t value) { m_chunk[m_chunkUsed++] = value; }
+    void PutVarint(uint64_t value);
+    void FlushEmptyTicks(uint8_t flags);
+
+    static constexpr size_t c_chunkSize = 4096;
+    static constexpr size_t c_chunkCount = 8;
+    static constexpr size_t c_maxRecordSize = 32;  // Largest record or footer
+
+    FILE* m_file;
+    uint64_t m_ticks;
+    uint64_t m_emptyTicks;  // Ticks since the last record with no input and the same timestep
+    uint64_t m_lastElapsedTicks;
+
+    // Chunk being filled on the game thread
+    uint8_t* m_chunk;
+    size_t m_chunkIndex;
+    size_t m_chunkUsed;
+
+    // Chunk pool: m_chunkCount chunks of c_chunkSize bytes, cycled through
+    // a free queue and a full queue (both fixed-size rings of chunk indices)
+    std::vector<uint8_t> m_chunkStorage;
+    size_t m_chunkBytes[c_chunkCount];
+    size_t m_freeRing[c_chunkCount];
+    size_t m_fullRing[c_chunkCount];
+    size_t m_freeHead;
+    size_t m_freeCount;
+    size_t m_fullHead;
+    size_t m_fullCount;
+    bool m_stopWriter;
+
+    std::mutex m_mutex;
+    std::condition_variable m_chunkFull;
+    std::condition_variable m_chunkFree;
+    std::thread m_writer;
+};
+
+// Reads a replay file back tick by tick
+class ReplayReader
+{
+public:
+    ReplayReader();
+
+    // Load and validate the whole file (throws std::runtime_error on bad data)
+    void Open(const std::string& path);
+
+    const ReplayHeader& GetHeader() const { return m_header; }
+
+    // Next recorded tick; returns false at the end of the stream
+    bool Next(InputState& input, uint64_t& elapsedTicks);
+
+    // Outcome from the footer (valid once Next has returned false; a recording
+    // that was never finished plays back up to its last flushed chunk, without one)
+    bool HasResult() const { return m_hasResult; }
+    const ReplayResult& GetResult() const { return m_result; }
+
+private:
+    uint8_t GetByte();
+    uint64_t GetVarint();
+    void ReadRecord();
+
+    std::vector<uint8_t> m_data;
+    size_t m_offset;
+    ReplayHeader m_header;
+    ReplayResult m_result;
+    bool m_hasResult;
+
+    // Decoded record waiting behind m_emptyTicks empty ticks
+    uint64_t m_emptyTicks;
+    bool m_hasPending;
+    InputState m_pending;
+    uint64_t m_pendingElapsedTicks;
+    uint64_t m_elapsedTicks;  // Timestep of the empty ticks
+};
@@ -0,0 +1,229 @@
+//
+// SimulationThread.cpp
+// Fixed-rate simulation thread implementation
+//
+
+#include "pch.h"
+#include "SimulationThread.h"
+
+#include <algorithm>
+#include <chrono>
+
+SimulationThread::SimulationThread(uint64_t stepTicks)
+    : m_recorder(nullptr)
+    , m_stepTicks(stepTicks)
+    , m_carriedInput{}
+    , m_hasCarriedInput(false)
+    , m_stopRequested(false)
+    , m_updateCount(0)
+    , m_lastGameOverUpdate(-1)
+#if SNAKE_LATENCY_TRACE
+    , m_queuedTurns{}
+    , m_queuedTurnCount(0)
+    , m_lastSteppedTurn(0)
+#endif
+{
+    if (stepTicks == 0)
+        throw std::invalid_argument("SimulationThread step must be at least one tick");
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::SetParticleBudget(const ParticleBudgetSettings& settings)
+{
+    if (m_thread.joinable())
+        throw std::logic_error("SimulationThread particle budget cannot change while running");
+
+    m_session.SetParticleBudget(settings);
+}
+
+void SimulationThread::Start(int screenWidth, int screenHeight, uint64_t seed, ReplayRecorder* recorder)
+{
+    if (m_thread.joinable())
+        throw std::logic_error("SimulationThread is already running");
+
+    m_session.Initialize(screenWidth, screenHeight, seed);
+    m_recorder = recorder;
+    m_hasCarriedInput = false;
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_updateCount.store(0, std::memory_order_relaxed);
+    m_lastGameOverUpdate = -1;
+#if SNAKE_LATENCY_TRACE
+    m_queuedTurnCount = 0;
+    m_lastSteppedTurn = 0;
+#endif
+
+    // Size every snapshot copy for a full board and the particle cap up front, so
+    // publishing does not allocate while the snake grows or under load; then publish the initial state so the renderer
+    // has something to draw before the first update
+    const size_t cellCount = static_cast<size_t>(m_session.GetSnakeGame().GetGridWidth())
+        * static_cast<size_t>(m_session.GetSnakeGame().GetGridHeight());
+    for (int i = 0; i < 3; ++i)
+    {
+        GameSessionSnapshot& snapshot = m_snapshots.GetSlot(i);
+        snapshot.segments.reserve(cellCount);
+        snapshot.particles.reserve(Effects2D::c_maxParticles);
+    }
+    m_session.CaptureSnapshot(m_snapshots.GetBack());
+#if SNAKE_LATENCY_TRACE
+    m_snapshots.GetBack().lastSteppedTurn = 0;
+#endif
+    m_snapshots.Publish();
+
+    m_thread = std::thread([this]() { ThreadMain(); });
+}
+
+void SimulationThread::Stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    m_thread.join();
+    m_recorder = nullptr;
+}
+
+ReplayResult SimulationThread::GetResult() const
+{
+    const SnakeGame& snakeGame = m_session.GetSnakeGame();
+    return ReplayResult{ GetUpdateCount(), snakeGame.GetScore(),
+        static_cast<uint32_t>(snakeGame.GetLength()), m_lastGameOverUpdate };
+}
+
+void SimulationThread::ThreadMain()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto stepDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(m_stepTicks * 1000000000ull / SnakeGame::c_ticksPerSecond));
+
+    // Updates are due at fixed points on the steady clock (not "sleep one step"
+    // after each), so the rate does not drift with the time the updates take
+    auto nextUpdate = Clock::now();
+    while (!m_stopRequested.load(std::memory_order_relaxed))
+    {
+        RunUpdate();
+
+        nextUpdate += stepDuration;
+        const auto now = Clock::now();
+        if (now - nextUpdate > stepDuration * c_maxCatchUpUpdates)
+        {
+            nextUpdate = now;
+        }
+        std::this_thread::sleep_until(nextUpdate);
+    }
+}
+
+void SimulationThread::RunUpdate()
+{
+#if SNAKE_LATENCY_TRACE
+    const uint64_t updateStart = LatencyNow();
+    TurnTrace mergedTrace = {};  // Of the merged direction: the first input that brought it
+#endif
+
+    // Merge the queued inputs into one; a second, different direction waits for the
+    // next update (with the input it came with), so every turn reaches the snake's
+    // queue while repeats of the same direction fold together
+    InputState merged = {};
+    if (m_hasCarriedInput)
+    {
+        merged = m_carriedInput.input;
+        m_hasCarriedInput = false;
+#if SNAKE_LATENCY_TRACE
+        mergedTrace = m_carriedInput.trace;
+#endif
+    }
+    SimulationInput item;
+    while (m_inputs.TryPop(item))
+    {
+        if (merged.dir && item.input.dir && *item.input.dir != *merged.dir)
+        {
+            m_carriedInput = item;
+            m_hasCarriedInput = true;
+            break;
+        }
+        MergeInput(merged, item.input);
+#if SNAKE_LATENCY_TRACE
+        if (item.input.dir && mergedTrace.id == 0)
+        {
+            mergedTrace = item.trace;
+        }
+#endif
+    }
+
+    // Record what the session actually saw, one entry per update, so the replay
+    // runs the same updates without the thread
+    if (m_recorder)
+    {
+        m_recorder->Record(merged, m_stepTicks);
+    }
+
+    const GameSessionEvents events = m_session.Update(m_stepTicks, merged);
+    const uint64_t update = m_updateCount.load(std::memory_order_relaxed);
+    if (events.gameOver)
+    {
+        m_lastGameOverUpdate = static_cast<int64_t>(update);
+    }
+    m_updateCount.store(update + 1, std::memory_order_relaxed);
+
+#if SNAKE_LATENCY_TRACE
+    TraceTurns(events, mergedTrace, updateStart);
+#endif
+
+    // Feedback is best effort: if the platform layer stopped draining it, a missed
+    // rumble is better than stalling the simulation
+    if (events.foodEaten > 0 || events.stopRumble)
+    {
+        m_feedback.TryPush(SimulationFeedback{ events.foodEaten, events.stopRumble, events.gameOver });
+    }
+
+    m_session.CaptureSnapshot(m_snapshots.GetBack());
+#if SNAKE_LATENCY_TRACE
+    m_snapshots.GetBack().lastSteppedTurn = m_lastSteppedTurn;
+#endif
+    m_snapshots.Publish();
+}
+
+#if SNAKE_LATENCY_TRACE
+void SimulationThread::TraceTurns(const GameSessionEvents& events, const TurnTrace& mergedTrace, uint64_t updateStart)
+{
+    // Mirror the snake's direction queue: a restart empties it, an accepted
+    // direction joins the back, each turn a step takes leaves the front. The
+    // direction is queued near the start of the update and the steps run at its
+    // end, so those are the stamps.
+    if (events.restarted)
+    {
+        m_queuedTurnCount = 0;
+    }
+
+    if (events.turnQueued && m_queuedTurnCount < m_queuedTurns.size())
+    {
+        TurnTrace& trace = m_queuedTurns[m_queuedTurnCount++];
+        trace = mergedTrace;
+        trace.Stamp(LatencyStage::Queued, updateStart);
+    }
+
+    if (events.turnsTaken > 0)
+    {
+        const uint64_t now = LatencyNow();
+        const size_t taken = std::min(static_cast<size_t>(events.turnsTaken), m_queuedTurnCount);
+        for (size_t i = 0; i < taken; ++i)
+        {
+            TurnTrace& trace = m_queuedTurns[i];
+            trace.Stamp(LatencyStage::Stepped, now);
+
+            // Untraced directions (id 0) still take their place in the queue.
+            // Like feedback, best effort if the main thread stops draining.
+            if (trace.id != 0)
+            {
+                m_steppedTurns.TryPush(trace);
+                m_lastSteppedTurn = trace.id;
+            }
+        }
+        std::move(m_queuedTurns.begin() + static_cast<ptrdiff_t>(taken), m_queuedTurns.begin() + static_cast<ptrdiff_t>(m_queuedTurnCount), m_queuedTurns.begin());
+        m_queuedTurnCount -= taken;
+    }
+}
+#endif
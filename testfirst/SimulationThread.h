@@ -0,0 +1,141 @@
+//
+// SimulationThread.h
+// Runs a GameSession on its own thread at a fixed rate, decoupled from rendering
+//
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "GameSession.h"
+#include "LatencyTrace.h"
+#include "Replay.h"
+#include "SpscRing.h"
+#include "TripleBuffer.h"
+
+// Platform feedback from one simulation update (rumble, logging)
+struct SimulationFeedback
+{
+    int foodEaten;    // Food eaten this update
+    bool stopRumble;  // Paused, died or won this update
+    bool gameOver;    // The round ended in a game over this update
+};
+
+// One polled input on its way to the simulation thread
+struct SimulationInput
+{
+    InputState input;
+#if SNAKE_LATENCY_TRACE
+    TurnTrace trace;  // Reading and Polled stamps (used if input.dir is set)
+#endif
+};
+
+// Owns a GameSession and steps it on a dedicated thread at a fixed tick rate.
+//
+// Each other thread talks to it through its own wait-free channel, so the
+// simulation never waits for rendering or input and vice versa:
+//  - input: the polling thread pushes InputStates into an SPSC ring; each
+//    simulation update drains the ring and merges what it finds into one input
+//    (up to a second, different direction, so quick turns are spread over updates)
+//  - render: the simulation publishes a GameSessionSnapshot per update through a
+//    triple buffer; the renderer acquires the newest whole snapshot
+//  - feedback: updates with something to report push a SimulationFeedback into a
+//    second SPSC ring for the platform layer (rumble)
+// Each channel needs exactly one thread at each end; in the game all three are
+// served from the main thread (Game::Update pushes input and pops feedback,
+// Game::Render acquires snapshots).
+//
+// With SNAKE_LATENCY_TRACE, a direction pushed with a TurnTrace is stamped when
+// the snake's queue accepts it and when a step takes it, then returned through a
+// third ring (PopSteppedTurn); each snapshot names the newest turn taken so far.
+class SimulationThread
+{
+public:
+    // Default step: 120 updates per second
+    static constexpr uint64_t c_defaultStepTicks = SnakeGame::c_ticksPerSecond / 120;
+
+    explicit SimulationThread(uint64_t stepTicks = c_defaultStepTicks);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Initialize the session (see GameSession::Initialize) and start the thread.
+    // If recorder is given, every update's merged input is recorded on the
+    // simulation thread until Stop, so the run replays with snake_headless --replay.
+    void Start(int screenWidth, int screenHeight, uint64_t seed, ReplayRecorder* recorder = nullptr);
+
+    // Stop and join the thread (no-op if not running)
+    void Stop();
+
+    // Particle limits for the session's effects (see GameSession::SetParticleBudget);
+    // only while the thread is stopped
+    void SetParticleBudget(const ParticleBudgetSettings& settings);
+
+    // Input side: queue one polled input for the next update; false if the ring
+    // is full (it holds far more than one update's worth of polls)
+    bool PushInput(const InputState& input)
+    {
+        SimulationInput item = {};
+        item.input = input;
+        return m_inputs.TryPush(item);
+    }
+
+#if SNAKE_LATENCY_TRACE
+    // Same, carrying the stamps the input collected so far
+    bool PushInput(const InputState& input, const TurnTrace& trace) { return m_inputs.TryPush(SimulationInput{ input, trace }); }
+
+    // Turns taken by a step, oldest first (the same thread as AcquireSnapshot)
+    bool PopSteppedTurn(TurnTrace& trace) { return m_steppedTurns.TryPop(trace); }
+#endif
+
+    // Feedback side: take the oldest pending feedback; false if there is none
+    bool PopFeedback(SimulationFeedback& feedback) { return m_feedback.TryPop(feedback); }
+
+    // Render side: the newest published snapshot. Stays valid and unchanged until
+    // the next AcquireSnapshot call from the same thread.
+    const GameSessionSnapshot& AcquireSnapshot() { return m_snapshots.Acquire(); }
+
+    // Updates run so far (any thread)
+    uint64_t GetUpdateCount() const { return m_updateCount.load(std::memory_order_relaxed); }
+
+    // Final result for the replay footer (only after Stop)
+    ReplayResult GetResult() const;
+
+    uint64_t GetStepTicks() const { return m_stepTicks; }
+
+private:
+    void ThreadMain();
+    void RunUpdate();
+#if SNAKE_LATENCY_TRACE
+    void TraceTurns(const GameSessionEvents& events, const TurnTrace& mergedTrace, uint64_t updateStart);
+#endif
+
+    // Updates the simulation may fall behind before it skips ahead instead of
+    // catching up (e.g. after the process was suspended)
+    static constexpr int c_maxCatchUpUpdates = 30;
+
+    GameSession m_session;  // Simulation thread only while running
+    ReplayRecorder* m_recorder;
+    const uint64_t m_stepTicks;
+
+    SpscRing<SimulationInput, 256> m_inputs;
+    SimulationInput m_carriedInput;  // Popped but left for the next update (see RunUpdate)
+    bool m_hasCarriedInput;
+    SpscRing<SimulationFeedback, 64> m_feedback;
+    TripleBuffer<GameSessionSnapshot> m_snapshots;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<uint64_t> m_updateCount;
+    int64_t m_lastGameOverUpdate;
+
+#if SNAKE_LATENCY_TRACE
+    // Traces of the directions in the snake's queue, in the same order
+    std::array<TurnTrace, DirectionQueue::c_capacity> m_queuedTurns;
+    size_t m_queuedTurnCount;
+    uint32_t m_lastSteppedTurn;
+    SpscRing<TurnTrace, 64> m_steppedTurns;
+#endif
+};
@@ -0,0 +1,523 @@
+//
+// SnakeAutopilot.cpp
+// AI controller implementation
+//
+
+#include "pch.h"
+#include "SnakeAutopilot.h"
+
+namespace
+{
+    // Cells expanded between checks of the stop conditions
+    constexpr int c_expandChunk = 32;
+
+    const Direction c_directions[4] = { Direction::Up, Direction::Down, Direction::Left, Direction::Right };
+
+    GridCell Neighbor(GridCell cell, Direction dir)
+    {
+        switch (dir)
+        {
+        case Direction::Up:
+            cell.y = static_cast<int16_t>(cell.y - 1);
+            break;
+        case Direction::Down:
+            cell.y = static_cast<int16_t>(cell.y + 1);
+            break;
+        case Direction::Left:
+            cell.x = static_cast<int16_t>(cell.x - 1);
+            break;
+        case Direction::Right:
+            cell.x = static_cast<int16_t>(cell.x + 1);
+            break;
+        }
+        return cell;
+    }
+
+    bool IsOnBoard(const SnakeBoardLayout& layout, GridCell cell)
+    {
+        return cell.x >= 0 && cell.x < layout.gridWidth && cell.y >= 0 && cell.y < layout.gridHeight;
+    }
+
+    Direction Opposite(Direction dir)
+    {
+        // Up/Down and Left/Right differ only in the low bit
+        return static_cast<Direction>(static_cast<int>(dir) ^ 1);
+    }
+}
+
+SnakeAutopilot::DistanceField::DistanceField()
+    : m_queueHead(0)
+    , m_queueTail(0)
+    , m_epoch(0)
+    , m_root(0)
+    , m_active(false)
+{
+}
+
+void SnakeAutopilot::DistanceField::Resize(size_t cellCount)
+{
+    m_labelEpoch.assign(cellCount, 0);
+    m_distance.assign(cellCount, 0);
+    m_queue.assign(cellCount, 0);
+    m_queueHead = 0;
+    m_queueTail = 0;
+    m_epoch = 1;  // Stamps are 0, so nothing is labelled until Begin
+    m_active = false;
+}
+
+void SnakeAutopilot::DistanceField::Begin(int rootIndex)
+{
+    if (++m_epoch == 0)
+    {
+        // Epoch wrapped: old stamps could look current again
+        std::fill(m_labelEpoch.begin(), m_labelEpoch.end(), 0u);
+        m_epoch = 1;
+    }
+
+    m_root = rootIndex;
+    m_labelEpoch[static_cast<size_t>(rootIndex)] = m_epoch;
+    m_distance[static_cast<size_t>(rootIndex)] = 0;
+    m_queue[0] = rootIndex;
+    m_queueHead = 0;
+    m_queueTail = 1;
+    m_active = true;
+}
+
+int SnakeAutopilot::DistanceField::Expand(const SnakeGame& game, int budget)
+{
+    const SnakeBoardLayout& layout = game.GetLayout();
+    const int gridWidth = layout.gridWidth;
+
+    int expanded = 0;
+    while (expanded < budget && m_queueHead < m_queueTail)
+    {
+        const int index = m_queue[m_queueHead++];
+        const GridCell cell = { static_cast<int16_t>(index % gridWidth), static_cast<int16_t>(index / gridWidth) };
+        const int nextDistance = m_distance[static_cast<size_t>(index)] + 1;
+        ++expanded;
+
+        for (Direction dir : c_directions)
+        {
+            const GridCell next = Neighbor(cell, dir);
+            if (!IsOnBoard(layout, next))
+                continue;
+
+            const int nextIndex = layout.CellIndex(next);
+            if (IsLabelled(nextIndex))
+                continue;
+
+            m_labelEpoch[static_cast<size_t>(nextIndex)] = m_epoch;
+            m_distance[static_cast<size_t>(nextIndex)] = nextDistance;
+            if (!game.IsOccupied(next))
+            {
+                m_queue[m_queueTail++] = nextIndex;
+            }
+        }
+    }
+
+    return expanded;
+}
+
+SnakeAutopilot::SnakeAutopilot(int nodeBudget)
+    : m_nodeBudget(nodeBudget)
+    , m_lastNodeCount(0)
+    , m_mode(Mode::Food)
+    , m_foodSafety(-1)
+    , m_foodCell{ -1, -1 }
+    , m_foodAlive(false)
+    , m_lastHead{ -1, -1 }
+    , m_tailSteps(0)
+    , m_check(SafetyCheck::Idle)
+    , m_virtualEpoch(0)
+    , m_virtualTail(0)
+    , m_virtualHead(0)
+    , m_floodHead(0)
+    , m_floodTail(0)
+    , m_walkCell{ -1, -1 }
+    , m_walkDirection(Direction::Right)
+    , m_walkGrowth(0)
+    , m_pathStart(0)
+    , m_checkSteps(0)
+    , m_checkSize(0)
+{
+}
+
+void SnakeAutopilot::Reset(const SnakeGame& game)
+{
+    const size_t cellCount = static_cast<size_t>(game.GetLayout().CellCount());
+    m_foodField.Resize(cellCount);
+    m_tailField.Resize(cellCount);
+    m_mode = Mode::Food;
+    m_foodSafety = -1;
+    m_foodCell = GridCell{ -1, -1 };
+    m_foodAlive = false;
+    m_lastHead = GridCell{ -1, -1 };
+    m_tailSteps = 0;
+
+    // The virtual body holds the snake plus at most one new head per free cell
+    m_virtualBody.assign(cellCount * 2, 0);
+    m_virtualOccupied.assign(cellCount, 0);
+    m_floodVisited.assign(cellCount, 0);
+    m_floodQueue.assign(cellCount, 0);
+    m_virtualEpoch = 0;
+    m_check = SafetyCheck::Idle;
+}
+
+Direction SnakeAutopilot::Think(const SnakeGame& game)
+{
+    m_lastNodeCount = 0;
+
+    if (game.IsGameOver() || game.IsWon() || game.GetLength() == 0)
+        return game.GetDirection();
+
+    // A turn already queued for the next step is what the head will do; deciding
+    // again from the current direction would stack a second, stale turn behind it
+    const DirectionQueue& queued = game.GetQueuedDirections();
+    if (queued.GetCount() > 0)
+        return queued[queued.GetCount() - 1].dir;
+
+    const SnakeBoardLayout& layout = game.GetLayout();
+    if (m_foodField.GetCellCount() != static_cast<size_t>(layout.CellCount()))
+        Reset(game);
+
+    const GridCell head = game.GetHead();
+    const int headIndex = layout.CellIndex(head);
+    const bool moved = head != m_lastHead;
+    m_lastHead = head;
+
+    // New food invalidates the food field; tail chasing gives the food another try now and then
+    const Food& food = game.GetFood();
+    if (food.alive != m_foodAlive || food.cell != m_foodCell)
+    {
+        BeginFoodSearch(game);
+    }
+    else if (m_mode == Mode::Tail && moved && ++m_tailSteps >= c_tailRetrySteps)
+    {
+        BeginFoodSearch(game);
+    }
+
+    int budget = m_nodeBudget;
+    Direction dir = game.GetDirection();
+
+    if (m_mode == Mode::Food && m_foodField.IsActive())
+    {
+        // Grow the field until it reaches the head
+        while (budget > 0 && !m_foodField.IsComplete() && !m_foodField.IsLabelled(headIndex))
+        {
+            const int expanded = m_foodField.Expand(game, std::min(budget, c_expandChunk));
+            budget -= expanded;
+            m_lastNodeCount += expanded;
+        }
+
+        if (m_foodField.IsLabelled(headIndex) && m_foodSafety < 0)
+        {
+            if (m_check == SafetyCheck::Idle || !IsOnCheckedPath(game, moved))
+            {
+                BeginSafetyCheck(game);
+            }
+            const int used = ContinueSafetyCheck(game, budget);
+            budget -= used;
+            m_lastNodeCount += used;
+        }
+
+        if (m_foodField.IsLabelled(headIndex) && m_foodSafety != 0)
+        {
+            // Still checking: follow the path being checked, short of the food
+            if (Descend(game, m_foodField, dir) && (m_foodSafety == 1 || Neighbor(head, dir) != food.cell))
+                return dir;
+
+            if (m_foodSafety == 1)
+            {
+                // Blocked by the body since the field was built: rebuild it
+                BeginFoodSearch(game);
+            }
+            else
+            {
+                // Next to the food with no verdict yet: circle on the tail and retry
+                m_mode = Mode::Tail;
+                m_tailSteps = 0;
+                BeginTailSearch(game);
+            }
+        }
+        else if (m_foodSafety == 0 || m_foodField.IsComplete())
+        {
+            // Food unreachable or a trap once eaten: chase the tail for a while
+            m_mode = Mode::Tail;
+            m_tailSteps = 0;
+            BeginTailSearch(game);
+        }
+    }
+    else if (m_mode == Mode::Food)
+    {
+        // No food on the board: keep moving safely
+        m_mode = Mode::Tail;
+        BeginTailSearch(game);
+    }
+
+    if (m_mode == Mode::Tail)
+    {
+        while (budget > 0 && !m_tailField.IsComplete() && !m_tailField.IsLabelled(headIndex))
+        {
+            const int expanded = m_tailField.Expand(game, std::min(budget, c_expandChunk));
+            budget -= expanded;
+            m_lastNodeCount += expanded;
+        }
+
+        if (m_tailField.IsLabelled(headIndex))
+        {
+            if (Descend(game, m_tailField, dir))
+                return dir;
+        }
+
+        // Caught up with the old tail cell (or cut off from it): aim at the current tail
+        if (m_tailField.IsLabelled(headIndex) || m_tailField.IsComplete())
+            BeginTailSearch(game);
+    }
+
+    return SafestDirection(game);
+}
+
+bool SnakeAutopilot::Descend(const SnakeGame& game, const DistanceField& field, Direction& outDir) const
+{
+    const SnakeBoardLayout& layout = game.GetLayout();
+    const GridCell head = game.GetHead();
+    const int target = field.GetDistance(layout.CellIndex(head)) - 1;
+    if (target < 0)
+        return false;
+
+    // Prefer going straight, then the other directions in a fixed order
+    const Direction current = game.GetDirection();
+    for (int i = -1; i < 4; ++i)
+    {
+        const Direction dir = (i < 0) ? current : c_directions[i];
+        if (i >= 0 && dir == current)
+            continue;
+
+        const GridCell next = Neighbor(head, dir);
+        if (!IsOnBoard(layout, next))
+            continue;
+
+        const int nextIndex = layout.CellIndex(next);
+        if (field.IsLabelled(nextIndex) && field.GetDistance(nextIndex) == target && !game.IsOccupied(next))
+        {
+            outDir = dir;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Direction SnakeAutopilot::SafestDirection(const SnakeGame& game) const
+{
+    const SnakeBoardLayout& layout = game.GetLayout();
+    const GridCell head = game.GetHead();
+    const Direction current = game.GetDirection();
+
+    Direction best = current;
+    int bestScore = -1;
+    for (int i = -1; i < 4; ++i)
+    {
+        const Direction dir = (i < 0) ? current : c_directions[i];
+        if ((i >= 0 && dir == current) || dir == Opposite(current))
+            continue;
+
+        const GridCell next = Neighbor(head, dir);
+        if (!IsOnBoard(layout, next) || game.IsOccupied(next))
+            continue;
+
+        int score = 0;
+        for (Direction around : c_directions)
+        {
+            const GridCell cell = Neighbor(next, around);
+            if (IsOnBoard(layout, cell) && !game.IsOccupied(cell))
+                ++score;
+        }
+
+        if (score > bestScore)
+        {
+            best = dir;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
+void SnakeAutopilot::BeginSafetyCheck(const SnakeGame& game)
+{
+    const SnakeBoardLayout& layout = game.GetLayout();
+    if (++m_virtualEpoch == 0)
+    {
+        // Epoch wrapped: old stamps could look current again
+        std::fill(m_virtualOccupied.begin(), m_virtualOccupied.end(), 0u);
+        std::fill(m_floodVisited.begin(), m_floodVisited.end(), 0u);
+        m_virtualEpoch = 1;
+    }
+
+    m_virtualTail = 0;
+    m_virtualHead = 0;
+    for (size_t i = game.GetLength(); i-- > 0;)
+    {
+        const int index = layout.CellIndex(game.GetSegment(i));
+        m_virtualBody[m_virtualHead++] = index;
+        m_virtualOccupied[static_cast<size_t>(index)] = m_virtualEpoch;
+    }
+
+    m_walkCell = game.GetHead();
+    m_walkDirection = game.GetDirection();
+    m_walkGrowth = game.GetPendingGrowth();
+    m_pathStart = m_virtualHead - 1;
+    m_checkSteps = 0;
+    m_checkSize = static_cast<int>(game.GetLength()) + game.GetPendingGrowth();
+    m_check = SafetyCheck::Walk;
+}
+
+bool SnakeAutopilot::IsOnCheckedPath(const SnakeGame& game, bool moved)
+{
+    if (moved)
+    {
+        ++m_checkSteps;
+    }
+
+    // Growth the check did not model (SnakeGame::Grow) changes where the tail ends up
+    if (static_cast<int>(game.GetLength()) + game.GetPendingGrowth() != m_checkSize)
+        return false;
+
+    // The walk stays at least as far along as the snake, or the check starts over
+    const size_t slot = m_pathStart + m_checkSteps;
+    return slot < m_virtualHead && m_virtualBody[slot] == game.GetLayout().CellIndex(game.GetHead());
+}
+
+int SnakeAutopilot::ContinueSafetyCheck(const SnakeGame& game, int budget)
+{
+    const SnakeBoardLayout& layout = game.GetLayout();
+    const int gridWidth = layout.gridWidth;
+    const uint32_t epoch = m_virtualEpoch;
+    const int foodIndex = m_foodField.GetRoot();
+    int used = 0;
+
+    auto finish = [this](bool safe)
+    {
+        m_foodSafety = safe ? 1 : 0;
+        m_check = SafetyCheck::Idle;
+    };
+
+    // Follow the field downhill as Descend would, moving the body as SnakeGame does:
+    // the new head must be free before the tail retracts, and the tail holds on the
+    // food and while growth is pending
+    while (m_check == SafetyCheck::Walk && used < budget)
+    {
+        const int target = m_foodField.GetDistance(layout.CellIndex(m_walkCell)) - 1;
+        bool found = false;
+        for (int i = -1; i < 4 && !found; ++i)
+        {
+            const Direction dir = (i < 0) ? m_walkDirection : c_directions[i];
+            if (i >= 0 && dir == m_walkDirection)
+                continue;
+
+            const GridCell next = Neighbor(m_walkCell, dir);
+            if (!IsOnBoard(layout, next))
+                continue;
+
+            const int nextIndex = layout.CellIndex(next);
+            if (m_foodField.IsLabelled(nextIndex) && m_foodField.GetDistance(nextIndex) == target
+                && m_virtualOccupied[static_cast<size_t>(nextIndex)] != epoch)
+            {
+                m_walkCell = next;
+                m_walkDirection = dir;
+                found = true;
+            }
+        }
+        if (!found || m_virtualHead == m_virtualBody.size())
+        {
+            finish(false);
+            return used;
+        }
+
+        const int cellIndex = layout.CellIndex(m_walkCell);
+        m_virtualBody[m_virtualHead++] = cellIndex;
+        m_virtualOccupied[static_cast<size_t>(cellIndex)] = epoch;
+        ++used;
+        if (cellIndex == foodIndex)
+        {
+            // Flood the free cells from the new head; the tail counts once it is
+            // next to a visited cell (it moves away as the head follows it)
+            if (m_virtualBody[m_virtualTail] == cellIndex)
+            {
+                finish(true);
+                return used;
+            }
+            m_floodHead = 0;
+            m_floodTail = 0;
+            m_floodQueue[m_floodTail++] = cellIndex;
+            m_floodVisited[static_cast<size_t>(cellIndex)] = epoch;
+            m_check = SafetyCheck::Flood;
+            break;
+        }
+
+        if (m_walkGrowth > 0)
+            m_walkGrowth--;
+        else
+            m_virtualOccupied[static_cast<size_t>(m_virtualBody[m_virtualTail++])] = 0;
+    }
+
+    const int tailIndex = m_virtualBody[m_virtualTail];
+    const int headIndex = m_virtualBody[m_virtualHead - 1];
+    while (m_check == SafetyCheck::Flood && used < budget)
+    {
+        if (m_floodHead == m_floodTail)
+        {
+            finish(false);
+            return used;
+        }
+
+        const int index = m_floodQueue[m_floodHead++];
+        const GridCell from = { static_cast<int16_t>(index % gridWidth), static_cast<int16_t>(index / gridWidth) };
+        ++used;
+
+        for (Direction dir : c_directions)
+        {
+            const GridCell next = Neighbor(from, dir);
+            if (!IsOnBoard(layout, next))
+                continue;
+
+            const int nextIndex = layout.CellIndex(next);
+            if (nextIndex == tailIndex && index != headIndex)
+            {
+                finish(true);
+                return used;
+            }
+
+            if (m_floodVisited[static_cast<size_t>(nextIndex)] == epoch || m_virtualOccupied[static_cast<size_t>(nextIndex)] == epoch)
+                continue;
+
+            m_floodVisited[static_cast<size_t>(nextIndex)] = epoch;
+            m_floodQueue[m_floodTail++] = nextIndex;
+        }
+    }
+
+    return used;
+}
+
+void SnakeAutopilot::BeginFoodSearch(const SnakeGame& game)
+{
+    const Food& food = game.GetFood();
+    m_foodCell = food.cell;
+    m_foodAlive = food.alive;
+    m_foodSafety = -1;
+    m_check = SafetyCheck::Idle;
+    m_mode = Mode::Food;
+    m_tailSteps = 0;
+
+    if (food.alive)
+        m_foodField.Begin(game.GetLayout().CellIndex(food.cell));
+    else
+        m_foodField.Clear();
+}
+
+void SnakeAutopilot::BeginTailSearch(const SnakeGame& game)
+{
+    const GridCell tail = game.GetSegment(game.GetLength() - 1);
+    m_tailField.Begin(game.GetLayout().CellIndex(tail));
+}
@@ -0,0 +1,159 @@
+//
+// SnakeAutopilot.h
+// AI controller for SnakeGame (attract mode, load testing)
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SnakeGame.h"
+
+// Steers a SnakeGame towards the food through QueueDirection.
+//
+// The autopilot keeps a BFS distance field rooted at the food and walks the head
+// downhill on it. Because the head only ever moves to cells with a smaller
+// distance, a field stays usable across ticks until the food moves, so it is built
+// once per food and spread over as many ticks as it needs: each Think call expands
+// at most the node budget. Once the field reaches the head, the path to the food is
+// played out on a copy of the body (growing on the food and by any pending growth)
+// and the food is only taken if the tail is still reachable from where the head
+// ends up; if not, the autopilot chases its own tail on a second field instead.
+// That check is resumable too and shares the same budget: each step of the path
+// and each cell of the flood counts as a node. While it runs the head keeps
+// following the path it is checking, but it does not step onto the food before
+// the verdict; if it leaves the path the check starts over. While a field is
+// still being built it takes the free neighbor with the most free neighbors.
+class SnakeAutopilot
+{
+public:
+    explicit SnakeAutopilot(int nodeBudget = c_defaultNodeBudget);
+    ~SnakeAutopilot() = default;
+
+    // Size the search buffers for the game's board and drop any search in progress
+    // (call after SnakeGame::Reset)
+    void Reset(const SnakeGame& game);
+
+    // Choose the next direction, expanding at most the node budget
+    Direction Think(const SnakeGame& game);
+
+    // Think and queue the result
+    void Drive(SnakeGame& game) { game.QueueDirection(Think(game)); }
+
+    void SetNodeBudget(int nodeBudget) { m_nodeBudget = nodeBudget; }
+    int GetNodeBudget() const { return m_nodeBudget; }
+
+    // Cells expanded by the last Think call
+    int GetLastNodeCount() const { return m_lastNodeCount; }
+
+    static constexpr int c_defaultNodeBudget = 512;
+
+private:
+    // Resumable BFS from one root cell. Cells are labelled with their distance as
+    // they are discovered (body cells too, so the head and tail get a distance) but
+    // only free cells are expanded. Labels are epoch-stamped, so starting a new
+    // search does not clear the arrays.
+    class DistanceField
+    {
+    public:
+        DistanceField();
+
+        void Resize(size_t cellCount);
+        void Begin(int rootIndex);
+        void Clear() { m_active = false; }
+
+        // Expand up to `budget` cells; returns the number expanded
+        int Expand(const SnakeGame& game, int budget);
+
+        bool IsActive() const { return m_active; }
+        bool IsComplete() const { return m_queueHead == m_queueTail; }
+        bool IsLabelled(int index) const { return m_labelEpoch[static_cast<size_t>(index)] == m_epoch; }
+        int GetDistance(int index) const { return m_distance[static_cast<size_t>(index)]; }
+        int GetRoot() const { return m_root; }
+        int GetFreeCellCount() const { return static_cast<int>(m_queueTail); }
+        size_t GetCellCount() const { return m_distance.size(); }
+
+    private:
+        std::vector<uint32_t> m_labelEpoch;
+        std::vector<int> m_distance;
+        std::vector<int> m_queue;
+        size_t m_queueHead;
+        size_t m_queueTail;
+        uint32_t m_epoch;
+        int m_root;
+        bool m_active;
+    };
+
+    enum class Mode
+    {
+        Food,   // Building/following the food field
+        Tail,   // Food looked unsafe: chasing the tail
+    };
+
+    // Next direction downhill on the field from the head, if there is a free one
+    bool Descend(const SnakeGame& game, const DistanceField& field, Direction& outDir) const;
+
+    // Free neighbor with the most free neighbors (current direction on ties)
+    Direction SafestDirection(const SnakeGame& game) const;
+
+    // Where the food safety check is: walking the food field's path on a copy of
+    // the body, then flooding from the new head to see if it reaches the new tail
+    enum class SafetyCheck
+    {
+        Idle,
+        Walk,
+        Flood,
+    };
+
+    // Copy the body and start the safety check from the current head (the copy is
+    // not counted as nodes)
+    void BeginSafetyCheck(const SnakeGame& game);
+
+    // Run the safety check for up to `budget` nodes; sets m_foodSafety when it
+    // finishes and returns the nodes used
+    int ContinueSafetyCheck(const SnakeGame& game, int budget);
+
+    // False if the snake has left the path the safety check is walking (or grown
+    // differently) since the check began
+    bool IsOnCheckedPath(const SnakeGame& game, bool moved);
+
+    void BeginFoodSearch(const SnakeGame& game);
+    void BeginTailSearch(const SnakeGame& game);
+
+    int m_nodeBudget;
+    int m_lastNodeCount;
+
+    DistanceField m_foodField;
+    DistanceField m_tailField;
+    Mode m_mode;
+    int m_foodSafety;  // -1 undecided, 0 unsafe, 1 safe (for the current food field)
+    GridCell m_foodCell;  // Food the food field was built for
+    bool m_foodAlive;
+    GridCell m_lastHead;
+    int m_tailSteps;  // Steps taken in Tail mode since the food field was last tried
+
+    // Safety check: the virtual body as cell indices from tail
+    // (m_virtualBody[m_virtualTail]) to head (m_virtualBody[m_virtualHead - 1]),
+    // a cell's slot is occupied while its stamp equals m_virtualEpoch, and the
+    // flood's queue and visited stamps
+    SafetyCheck m_check;
+    std::vector<int> m_virtualBody;
+    std::vector<uint32_t> m_virtualOccupied;
+    std::vector<uint32_t> m_floodVisited;
+    std::vector<int> m_floodQueue;
+    uint32_t m_virtualEpoch;
+    size_t m_virtualTail;
+    size_t m_virtualHead;
+    size_t m_floodHead;
+    size_t m_floodTail;
+    GridCell m_walkCell;  // Head of the virtual body while walking
+    Direction m_walkDirection;
+    int m_walkGrowth;  // Pending growth of the virtual body
+    size_t m_pathStart;  // m_virtualBody slot of the head the check started from
+    size_t m_checkSteps;  // Steps the real snake has taken along the path since
+    int m_checkSize;  // Length plus pending growth when the check started
+
+    // Steps of tail chasing before the food is tried again
+    static constexpr int c_tailRetrySteps = 8;
+};
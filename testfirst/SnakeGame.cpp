@@ -5,51 +5,141 @@
 
 #include "pch.h"
 #include "SnakeGame.h"
-#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
 
-using namespace DirectX;
+namespace
+{
+    // True when next (adjacent to head) carries on in the direction the run from
+    // corner to head goes
+    bool ContinuesRun(GridCell next, GridCell head, GridCell corner)
+    {
+        auto sign = [](int value) { return (value > 0) - (value < 0); };
+        return next.x - head.x == sign(head.x - corner.x) && next.y - head.y == sign(head.y - corner.y);
+    }
+
+    bool IsValidDirection(Direction dir)
+    {
+        return static_cast<unsigned>(dir) <= static_cast<unsigned>(Direction::Right);
+    }
+}
+
+SnakeBoardLayout SnakeBoardLayout::FromScreen(int screenWidth, int screenHeight)
+{
+    return FromScreen(screenWidth, screenHeight, SnakeGame::c_spawnMargin);
+}
+
+SnakeBoardLayout SnakeBoardLayout::FromScreen(int screenWidth, int screenHeight, float spawnMargin)
+{
+    const float cellSize = SnakeGame::c_cellSize;
+    const float margin = spawnMargin;
+
+    SnakeBoardLayout layout = {};
+
+    // One cell per c_cellSize square whose center lies inside the screen
+    layout.gridWidth = std::max(1, static_cast<int>(ceilf((static_cast<float>(screenWidth) - cellSize * 0.5f) / cellSize)));
+    layout.gridHeight = std::max(1, static_cast<int>(ceilf((static_cast<float>(screenHeight) - cellSize * 0.5f) / cellSize)));
+
+    // Food spawns inside a margin from the screen edges
+    layout.spawnMinCellX = static_cast<int>(ceilf(margin / cellSize));
+    layout.spawnMaxCellX = std::min(static_cast<int>(floorf((static_cast<float>(screenWidth) - margin) / cellSize)), layout.gridWidth - 1);
+    layout.spawnMinCellY = static_cast<int>(ceilf(margin / cellSize));
+    layout.spawnMaxCellY = std::min(static_cast<int>(floorf((static_cast<float>(screenHeight) - margin) / cellSize)), layout.gridHeight - 1);
+    if (layout.spawnMinCellX > layout.spawnMaxCellX || layout.spawnMinCellY > layout.spawnMaxCellY)
+    {
+        // Screen too small for the margin - allow the whole grid
+        layout.spawnMinCellX = 0;
+        layout.spawnMaxCellX = layout.gridWidth - 1;
+        layout.spawnMinCellY = 0;
+        layout.spawnMaxCellY = layout.gridHeight - 1;
+    }
+
+    // Snake starts in the center
+    layout.start.x = static_cast<int16_t>(floorf(static_cast<float>(screenWidth) * 0.5f / cellSize));
+    layout.start.y = static_cast<int16_t>(floorf(static_cast<float>(screenHeight) * 0.5f / cellSize));
+
+    return layout;
+}
 
 SnakeGame::SnakeGame()
-    : m_direction(Direction::Right)
-    , m_nextDirection(Direction::Right)
-    , m_moveAccumulator(0.0f)
+    : m_bodyMask(0)
+    , m_bodyHead(0)
+    , m_length(0)
+    , m_cornerHead(0)
+    , m_cornerCount(0)
+    , m_direction(Direction::Right)
+    , m_tick(0)
+    , m_turnLatency{ 0, 0, 0 }
+    , m_previousTail{ 0, 0 }
+    , m_hasStepped(false)
+    , m_moveAccumulator(0)
     , m_score(0)
+    , m_pendingGrowth(0)
     , m_gameOver(false)
-    , m_screenWidth(800)
-    , m_screenHeight(600)
+    , m_won(false)
+    , m_layout()
 {
+    m_food.cell = GridCell{ 0, 0 };
     m_food.alive = false;
-    srand(static_cast<unsigned int>(time(nullptr)));
 }
 
-void SnakeGame::Reset(int screenWidth, int screenHeight)
+void SnakeGame::Reset(int screenWidth, int screenHeight, uint64_t seed)
 {
-    m_screenWidth = screenWidth;
-    m_screenHeight = screenHeight;
+    m_random.Seed(seed);
     m_score = 0;
-    m_moveAccumulator = 0.0f;
+    m_moveAccumulator = 0;
     m_direction = Direction::Right;
-    m_nextDirection = Direction::Right;
+    m_directionQueue.Clear();
+    m_tick = 0;
+    m_turnLatency = TurnLatencyStats{ 0, 0, 0 };
+    m_hasStepped = false;
+    m_pendingGrowth = 0;
     m_gameOver = false;
+    m_won = false;
 
-    // Clear snake and initialize with initial length
-    m_snake.clear();
+    m_layout = SnakeBoardLayout::FromScreen(screenWidth, screenHeight, m_settings.spawnMargin);
+    const size_t cellCount = static_cast<size_t>(m_layout.CellCount());
+    m_occupancy.assign((cellCount + 63) / 64, 0);
 
-    // Start snake in center, facing right
-    float startX = static_cast<float>(screenWidth) * 0.5f;
-    float startY = static_cast<float>(screenHeight) * 0.5f;
-
-    // Align to grid
-    startX = floorf(startX / c_cellSize) * c_cellSize + c_cellSize * 0.5f;
-    startY = floorf(startY / c_cellSize) * c_cellSize + c_cellSize * 0.5f;
+    // The body can never be longer than the board, so size the ring once here
+    size_t capacity = 1;
+    while (capacity < cellCount)
+    {
+        capacity <<= 1;
+    }
+    if (m_body.size() != capacity)
+    {
+        m_body.assign(capacity, GridCell{ 0, 0 });
+        m_corners.assign(capacity, GridCell{ 0, 0 });
+    }
+    m_bodyMask = static_cast<uint32_t>(capacity - 1);
+    m_bodyHead = 0;
+    m_length = 0;
+    m_cornerHead = 0;
+    m_cornerCount = 0;
+
+    // Every spawn-area cell starts out free
+    m_freeSlot.assign(cellCount, -1);
+    m_freeCells.clear();
+    m_freeCells.reserve(GetSpawnCellCount());
+    for (int cellY = m_layout.spawnMinCellY; cellY <= m_layout.spawnMaxCellY; ++cellY)
+    {
+        for (int cellX = m_layout.spawnMinCellX; cellX <= m_layout.spawnMaxCellX; ++cellX)
+        {
+            const int index = cellY * m_layout.gridWidth + cellX;
+            m_freeSlot[static_cast<size_t>(index)] = static_cast<int>(m_freeCells.size());
+            m_freeCells.push_back(index);
+        }
+    }
 
-    // Create initial snake (head + 2 segments, all in a row)
-    for (int i = 0; i < c_initialSnakeLength; ++i)
+    // Create initial snake (head + 2 segments, all in a row, facing right), pushing from the tail forward
+    for (int i = c_initialSnakeLength - 1; i >= 0; --i)
     {
-        XMFLOAT2 segment;
-        segment.x = startX - static_cast<float>(i) * c_cellSize;
-        segment.y = startY;
-        m_snake.push_back(segment);
+        const GridCell segment = { static_cast<int16_t>(m_layout.start.x - i), m_layout.start.y };
+        PushHead(segment);
+        OccupyCell(segment);
     }
 
     // Spawn initial food
@@ -57,49 +147,100 @@ void SnakeGame::Reset(int screenWidth, int screenHeight)
     SpawnFoodNotOnSnake();
 }
 
-void SnakeGame::QueueDirection(Direction dir)
+bool SnakeGame::QueueDirection(Direction dir)
 {
-    // Prevent 180-degree turn
-    if ((m_direction == Direction::Up && dir != Direction::Down) ||
-        (m_direction == Direction::Down && dir != Direction::Up) ||
-        (m_direction == Direction::Left && dir != Direction::Right) ||
-        (m_direction == Direction::Right && dir != Direction::Left))
-    {
-        m_nextDirection = dir;
-    }
+    return m_directionQueue.Push(m_direction, dir, m_tick);
+}
+
+void SnakeGame::Grow(int segments)
+{
+    if (segments > 0)
+        m_pendingGrowth += segments;
 }
 
-SnakeGameEvents SnakeGame::Update(float elapsedTime)
+uint64_t SnakeGame::GetMoveIntervalTicks() const
+{
+    // Never below one tick, so a step always consumes time
+    const uint64_t minimum = std::max<uint64_t>(1, std::min(m_settings.minMoveIntervalTicks, m_settings.moveIntervalTicks));
+    const uint64_t speedUp = m_settings.speedUpTicksPerFood * static_cast<uint64_t>(m_score);
+    return (m_settings.moveIntervalTicks > minimum + speedUp) ? m_settings.moveIntervalTicks - speedUp : minimum;
+}
+
+float SnakeGame::GetInterpolationAlpha() const
+{
+    const uint64_t interval = GetMoveIntervalTicks();
+    if (m_moveAccumulator >= interval)
+        return 1.0f;
+    return static_cast<float>(m_moveAccumulator) / static_cast<float>(interval);
+}
+
+SnakeGameEvents SnakeGame::UpdateTicks(uint64_t elapsedTicks)
 {
     SnakeGameEvents events = {};
     events.ateFood = false;
+    events.foodEaten = 0;
+    events.steps = 0;
     events.gameOver = false;
+    events.won = false;
+    m_events.Clear();
 
-    if (m_gameOver || m_snake.empty())
-        return events;
+    const uint64_t frameStartTick = m_tick;
+    m_tick += elapsedTicks;
 
-    // Update direction from queued direction
-    m_direction = m_nextDirection;
+    if (m_gameOver || m_won || m_length == 0)
+        return events;
 
-    // Accumulate time for discrete movement
-    m_moveAccumulator += elapsedTime;
+    // Accumulate ticks for discrete movement (integer, so nothing drifts however
+    // the frames are cut)
+    m_moveAccumulator += elapsedTicks;
 
-    // Move snake when accumulator reaches move interval
-    while (m_moveAccumulator >= c_moveInterval)
+    // Move snake when accumulator reaches move interval (re-read every step, as
+    // eating can speed the snake up)
+    uint64_t interval = GetMoveIntervalTicks();
+    while (m_moveAccumulator >= interval && events.steps < c_maxStepsPerUpdate)
     {
-        // Store food position before move (in case we eat it)
-        XMFLOAT2 foodPosBeforeMove = m_food.pos;
+        // The step happened when the accumulator crossed the interval
+        const uint64_t stepTick = (elapsedTicks + interval > m_moveAccumulator) ? elapsedTicks + interval - m_moveAccumulator : 0;
+        const float stepTime = static_cast<float>(TicksToSeconds(stepTick));
+        events.steps++;
+
+        // Each step takes the next queued turn (validated against the direction
+        // before it when it was queued)
+        QueuedDirection turn;
+        if (m_directionQueue.Pop(turn))
+        {
+            m_direction = turn.dir;
+
+            const uint64_t latency = frameStartTick + stepTick - turn.tick;
+            m_turnLatency.turns++;
+            m_turnLatency.totalTicks += latency;
+            m_turnLatency.maxTicks = std::max(m_turnLatency.maxTicks, latency);
+        }
+
+        // Store food cell before move (in case we eat it)
+        const GridCell foodCellBeforeMove = m_food.cell;
 
         // Move snake and check if food was eaten
-        bool ateFood = MoveSnakeOneStep();
+        bool ateFood = MoveSnakeOneStep(stepTime);
 
         // Check if we ate food
         if (ateFood)
         {
             events.ateFood = true;
-            events.foodPos = foodPosBeforeMove;
+            events.foodCell = foodCellBeforeMove;
+            events.foodEaten++;
             // Spawn new food after detecting the event
             SpawnFoodNotOnSnake();
+
+            // No free cell left for food - the board is full
+            if (m_won)
+            {
+                m_events.Push(SnakeEventType::Won, GetHead(), stepTime);
+                events.won = true;
+                break;
+            }
+
+            m_events.Push(SnakeEventType::SpawnedFood, m_food.cell, stepTime);
         }
 
         // Check if game over
@@ -109,34 +250,193 @@ SnakeGameEvents SnakeGame::Update(float elapsedTime)
             break;
         }
 
-        m_moveAccumulator -= c_moveInterval;
+        m_moveAccumulator -= interval;
+        interval = GetMoveIntervalTicks();
     }
 
     return events;
 }
 
-bool SnakeGame::MoveSnakeOneStep()
+size_t SnakeGame::GetStateSize() const
 {
-    if (m_snake.empty() || m_gameOver)
+    const size_t cellCount = static_cast<size_t>(m_layout.CellCount());
+    return sizeof(StateHeader)
+        + m_occupancy.size() * sizeof(uint64_t)
+        + cellCount * sizeof(int)  // Free-cell slots
+        + GetSpawnCellCount() * sizeof(int)  // Free-cell list (at most the spawn area)
+        + cellCount * sizeof(GridCell);  // Body (at most the board)
+}
+
+void SnakeGame::SaveState(void* buffer, size_t bufferSize) const
+{
+    if (bufferSize < GetStateSize())
+        throw std::invalid_argument("SnakeGame::SaveState: buffer too small");
+
+    // Zeroed first so padding bytes are stable (equal states give equal snapshots)
+    StateHeader header;
+    memset(&header, 0, sizeof(header));
+    header.layout = m_layout;
+    header.randomState = m_random.GetState();
+    header.length = static_cast<uint32_t>(m_length);
+    header.freeCellCount = static_cast<uint32_t>(m_freeCells.size());
+    header.moveAccumulator = m_moveAccumulator;
+    header.score = m_score;
+    header.pendingGrowth = m_pendingGrowth;
+    header.foodCell = m_food.cell;
+    header.foodAlive = m_food.alive;
+    header.previousTail = m_previousTail;
+    header.hasStepped = m_hasStepped;
+    header.tick = m_tick;
+    header.direction = m_direction;
+    header.queuedCount = static_cast<uint32_t>(m_directionQueue.GetCount());
+    for (size_t i = 0; i < m_directionQueue.GetCount(); ++i)
+    {
+        header.queuedDirections[i] = m_directionQueue[i].dir;
+        header.queuedTicks[i] = m_directionQueue[i].tick;
+    }
+    header.gameOver = m_gameOver;
+    header.won = m_won;
+
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    memcpy(out, m_occupancy.data(), m_occupancy.size() * sizeof(uint64_t));
+    out += m_occupancy.size() * sizeof(uint64_t);
+    memcpy(out, m_freeSlot.data(), m_freeSlot.size() * sizeof(int));
+    out += m_freeSlot.size() * sizeof(int);
+    memcpy(out, m_freeCells.data(), m_freeCells.size() * sizeof(int));
+    out += GetSpawnCellCount() * sizeof(int);
+
+    // Body unrolled from the head, in at most two runs of the ring
+    const size_t firstRun = std::min(m_length, m_body.size() - m_bodyHead);
+    memcpy(out, &m_body[m_bodyHead], firstRun * sizeof(GridCell));
+    memcpy(out + firstRun * sizeof(GridCell), m_body.data(), (m_length - firstRun) * sizeof(GridCell));
+}
+
+bool SnakeGame::LoadState(const void* buffer, size_t bufferSize)
+{
+    if (buffer == nullptr || bufferSize != GetStateSize())
         return false;
 
-    // Calculate next head position based on direction
-    XMFLOAT2 head = m_snake.front();
-    XMFLOAT2 nextHead = head;
+    StateHeader header;
+    const uint8_t* in = static_cast<const uint8_t*>(buffer);
+    memcpy(&header, in, sizeof(header));
+    in += sizeof(header);
+
+    // Everything below indexes the ring, the queue or the board with counts and
+    // cells from the buffer, so check them all before any state changes
+    const size_t cellCount = static_cast<size_t>(m_layout.CellCount());
+    const size_t spawnCellCount = GetSpawnCellCount();
+    if (memcmp(&header.layout, &m_layout, sizeof(m_layout)) != 0
+        || header.length == 0 || header.length > cellCount
+        || header.queuedCount > DirectionQueue::c_capacity
+        || header.freeCellCount > spawnCellCount
+        || header.pendingGrowth < 0
+        || !IsValidDirection(header.direction))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.queuedCount; ++i)
+    {
+        if (!IsValidDirection(header.queuedDirections[i]))
+            return false;
+    }
+
+    auto onBoard = [this](GridCell cell)
+    {
+        return cell.x >= 0 && cell.x < m_layout.gridWidth && cell.y >= 0 && cell.y < m_layout.gridHeight;
+    };
+    if ((header.foodAlive && !onBoard(header.foodCell)) || (header.hasStepped && !onBoard(header.previousTail)))
+        return false;
+
+    const uint8_t* const occupancyIn = in;
+    const uint8_t* const freeSlotIn = occupancyIn + m_occupancy.size() * sizeof(uint64_t);
+    const uint8_t* const freeCellsIn = freeSlotIn + cellCount * sizeof(int);
+    const uint8_t* const bodyIn = freeCellsIn + spawnCellCount * sizeof(int);
+    for (size_t i = 0; i < cellCount; ++i)
+    {
+        int slot;
+        memcpy(&slot, freeSlotIn + i * sizeof(int), sizeof(int));
+        if (slot < -1 || slot >= static_cast<int>(header.freeCellCount))
+            return false;
+    }
+    for (size_t i = 0; i < header.freeCellCount; ++i)
+    {
+        int index;
+        memcpy(&index, freeCellsIn + i * sizeof(int), sizeof(int));
+        if (index < 0 || index >= static_cast<int>(cellCount))
+            return false;
+    }
+    for (size_t i = 0; i < header.length; ++i)
+    {
+        GridCell cell;
+        memcpy(&cell, bodyIn + i * sizeof(GridCell), sizeof(GridCell));
+        if (!onBoard(cell))
+            return false;
+    }
+
+    m_random.SetState(header.randomState);
+    m_length = header.length;
+    m_moveAccumulator = header.moveAccumulator;
+    m_score = header.score;
+    m_pendingGrowth = header.pendingGrowth;
+    m_food.cell = header.foodCell;
+    m_food.alive = header.foodAlive;
+    m_previousTail = header.previousTail;
+    m_hasStepped = header.hasStepped;
+    m_tick = header.tick;
+    m_direction = header.direction;
+    m_directionQueue.Clear();
+    for (uint32_t i = 0; i < header.queuedCount; ++i)
+    {
+        // Saved entries already passed the checks, so each push is kept
+        m_directionQueue.Push(i ? header.queuedDirections[i - 1] : m_direction, header.queuedDirections[i], header.queuedTicks[i]);
+    }
+    m_gameOver = header.gameOver;
+    m_won = header.won;
+
+    memcpy(m_occupancy.data(), in, m_occupancy.size() * sizeof(uint64_t));
+    in += m_occupancy.size() * sizeof(uint64_t);
+    memcpy(m_freeSlot.data(), in, m_freeSlot.size() * sizeof(int));
+    in += m_freeSlot.size() * sizeof(int);
+    m_freeCells.resize(header.freeCellCount);  // Within the capacity reserved by Reset
+    memcpy(m_freeCells.data(), in, m_freeCells.size() * sizeof(int));
+    in += GetSpawnCellCount() * sizeof(int);
+
+    m_bodyHead = 0;
+    memcpy(m_body.data(), in, m_length * sizeof(GridCell));
+    RebuildCorners();
+    return true;
+}
+
+size_t SnakeGame::GetSpawnCellCount() const
+{
+    return static_cast<size_t>(m_layout.spawnMaxCellX - m_layout.spawnMinCellX + 1) * static_cast<size_t>(m_layout.spawnMaxCellY - m_layout.spawnMinCellY + 1);
+}
+
+bool SnakeGame::MoveSnakeOneStep(float stepTime)
+{
+    if (m_length == 0 || m_gameOver)
+        return false;
+
+    // Calculate next head cell based on direction
+    const GridCell head = GetHead();
+    int nextX = head.x;
+    int nextY = head.y;
 
     switch (m_direction)
     {
     case Direction::Up:
-        nextHead.y -= c_cellSize;
+        nextY -= 1;
         break;
     case Direction::Down:
-        nextHead.y += c_cellSize;
+        nextY += 1;
         break;
     case Direction::Left:
-        nextHead.x -= c_cellSize;
+        nextX -= 1;
         break;
     case Direction::Right:
-        nextHead.x += c_cellSize;
+        nextX += 1;
         break;
     default:
         // Should never reach here, but ensure function returns
@@ -144,43 +444,51 @@ bool SnakeGame::MoveSnakeOneStep()
     }
 
     // Check boundary collision
-    if (nextHead.x < 0.0f || nextHead.x >= static_cast<float>(m_screenWidth) ||
-        nextHead.y < 0.0f || nextHead.y >= static_cast<float>(m_screenHeight))
+    const GridCell nextHead = { static_cast<int16_t>(nextX), static_cast<int16_t>(nextY) };
+    if (nextX < 0 || nextX >= m_layout.gridWidth || nextY < 0 || nextY >= m_layout.gridHeight)
     {
         // Hit boundary - game over
         m_gameOver = true;
+        m_events.Push(SnakeEventType::Died, nextHead, stepTime);
         return false;
     }
 
-    // Check self collision (compare with all body segments except head)
-    for (size_t i = 1; i < m_snake.size(); ++i)
+    // Check self collision (the tail still occupies its cell until it retracts below)
+    if (IsCellOccupied(CellIndex(nextHead)))
     {
-        const XMFLOAT2& segment = m_snake[i];
-        if (nextHead.x == segment.x && nextHead.y == segment.y)
-        {
-            // Hit self - game over
-            m_gameOver = true;
-            return false;
-        }
+        // Hit self - game over
+        m_gameOver = true;
+        m_events.Push(SnakeEventType::Died, nextHead, stepTime);
+        return false;
     }
 
-    // Move snake: add new head
-    m_snake.push_front(nextHead);
+    // Move snake: add new head (the tail stays put unless it retracts below)
+    m_previousTail = GetSegment(m_length - 1);
+    m_hasStepped = true;
+    PushHead(nextHead);
+    OccupyCell(nextHead);
+    m_events.Push(SnakeEventType::Moved, nextHead, stepTime);
 
-    // Check if food is eaten (head position matches food position)
+    // Check if food is eaten (head cell matches food cell)
     bool ateFood = false;
-    if (m_food.alive && nextHead.x == m_food.pos.x && nextHead.y == m_food.pos.y)
+    if (m_food.alive && nextHead == m_food.cell)
     {
         // Food eaten - grow snake (don't pop tail), increase score
         m_score++;
         m_food.alive = false; // Mark as eaten (will be respawned by Update)
         ateFood = true;
+        m_events.Push(SnakeEventType::AteFood, nextHead, stepTime);
         // Don't spawn new food here - let Update() handle it after detecting the event
     }
+    else if (m_pendingGrowth > 0)
+    {
+        // Growing - keep tail in place
+        m_pendingGrowth--;
+    }
     else
     {
         // Normal movement - remove tail
-        m_snake.pop_back();
+        ReleaseCell(PopTail());
     }
 
     return ateFood;
@@ -188,45 +496,106 @@ bool SnakeGame::MoveSnakeOneStep()
 
 void SnakeGame::SpawnFoodNotOnSnake()
 {
-    const float margin = 50.0f; // Margin from screen edges
-    const int minCellX = static_cast<int>(ceilf(margin / c_cellSize));
-    const int maxCellX = static_cast<int>(floorf((static_cast<float>(m_screenWidth) - margin) / c_cellSize));
-    const int minCellY = static_cast<int>(ceilf(margin / c_cellSize));
-    const int maxCellY = static_cast<int>(floorf((static_cast<float>(m_screenHeight) - margin) / c_cellSize));
+    if (m_freeCells.empty())
+    {
+        // Nowhere left to place food
+        m_food.alive = false;
+        m_won = true;
+        return;
+    }
 
-    // Try to find a valid position (not on snake)
-    const int maxAttempts = 100;
-    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    // Uniform draw from the free-cell set
+    const int index = m_freeCells[m_random.NextBelow(static_cast<uint32_t>(m_freeCells.size()))];
+    m_food.cell.x = static_cast<int16_t>(index % m_layout.gridWidth);
+    m_food.cell.y = static_cast<int16_t>(index / m_layout.gridWidth);
+    m_food.alive = true;
+}
+
+void SnakeGame::PushHead(GridCell cell)
+{
+    m_bodyHead = (m_bodyHead - 1) & m_bodyMask;
+    m_body[m_bodyHead] = cell;
+    m_length++;
+
+    // Straight on moves the head corner along; a turn leaves the old head as a corner
+    if (m_cornerCount >= 2 && ContinuesRun(cell, GetCorner(0), GetCorner(1)))
     {
-        int cellX = minCellX + (rand() % (maxCellX - minCellX + 1));
-        int cellY = minCellY + (rand() % (maxCellY - minCellY + 1));
+        m_corners[m_cornerHead] = cell;
+    }
+    else
+    {
+        m_cornerHead = (m_cornerHead - 1) & m_bodyMask;
+        m_corners[m_cornerHead] = cell;
+        m_cornerCount++;
+    }
+}
 
-        // Convert to pixel position (center of cell)
-        XMFLOAT2 foodPos;
-        foodPos.x = static_cast<float>(cellX) * c_cellSize + c_cellSize * 0.5f;
-        foodPos.y = static_cast<float>(cellY) * c_cellSize + c_cellSize * 0.5f;
+GridCell SnakeGame::PopTail()
+{
+    m_length--;
 
-        // Check if position is on snake
-        bool onSnake = false;
-        for (const auto& segment : m_snake)
+    // The tail corner follows the tail, and merges into the next corner on reaching it
+    if (m_length == 0)
+    {
+        m_cornerCount = 0;
+    }
+    else
+    {
+        const GridCell tail = GetSegment(m_length - 1);
+        if (m_cornerCount >= 2 && tail == GetCorner(m_cornerCount - 2))
         {
-            if (foodPos.x == segment.x && foodPos.y == segment.y)
-            {
-                onSnake = true;
-                break;
-            }
+            m_cornerCount--;
+        }
+        else
+        {
+            m_corners[(m_cornerHead + m_cornerCount - 1) & m_bodyMask] = tail;
         }
+    }
 
-        if (!onSnake)
+    return m_body[(m_bodyHead + m_length) & m_bodyMask];
+}
+
+void SnakeGame::RebuildCorners()
+{
+    m_cornerHead = 0;
+    m_cornerCount = 0;
+    for (size_t i = 0; i < m_length; ++i)
+    {
+        // Ends always; in between, cells where the direction changes
+        const GridCell cell = GetSegment(i);
+        if (i == 0 || i + 1 == m_length || !ContinuesRun(GetSegment(i - 1), cell, GetSegment(i + 1)))
         {
-            m_food.pos = foodPos;
-            m_food.alive = true;
-            return;
+            m_corners[m_cornerCount++] = cell;
         }
     }
+}
 
-    // Fallback: if we can't find a position after maxAttempts, place at a default location
-    m_food.pos.x = static_cast<float>(m_screenWidth) * 0.5f;
-    m_food.pos.y = static_cast<float>(m_screenHeight) * 0.5f;
-    m_food.alive = true;
+void SnakeGame::OccupyCell(GridCell cell)
+{
+    const int index = CellIndex(cell);
+    m_occupancy[static_cast<size_t>(index) >> 6] |= (1ULL << (index & 63));
+
+    // Swap-remove from the free-cell set
+    const int slot = m_freeSlot[static_cast<size_t>(index)];
+    if (slot >= 0)
+    {
+        const int lastIndex = m_freeCells.back();
+        m_freeCells[static_cast<size_t>(slot)] = lastIndex;
+        m_freeSlot[static_cast<size_t>(lastIndex)] = slot;
+        m_freeCells.pop_back();
+        m_freeSlot[static_cast<size_t>(index)] = -1;
+    }
+}
+
+void SnakeGame::ReleaseCell(GridCell cell)
+{
+    const int index = CellIndex(cell);
+    m_occupancy[static_cast<size_t>(index) >> 6] &= ~(1ULL << (index & 63));
+
+    // Cells outside the spawn area were never in the free-cell set
+    if (m_layout.IsInSpawnArea(cell.x, cell.y))
+    {
+        m_freeSlot[static_cast<size_t>(index)] = static_cast<int>(m_freeCells.size());
+        m_freeCells.push_back(index);
+    }
 }
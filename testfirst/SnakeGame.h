@@ -5,17 +5,11 @@
 
 #pragma once
 
-#include <deque>
+#include <array>
 #include <vector>
-#include <cstdlib>
-#include <ctime>
-#include <cmath>
+#include <cstdint>
 
-// Forward declarations
-namespace DirectX
-{
-    struct XMFLOAT2;
-}
+#include "Random.h"
 
 // Direction enumeration for snake movement
 enum class Direction
@@ -26,63 +20,389 @@ enum class Direction
     Right
 };
 
+// True if b points the opposite way to a (Up/Down and Left/Right differ only in
+// the low bit)
+inline bool IsReverse(Direction a, Direction b) { return (static_cast<int>(a) ^ static_cast<int>(b)) == 1; }
+
+// Direction change waiting in a DirectionQueue
+struct QueuedDirection
+{
+    Direction dir;
+    uint64_t tick;  // Game clock when it was queued (SnakeGame::GetTick)
+};
+
+// Bounded FIFO of direction changes; each movement step takes at most one.
+//
+// Every entry is checked against the direction the snake will be moving in when
+// it is taken (the previous entry, or the current direction if the queue is
+// empty): repeats and 180-degree reversals are dropped, and so is anything past
+// the capacity. Two quick taps within one step (Up then Left while moving Right)
+// become a U-turn over the next two steps instead of collapsing into one.
+class DirectionQueue
+{
+public:
+    static constexpr size_t c_capacity = 3;
+
+    DirectionQueue() : m_entries{}, m_count(0) {}
+
+    void Clear() { m_count = 0; }
+
+    // Queue dir behind the pending entries (current: the direction the snake is
+    // moving in now); false if it was dropped
+    bool Push(Direction current, Direction dir, uint64_t tick)
+    {
+        const Direction last = m_count ? m_entries[m_count - 1].dir : current;
+        if (m_count == c_capacity || dir == last || IsReverse(last, dir))
+            return false;
+
+        m_entries[m_count++] = QueuedDirection{ dir, tick };
+        return true;
+    }
+
+    // Take the oldest entry; false if the queue is empty
+    bool Pop(QueuedDirection& entry)
+    {
+        if (m_count == 0)
+            return false;
+
+        entry = m_entries[0];
+        m_count--;
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            m_entries[i] = m_entries[i + 1];
+        }
+        return true;
+    }
+
+    size_t GetCount() const { return m_count; }
+    const QueuedDirection& operator[](size_t index) const { return m_entries[index]; }
+
+private:
+    std::array<QueuedDirection, c_capacity> m_entries;
+    size_t m_count;
+};
+
+// Input-to-move latency of the queued turns a SnakeGame has taken since Reset
+struct TurnLatencyStats
+{
+    uint64_t turns;       // Queued directions taken by a step
+    uint64_t totalTicks;  // Sum over those turns of (step tick - queued tick)
+    uint64_t maxTicks;    // Longest single wait
+};
+
+// Grid cell coordinates (packed 16+16 bits)
+struct GridCell
+{
+    int16_t x;
+    int16_t y;
+};
+
+inline bool operator==(GridCell a, GridCell b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(GridCell a, GridCell b) { return !(a == b); }
+
 // Food structure
 struct Food
 {
-    DirectX::XMFLOAT2 pos;  // Position (grid-aligned)
-    bool alive;             // Always true for food
+    GridCell cell;  // Cell the food occupies
+    bool alive;     // False only while respawning or once the board is full
 };
 
-// Game events returned from Update
+// Game events returned from Update (totals for the whole frame; the individual
+// steps are in SnakeGame::GetEvents)
 struct SnakeGameEvents
 {
     bool ateFood;           // True if food was eaten this frame
-    DirectX::XMFLOAT2 foodPos; // Position where food was eaten (if ateFood is true)
+    GridCell foodCell;      // Cell where food was last eaten (if ateFood is true)
+    int foodEaten;          // Food eaten this frame (can be more than one when catching up)
+    int steps;              // Movement steps taken this frame (including a fatal one)
     bool gameOver;          // True if game over occurred this frame
+    bool won;               // True if the board filled up this frame (no cell left for food)
+};
+
+// Step-level event recorded by SnakeGame::Update
+enum class SnakeEventType : uint8_t
+{
+    Moved,        // Head moved into `cell`
+    AteFood,      // Food at `cell` was eaten
+    SpawnedFood,  // New food appeared at `cell`
+    Died,         // Head hit a wall or the body moving into `cell` (may be off the board)
+    Won,          // Board is full (`cell` is the head)
+};
+
+struct SnakeEvent
+{
+    SnakeEventType type;
+    GridCell cell;
+    float time;  // Seconds into the Update call at which the step happened
+};
+
+// Fixed-capacity list of the events from one SnakeGame::Update, in step order.
+// Storage is inline, so recording never allocates. SnakeGame takes at most
+// c_capacity / c_maxEventsPerStep steps per Update, so the buffer never fills;
+// events past the capacity would be counted but not stored.
+class SnakeEventBuffer
+{
+public:
+    static constexpr size_t c_capacity = 1024;
+    static constexpr size_t c_maxEventsPerStep = 3;  // Moved, AteFood, SpawnedFood or Won
+
+    SnakeEventBuffer() : m_count(0), m_dropped(0) {}
+
+    void Clear()
+    {
+        m_count = 0;
+        m_dropped = 0;
+    }
+
+    void Push(SnakeEventType type, GridCell cell, float time)
+    {
+        if (m_count < c_capacity)
+            m_events[m_count++] = SnakeEvent{ type, cell, time };
+        else
+            m_dropped++;
+    }
+
+    size_t GetCount() const { return m_count; }
+    size_t GetDroppedCount() const { return m_dropped; }
+    const SnakeEvent& operator[](size_t index) const { return m_events[index]; }
+    const SnakeEvent* begin() const { return m_events.data(); }
+    const SnakeEvent* end() const { return m_events.data() + m_count; }
+
+private:
+    std::array<SnakeEvent, c_capacity> m_events;
+    size_t m_count;
+    size_t m_dropped;
+};
+
+// Board geometry derived from the screen size (shared by SnakeGame and SnakeWorldBatch)
+struct SnakeBoardLayout
+{
+    int gridWidth;
+    int gridHeight;
+
+    // Food spawn area (inclusive cell range)
+    int spawnMinCellX;
+    int spawnMaxCellX;
+    int spawnMinCellY;
+    int spawnMaxCellY;
+
+    GridCell start;  // Initial head cell
+
+    // Board for a screen size in pixels (spawn margin in pixels, SnakeGame::c_spawnMargin by default)
+    static SnakeBoardLayout FromScreen(int screenWidth, int screenHeight);
+    static SnakeBoardLayout FromScreen(int screenWidth, int screenHeight, float spawnMargin);
+
+    int CellCount() const { return gridWidth * gridHeight; }
+    int CellIndex(GridCell cell) const { return static_cast<int>(cell.y) * gridWidth + static_cast<int>(cell.x); }
+    bool IsInSpawnArea(int cellX, int cellY) const
+    {
+        return cellX >= spawnMinCellX && cellX <= spawnMaxCellX && cellY >= spawnMinCellY && cellY <= spawnMaxCellY;
+    }
 };
 
 // Pure gameplay logic for snake game
+//
+// Everything is in integer cell coordinates; callers convert to pixels with
+// c_cellSize when drawing. The body lives in a ring buffer sized to the board at
+// Reset, so moving never allocates. A second ring keeps the body's corners (see
+// GetCorner), so it can also be walked as straight runs.
 class SnakeGame
 {
 public:
     SnakeGame();
     ~SnakeGame() = default;
 
-    // Reset game state
-    void Reset(int screenWidth, int screenHeight);
+    // Reset game state (screen size in pixels, divided into c_cellSize cells).
+    // The same seed and the same Update/QueueDirection calls replay the same game.
+    void Reset(int screenWidth, int screenHeight, uint64_t seed);
+
+    // Queue a direction change for a later step, stamped with GetTick() (see
+    // DirectionQueue: repeats, 180-degree turns and overflow are dropped); false if
+    // it was dropped
+    bool QueueDirection(Direction dir);
+
+    // Grow the snake by the given number of segments over the next moves
+    // (the tail is held in place instead of retracting)
+    void Grow(int segments);
+
+    // Update game logic by a number of timer ticks (c_ticksPerSecond per second;
+    // returns the frame totals, GetEvents has every step). Movement is clocked in
+    // whole ticks, so step timing is exact at any frame rate. At most
+    // c_maxStepsPerUpdate steps are taken per call (so every event fits in
+    // GetEvents); steps past that stay due and are taken by the next calls.
+    SnakeGameEvents UpdateTicks(uint64_t elapsedTicks);
 
-    // Queue a direction change (prevents 180-degree turns)
-    void QueueDirection(Direction dir);
+    // Same, in seconds (rounded to the nearest tick)
+    SnakeGameEvents Update(float elapsedTime) { return UpdateTicks(SecondsToTicks(elapsedTime)); }
 
-    // Update game logic (returns events)
-    SnakeGameEvents Update(float elapsedTime);
+    // Events from the last Update call (cleared at the start of each Update)
+    const SnakeEventBuffer& GetEvents() const { return m_events; }
 
     // Getters
-    const std::deque<DirectX::XMFLOAT2>& GetSnakeSegments() const { return m_snake; }
+    GridCell GetSegment(size_t index) const { return m_body[(m_bodyHead + index) & m_bodyMask]; }  // 0 = head
+    GridCell GetHead() const { return GetSegment(0); }
     const Food& GetFood() const { return m_food; }
     int GetScore() const { return m_score; }
-    size_t GetLength() const { return m_snake.size(); }
+    int GetPendingGrowth() const { return m_pendingGrowth; }  // Segments Grow() has still to add
+    size_t GetLength() const { return m_length; }
+    int GetGridWidth() const { return m_layout.gridWidth; }
+    int GetGridHeight() const { return m_layout.gridHeight; }
+    const SnakeBoardLayout& GetLayout() const { return m_layout; }
     bool IsGameOver() const { return m_gameOver; }
+    bool IsWon() const { return m_won; }
+    Direction GetDirection() const { return m_direction; }
+    const DirectionQueue& GetQueuedDirections() const { return m_directionQueue; }
+    bool IsOccupied(GridCell cell) const { return IsCellOccupied(CellIndex(cell)); }  // Cell must be on the board
 
-private:
-    bool MoveSnakeOneStep();  // Returns true if food was eaten
-    void SpawnFoodNotOnSnake();
+    // Game clock: ticks passed to UpdateTicks since Reset
+    uint64_t GetTick() const { return m_tick; }
+
+    // How long queued directions waited for their step (measurement only: not part
+    // of the saved state, so a rollback counts resimulated turns again)
+    const TurnLatencyStats& GetTurnLatency() const { return m_turnLatency; }
+
+    // Ticks per move at the current score (see Settings)
+    uint64_t GetMoveIntervalTicks() const;
+
+    // Render interpolation between the last two movement steps. Segments never move
+    // on the grid (the head is pushed, the tail popped), so segment i's cell before
+    // the last step is segment i + 1's cell now, and the tail's is the cell it just
+    // vacated: the previous step costs one extra cell, not a copy of the body.
+    // Draw segment i at lerp(GetPreviousSegment(i), GetSegment(i), alpha).
+    GridCell GetPreviousSegment(size_t index) const
+    {
+        if (!m_hasStepped)
+            return GetSegment(index);
+        return (index + 1 < m_length) ? GetSegment(index + 1) : m_previousTail;
+    }
+
+    // The body as straight runs: corner 0 is the head, the last corner is the tail
+    // and every corner between is a cell where the body turns, so each run goes
+    // from GetCorner(i) to GetCorner(i + 1). Kept up to date as the head advances
+    // and the tail retracts (O(1) per step), so there are O(turns) of them.
+    size_t GetCornerCount() const { return m_cornerCount; }
+    GridCell GetCorner(size_t index) const { return m_corners[(m_cornerHead + index) & m_bodyMask]; }
+
+    // Progress towards the next step in [0, 1] (from the move accumulator)
+    float GetInterpolationAlpha() const;
+
+    // Snapshots for rollback. The state is a handful of flat arrays, so a snapshot
+    // is a few memcpy calls into a caller-provided buffer of GetStateSize() bytes;
+    // the size only depends on the board, so buffers can be allocated once after
+    // Reset and reused. Neither call allocates. LoadState takes exactly
+    // GetStateSize() bytes of a snapshot of the same board and checks every count
+    // and cell in it against the board; it returns false, leaving the game as it
+    // was, for anything else (truncated, corrupt or another board's). Settings are
+    // not part of the state.
+    size_t GetStateSize() const;
+    void SaveState(void* buffer, size_t bufferSize) const;
+    bool LoadState(const void* buffer, size_t bufferSize);
 
     // Game constants
     static constexpr float c_cellSize = 20.0f;  // Grid cell size in pixels
     static constexpr float c_moveInterval = 0.10f;  // Time between moves (10 cells/second)
+    static constexpr uint64_t c_ticksPerSecond = 10000000;  // Same clock as DX::StepTimer
+    static constexpr uint64_t c_moveIntervalTicks = c_ticksPerSecond / 10;  // c_moveInterval in ticks
     static constexpr int c_initialSnakeLength = 3;  // Initial snake length (head + 2 segments)
+    static constexpr float c_spawnMargin = 50.0f;  // Food keeps this far from the screen edges (pixels)
+    static constexpr int c_maxStepsPerUpdate = static_cast<int>(SnakeEventBuffer::c_capacity / SnakeEventBuffer::c_maxEventsPerStep);
+
+    // Tunable rules (defaults are the constants above). The move interval shrinks by
+    // speedUpTicksPerFood for every food eaten, down to minMoveIntervalTicks.
+    struct Settings
+    {
+        uint64_t moveIntervalTicks = c_moveIntervalTicks;  // Ticks per move (takes effect immediately)
+        uint64_t speedUpTicksPerFood = 0;  // 0 keeps a constant speed
+        uint64_t minMoveIntervalTicks = c_moveIntervalTicks / 4;
+        float spawnMargin = c_spawnMargin;  // Pixels (takes effect at the next Reset)
+    };
+
+    void SetSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Timer tick conversions (rounded to the nearest tick)
+    static constexpr uint64_t SecondsToTicks(double seconds) { return static_cast<uint64_t>(seconds * static_cast<double>(c_ticksPerSecond) + 0.5); }
+    static constexpr double TicksToSeconds(uint64_t ticks) { return static_cast<double>(ticks) / static_cast<double>(c_ticksPerSecond); }
+
+private:
+    bool MoveSnakeOneStep(float stepTime);  // Returns true if food was eaten
+    void SpawnFoodNotOnSnake();
+
+    // Body ring buffer (head at m_bodyHead, segments follow towards the tail);
+    // both keep the corner ring in step
+    void PushHead(GridCell cell);
+    GridCell PopTail();
+
+    // Corner ring from the body, e.g. after LoadState (O(length))
+    void RebuildCorners();
+
+    // Occupancy grid helpers (one bit per cell, set while a segment covers it)
+    int CellIndex(GridCell cell) const { return m_layout.CellIndex(cell); }
+    bool IsCellOccupied(int index) const { return (m_occupancy[static_cast<size_t>(index) >> 6] >> (index & 63)) & 1ULL; }
+
+    // Mark a cell as covered/uncovered, keeping the bitmap and free-cell set in sync
+    void OccupyCell(GridCell cell);
+    void ReleaseCell(GridCell cell);
+
+    // Fixed part of a snapshot (followed by the occupancy words, the free-cell slots,
+    // the free-cell list and the body from head to tail)
+    struct StateHeader
+    {
+        SnakeBoardLayout layout;  // Checked on load
+        uint64_t randomState;
+        uint32_t length;
+        uint32_t freeCellCount;
+        uint64_t moveAccumulator;
+        int32_t score;
+        int32_t pendingGrowth;
+        uint64_t tick;
+        uint64_t queuedTicks[DirectionQueue::c_capacity];
+        uint32_t queuedCount;
+        GridCell foodCell;
+        GridCell previousTail;
+        Direction direction;
+        Direction queuedDirections[DirectionQueue::c_capacity];
+        bool foodAlive;
+        bool hasStepped;
+        bool gameOver;
+        bool won;
+    };
+
+    size_t GetSpawnCellCount() const;
 
     // Game state
-    std::deque<DirectX::XMFLOAT2> m_snake;  // Snake body segments (grid-aligned positions)
+    std::vector<GridCell> m_body;  // Ring buffer, power-of-two capacity >= cell count
+    uint32_t m_bodyMask;  // Capacity - 1
+    uint32_t m_bodyHead;  // Slot of the head segment
+    size_t m_length;  // Number of segments
+    std::vector<GridCell> m_corners;  // Ring buffer of GetCorner (same capacity and mask as m_body)
+    uint32_t m_cornerHead;  // Slot of corner 0 (the head)
+    uint32_t m_cornerCount;
     Direction m_direction;  // Current movement direction
-    Direction m_nextDirection;  // Queued direction (prevents 180-degree turns)
-    float m_moveAccumulator;  // Accumulated time for discrete movement
+    DirectionQueue m_directionQueue;  // Turns for the next steps, one per step
+    uint64_t m_tick;  // Game clock (ticks since Reset)
+    TurnLatencyStats m_turnLatency;
+    GridCell m_previousTail;  // Tail cell before the last step (for interpolation)
+    bool m_hasStepped;  // False until the first step after Reset
+    uint64_t m_moveAccumulator;  // Accumulated ticks for discrete movement
     Food m_food;  // Single food item
     int m_score;
+    int m_pendingGrowth;  // Segments still to be added by Grow()
     bool m_gameOver;
+    bool m_won;
+    Pcg32 m_random;  // Food placement (seeded by Reset)
+    SnakeEventBuffer m_events;  // Events from the last Update (not part of the saved state)
+
+    // Board geometry and rules
+    SnakeBoardLayout m_layout;
+    Settings m_settings;
+
+    // Occupancy grid (packed bitmap, kept in sync with the body)
+    std::vector<uint64_t> m_occupancy;
 
-    // Screen bounds
-    int m_screenWidth;
-    int m_screenHeight;
+    // Free-cell set over the food spawn area: dense list of free cell indices plus
+    // each cell's slot in that list (-1 when occupied or outside the spawn area).
+    // Occupy/release are swap-removes, so spawning is one uniform draw.
+    std::vector<int> m_freeCells;
+    std::vector<int> m_freeSlot;
 };
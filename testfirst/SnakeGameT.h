@@ -0,0 +1,380 @@
+//
+// SnakeGameT.h
+// SnakeGame specialized at compile time for a fixed board size
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "SnakeGame.h"
+
+// The SnakeGame rules for a Width x Height cell board known at compile time.
+//
+// Storage is std::array sized from the board (occupancy bitmap, body ring, free-cell
+// set), so a game is one flat object with no pointers to chase, and the bounds
+// checks and cell-index math fold to constants. Given the same seed, settings and
+// QueueDirection/Update calls it plays exactly the same game as SnakeGame on a
+// Width * c_cellSize by Height * c_cellSize screen. It covers the simulation only:
+// Update returns the frame totals but keeps no per-step event list, and there is
+// no interpolation or SaveState. Use SnakeGame for sessions and rendering.
+template<int Width, int Height>
+class SnakeGameT
+{
+public:
+    static_assert(Width > 0 && Height > 0, "board must have cells");
+    static_assert(Width <= INT16_MAX && Height <= INT16_MAX, "cells must fit GridCell");
+
+    static constexpr int c_gridWidth = Width;
+    static constexpr int c_gridHeight = Height;
+    static constexpr int c_cellCount = Width * Height;
+    static constexpr int c_screenWidth = Width * static_cast<int>(SnakeGame::c_cellSize);
+    static constexpr int c_screenHeight = Height * static_cast<int>(SnakeGame::c_cellSize);
+
+    SnakeGameT()
+        : m_bodyHead(0)
+        , m_length(0)
+        , m_freeCount(0)
+        , m_direction(Direction::Right)
+        , m_moveAccumulator(0)
+        , m_food{ GridCell{ 0, 0 }, false }
+        , m_score(0)
+        , m_pendingGrowth(0)
+        , m_gameOver(false)
+        , m_won(false)
+        , m_layout()
+    {
+    }
+
+    // Reset game state (see SnakeGame::Reset; the board size is fixed)
+    void Reset(uint64_t seed)
+    {
+        m_random.Seed(seed);
+        m_score = 0;
+        m_moveAccumulator = 0;
+        m_direction = Direction::Right;
+        m_directionQueue.Clear();
+        m_pendingGrowth = 0;
+        m_gameOver = false;
+        m_won = false;
+
+        // Only the spawn area and start cell depend on the settings
+        m_layout = SnakeBoardLayout::FromScreen(c_screenWidth, c_screenHeight, m_settings.spawnMargin);
+        m_occupancy.fill(0);
+        m_bodyHead = 0;
+        m_length = 0;
+
+        // Every spawn-area cell starts out free, in the same order as SnakeGame
+        m_freeSlot.fill(-1);
+        m_freeCount = 0;
+        for (int cellY = m_layout.spawnMinCellY; cellY <= m_layout.spawnMaxCellY; ++cellY)
+        {
+            for (int cellX = m_layout.spawnMinCellX; cellX <= m_layout.spawnMaxCellX; ++cellX)
+            {
+                const int index = CellIndex(cellX, cellY);
+                m_freeSlot[static_cast<size_t>(index)] = static_cast<int>(m_freeCount);
+                m_freeCells[m_freeCount++] = index;
+            }
+        }
+
+        for (int i = SnakeGame::c_initialSnakeLength - 1; i >= 0; --i)
+        {
+            const GridCell segment = { static_cast<int16_t>(m_layout.start.x - i), m_layout.start.y };
+            PushHead(segment);
+            OccupyCell(segment);
+        }
+
+        m_food.alive = true;
+        SpawnFoodNotOnSnake();
+    }
+
+    // Queue a direction change for a later step (see SnakeGame::QueueDirection;
+    // there is no game clock, so entries are not timestamped)
+    void QueueDirection(Direction dir)
+    {
+        m_directionQueue.Push(m_direction, dir, 0);
+    }
+
+    // Grow the snake by the given number of segments over the next moves
+    void Grow(int segments)
+    {
+        if (segments > 0)
+            m_pendingGrowth += segments;
+    }
+
+    // Update game logic by a number of timer ticks (returns the frame totals). Like
+    // SnakeGame, at most SnakeGame::c_maxStepsPerUpdate steps are taken per call;
+    // the rest stay due for the next calls.
+    SnakeGameEvents UpdateTicks(uint64_t elapsedTicks)
+    {
+        SnakeGameEvents events = {};
+
+        if (m_gameOver || m_won || m_length == 0)
+            return events;
+
+        m_moveAccumulator += elapsedTicks;
+
+        uint64_t interval = GetMoveIntervalTicks();
+        while (m_moveAccumulator >= interval && events.steps < SnakeGame::c_maxStepsPerUpdate)
+        {
+            events.steps++;
+
+            QueuedDirection turn;
+            if (m_directionQueue.Pop(turn))
+            {
+                m_direction = turn.dir;
+            }
+
+            const GridCell foodCellBeforeMove = m_food.cell;
+
+            if (MoveSnakeOneStep())
+            {
+                events.ateFood = true;
+                events.foodCell = foodCellBeforeMove;
+                events.foodEaten++;
+                SpawnFoodNotOnSnake();
+
+                if (m_won)
+                {
+                    events.won = true;
+                    break;
+                }
+            }
+
+            if (m_gameOver)
+            {
+                events.gameOver = true;
+                break;
+            }
+
+            m_moveAccumulator -= interval;
+            interval = GetMoveIntervalTicks();
+        }
+
+        return events;
+    }
+
+    // Same, in seconds (rounded to the nearest tick)
+    SnakeGameEvents Update(float elapsedTime) { return UpdateTicks(SnakeGame::SecondsToTicks(elapsedTime)); }
+
+    // Ticks per move at the current score (see SnakeGame::Settings)
+    uint64_t GetMoveIntervalTicks() const
+    {
+        const uint64_t minimum = std::max<uint64_t>(1, std::min(m_settings.minMoveIntervalTicks, m_settings.moveIntervalTicks));
+        const uint64_t speedUp = m_settings.speedUpTicksPerFood * static_cast<uint64_t>(m_score);
+        return (m_settings.moveIntervalTicks > minimum + speedUp) ? m_settings.moveIntervalTicks - speedUp : minimum;
+    }
+
+    // Getters (same as SnakeGame)
+    GridCell GetSegment(size_t index) const { return m_body[(m_bodyHead + index) & c_bodyMask]; }  // 0 = head
+    GridCell GetHead() const { return GetSegment(0); }
+    const Food& GetFood() const { return m_food; }
+    int GetScore() const { return m_score; }
+    size_t GetLength() const { return m_length; }
+    static constexpr int GetGridWidth() { return Width; }
+    static constexpr int GetGridHeight() { return Height; }
+    const SnakeBoardLayout& GetLayout() const { return m_layout; }
+    bool IsGameOver() const { return m_gameOver; }
+    bool IsWon() const { return m_won; }
+    Direction GetDirection() const { return m_direction; }
+    const DirectionQueue& GetQueuedDirections() const { return m_directionQueue; }
+    bool IsOccupied(GridCell cell) const { return IsCellOccupied(CellIndex(cell.x, cell.y)); }
+
+    void SetSettings(const SnakeGame::Settings& settings) { m_settings = settings; }
+    const SnakeGame::Settings& GetSettings() const { return m_settings; }
+
+    // Board math, all constant-folded
+    static constexpr int CellIndex(int cellX, int cellY) { return cellY * Width + cellX; }
+    static constexpr bool IsOnBoard(int cellX, int cellY)
+    {
+        return static_cast<unsigned>(cellX) < static_cast<unsigned>(Width) && static_cast<unsigned>(cellY) < static_cast<unsigned>(Height);
+    }
+
+private:
+    // Power-of-two ring capacity >= cell count
+    static constexpr size_t BodyCapacity()
+    {
+        size_t capacity = 1;
+        while (capacity < static_cast<size_t>(c_cellCount))
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    static constexpr size_t c_bodyCapacity = BodyCapacity();
+    static constexpr uint32_t c_bodyMask = static_cast<uint32_t>(c_bodyCapacity - 1);
+    static constexpr size_t c_occupancyWords = (static_cast<size_t>(c_cellCount) + 63) / 64;
+
+    bool MoveSnakeOneStep()
+    {
+        const GridCell head = GetHead();
+        int nextX = head.x;
+        int nextY = head.y;
+
+        switch (m_direction)
+        {
+        case Direction::Up:
+            nextY -= 1;
+            break;
+        case Direction::Down:
+            nextY += 1;
+            break;
+        case Direction::Left:
+            nextX -= 1;
+            break;
+        case Direction::Right:
+            nextX += 1;
+            break;
+        default:
+            return false;
+        }
+
+        if (!IsOnBoard(nextX, nextY) || IsCellOccupied(CellIndex(nextX, nextY)))
+        {
+            m_gameOver = true;
+            return false;
+        }
+
+        const GridCell nextHead = { static_cast<int16_t>(nextX), static_cast<int16_t>(nextY) };
+        PushHead(nextHead);
+        OccupyCell(nextHead);
+
+        if (m_food.alive && nextHead == m_food.cell)
+        {
+            m_score++;
+            m_food.alive = false;
+            return true;
+        }
+
+        if (m_pendingGrowth > 0)
+        {
+            m_pendingGrowth--;
+        }
+        else
+        {
+            ReleaseCell(PopTail());
+        }
+        return false;
+    }
+
+    void SpawnFoodNotOnSnake()
+    {
+        if (m_freeCount == 0)
+        {
+            m_food.alive = false;
+            m_won = true;
+            return;
+        }
+
+        const int index = m_freeCells[m_random.NextBelow(static_cast<uint32_t>(m_freeCount))];
+        m_food.cell.x = static_cast<int16_t>(index % Width);
+        m_food.cell.y = static_cast<int16_t>(index / Width);
+        m_food.alive = true;
+    }
+
+    void PushHead(GridCell cell)
+    {
+        m_bodyHead = (m_bodyHead - 1) & c_bodyMask;
+        m_body[m_bodyHead] = cell;
+        m_length++;
+    }
+
+    GridCell PopTail()
+    {
+        m_length--;
+        return m_body[(m_bodyHead + m_length) & c_bodyMask];
+    }
+
+    bool IsCellOccupied(int index) const { return (m_occupancy[static_cast<size_t>(index) >> 6] >> (index & 63)) & 1ULL; }
+
+    void OccupyCell(GridCell cell)
+    {
+        const int index = CellIndex(cell.x, cell.y);
+        m_occupancy[static_cast<size_t>(index) >> 6] |= (1ULL << (index & 63));
+
+        const int slot = m_freeSlot[static_cast<size_t>(index)];
+        if (slot >= 0)
+        {
+            const int lastIndex = m_freeCells[--m_freeCount];
+            m_freeCells[static_cast<size_t>(slot)] = lastIndex;
+            m_freeSlot[static_cast<size_t>(lastIndex)] = slot;
+            m_freeSlot[static_cast<size_t>(index)] = -1;
+        }
+    }
+
+    void ReleaseCell(GridCell cell)
+    {
+        const int index = CellIndex(cell.x, cell.y);
+        m_occupancy[static_cast<size_t>(index) >> 6] &= ~(1ULL << (index & 63));
+
+        if (m_layout.IsInSpawnArea(cell.x, cell.y))
+        {
+            m_freeSlot[static_cast<size_t>(index)] = static_cast<int>(m_freeCount);
+            m_freeCells[m_freeCount++] = index;
+        }
+    }
+
+    // Game state
+    std::array<GridCell, c_bodyCapacity> m_body;
+    uint32_t m_bodyHead;
+    size_t m_length;
+    size_t m_freeCount;
+    Direction m_direction;
+    DirectionQueue m_directionQueue;
+    uint64_t m_moveAccumulator;
+    Food m_food;
+    int m_score;
+    int m_pendingGrowth;
+    bool m_gameOver;
+    bool m_won;
+    Pcg32 m_random;
+
+    SnakeBoardLayout m_layout;
+    SnakeGame::Settings m_settings;
+
+    std::array<uint64_t, c_occupancyWords> m_occupancy;
+    std::array<int, static_cast<size_t>(c_cellCount)> m_freeCells;
+    std::array<int, static_cast<size_t>(c_cellCount)> m_freeSlot;
+};
+
+// Specializations for the common board sizes
+using SnakeGame40x30 = SnakeGameT<40, 30>;  // 800 x 600 (the default window)
+using SnakeGame64x36 = SnakeGameT<64, 36>;  // 1280 x 720
+using SnakeGame96x54 = SnakeGameT<96, 54>;  // 1920 x 1080
+
+// Type carrier for WithFixedBoard callbacks
+template<typename GameType>
+struct SnakeBoardTag
+{
+    using Game = GameType;
+};
+
+// Calls fn(SnakeBoardTag<SnakeGameT<W, H>>{}) if the screen size (pixels) is
+// exactly one of the common board sizes and returns true; returns false (without
+// calling fn) otherwise, so the caller can fall back to the dynamic SnakeGame.
+// Screen sizes that only round to the same grid are not matched: their spawn
+// area and start cell differ.
+template<typename Fn>
+bool WithFixedBoard(int screenWidth, int screenHeight, Fn&& fn)
+{
+    if (screenWidth == SnakeGame40x30::c_screenWidth && screenHeight == SnakeGame40x30::c_screenHeight)
+    {
+        fn(SnakeBoardTag<SnakeGame40x30>{});
+        return true;
+    }
+    if (screenWidth == SnakeGame64x36::c_screenWidth && screenHeight == SnakeGame64x36::c_screenHeight)
+    {
+        fn(SnakeBoardTag<SnakeGame64x36>{});
+        return true;
+    }
+    if (screenWidth == SnakeGame96x54::c_screenWidth && screenHeight == SnakeGame96x54::c_screenHeight)
+    {
+        fn(SnakeBoardTag<SnakeGame96x54>{});
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,335 @@
+//
+// SnakeWorldBatch.cpp
+// Batched snake simulation (structure-of-arrays)
+//
+
+#include "pch.h"
+#include "SnakeWorldBatch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#define SNAKE_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define SNAKE_PREFETCH(address) ((void)(address))
+#endif
+
+namespace
+{
+    // How many due games ahead to prefetch per-game cache lines
+    constexpr size_t c_prefetchDistance = 8;
+}
+
+SnakeWorldBatch::SnakeWorldBatch()
+    : m_gameCount(0)
+    , m_layout()
+    , m_cellCount(0)
+    , m_spawnCellCount(0)
+    , m_occupancyWords(0)
+    , m_bodyCapacity(0)
+    , m_bodyMask(0)
+{
+}
+
+void SnakeWorldBatch::Reset(size_t gameCount, int screenWidth, int screenHeight, uint64_t seed)
+{
+    m_layout = SnakeBoardLayout::FromScreen(screenWidth, screenHeight);
+    m_cellCount = static_cast<size_t>(m_layout.CellCount());
+    m_spawnCellCount = static_cast<size_t>(m_layout.spawnMaxCellX - m_layout.spawnMinCellX + 1) *
+        static_cast<size_t>(m_layout.spawnMaxCellY - m_layout.spawnMinCellY + 1);
+
+    // Free-cell indices are stored as 16 bits to keep the per-game blocks small
+    if (m_cellCount >= c_notFree)
+    {
+        throw std::invalid_argument("SnakeWorldBatch: board has too many cells");
+    }
+
+    m_gameCount = gameCount;
+    m_occupancyWords = (m_cellCount + 63) / 64;
+
+    m_bodyCapacity = 1;
+    while (m_bodyCapacity < m_cellCount)
+    {
+        m_bodyCapacity <<= 1;
+    }
+    m_bodyMask = static_cast<uint32_t>(m_bodyCapacity - 1);
+
+    m_headX.assign(gameCount, 0);
+    m_headY.assign(gameCount, 0);
+    m_direction.assign(gameCount, static_cast<uint8_t>(Direction::Right));
+    m_queuedTurns.assign(gameCount, 0);
+    m_queuedCount.assign(gameCount, 0);
+    m_moveAccumulator.assign(gameCount, 0);
+    m_score.assign(gameCount, 0);
+    m_length.assign(gameCount, 0);
+    m_flags.assign(gameCount, 0);
+    m_foodX.assign(gameCount, 0);
+    m_foodY.assign(gameCount, 0);
+    m_foodAlive.assign(gameCount, 0);
+    m_freeCount.assign(gameCount, 0);
+    m_bodyHead.assign(gameCount, 0);
+    m_random.resize(gameCount);
+
+    m_occupancy.assign(gameCount * m_occupancyWords, 0);
+    m_body.assign(gameCount * m_bodyCapacity, GridCell{ 0, 0 });
+    m_freeCells.assign(gameCount * m_spawnCellCount, 0);
+    m_freeSlot.assign(gameCount * m_cellCount, c_notFree);
+
+    m_nextX.assign(gameCount, 0);
+    m_nextY.assign(gameCount, 0);
+    m_dueMask.assign(gameCount, 0);
+    m_due.clear();
+    m_due.reserve(gameCount);
+
+    // Free-cell set in the same order SnakeGame::Reset builds it
+    std::vector<uint16_t> initialFreeCells;
+    std::vector<uint16_t> initialFreeSlot(m_cellCount, c_notFree);
+    initialFreeCells.reserve(m_spawnCellCount);
+    for (int cellY = m_layout.spawnMinCellY; cellY <= m_layout.spawnMaxCellY; ++cellY)
+    {
+        for (int cellX = m_layout.spawnMinCellX; cellX <= m_layout.spawnMaxCellX; ++cellX)
+        {
+            const int index = cellY * m_layout.gridWidth + cellX;
+            initialFreeSlot[static_cast<size_t>(index)] = static_cast<uint16_t>(initialFreeCells.size());
+            initialFreeCells.push_back(static_cast<uint16_t>(index));
+        }
+    }
+
+    for (size_t game = 0; game < gameCount; ++game)
+    {
+        m_random[game].Seed(GameSeed(seed, game));
+        memcpy(&m_freeCells[game * m_spawnCellCount], initialFreeCells.data(), m_spawnCellCount * sizeof(uint16_t));
+        memcpy(&m_freeSlot[game * m_cellCount], initialFreeSlot.data(), m_cellCount * sizeof(uint16_t));
+        m_freeCount[game] = static_cast<uint32_t>(m_spawnCellCount);
+
+        // Initial snake (head + 2 segments, facing right), pushed from the tail forward
+        for (int i = SnakeGame::c_initialSnakeLength - 1; i >= 0; --i)
+        {
+            const GridCell segment = { static_cast<int16_t>(m_layout.start.x - i), m_layout.start.y };
+            m_bodyHead[game] = (m_bodyHead[game] - 1) & m_bodyMask;
+            m_body[game * m_bodyCapacity + m_bodyHead[game]] = segment;
+            m_length[game]++;
+            OccupyCell(game, m_layout.CellIndex(segment));
+        }
+        m_headX[game] = m_layout.start.x;
+        m_headY[game] = m_layout.start.y;
+
+        SpawnFood(game);
+    }
+}
+
+void SnakeWorldBatch::QueueDirection(size_t game, Direction dir)
+{
+    // Checked against the last queued direction, as in DirectionQueue::Push
+    // (Up/Down and Left/Right differ only in the low bit)
+    static_assert(DirectionQueue::c_capacity * 2 <= 8, "queued turns must pack into a byte");
+    const uint8_t count = m_queuedCount[game];
+    const uint8_t last = count ? static_cast<uint8_t>((m_queuedTurns[game] >> (2 * (count - 1))) & 3u) : m_direction[game];
+    const uint8_t value = static_cast<uint8_t>(dir);
+    if (count == DirectionQueue::c_capacity || value == last || value == (last ^ 1u))
+        return;
+
+    m_queuedTurns[game] = static_cast<uint8_t>(m_queuedTurns[game] | (value << (2 * count)));
+    m_queuedCount[game] = static_cast<uint8_t>(count + 1);
+}
+
+SnakeBatchStats SnakeWorldBatch::UpdateTicks(uint64_t elapsedTicks)
+{
+    SnakeBatchStats stats = {};
+
+    const size_t count = m_gameCount;
+    const uint8_t* flags = m_flags.data();
+    uint8_t* direction = m_direction.data();
+    uint8_t* queuedTurns = m_queuedTurns.data();
+    uint8_t* queuedCount = m_queuedCount.data();
+    uint64_t* accumulator = m_moveAccumulator.data();
+
+    // Timer pass: running games accumulate time
+    for (size_t i = 0; i < count; ++i)
+    {
+        const bool running = (flags[i] == 0);
+        accumulator[i] += running ? elapsedTicks : 0;
+    }
+
+    // One round steps every due game once, so capping the rounds caps each game's steps
+    for (int round = 0; round < SnakeGame::c_maxStepsPerUpdate; ++round)
+    {
+        const int16_t* headX = m_headX.data();
+        const int16_t* headY = m_headY.data();
+        int32_t* nextX = m_nextX.data();
+        int32_t* nextY = m_nextY.data();
+        uint8_t* dueMask = m_dueMask.data();
+
+        // Next-head pass: games due to move take their next queued turn, then
+        // branch-free direction deltas (Up=0, Down=1, Left=2, Right=3)
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t due = static_cast<uint8_t>((flags[i] == 0) & (accumulator[i] >= SnakeGame::c_moveIntervalTicks));
+            const uint8_t turn = static_cast<uint8_t>(due & (queuedCount[i] != 0));
+            direction[i] = turn ? static_cast<uint8_t>(queuedTurns[i] & 3u) : direction[i];
+            queuedTurns[i] = turn ? static_cast<uint8_t>(queuedTurns[i] >> 2) : queuedTurns[i];
+            queuedCount[i] = static_cast<uint8_t>(queuedCount[i] - turn);
+
+            const int d = direction[i];
+            nextX[i] = headX[i] + (d == 3) - (d == 2);
+            nextY[i] = headY[i] + (d == 1) - (d == 0);
+            dueMask[i] = due;
+        }
+
+        // Compact the games that move this round
+        m_due.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (dueMask[i])
+            {
+                m_due.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        if (m_due.empty())
+            break;
+
+        StepDueGames(stats);
+    }
+
+    return stats;
+}
+
+void SnakeWorldBatch::StepDueGames(SnakeBatchStats& stats)
+{
+    const uint32_t gridWidth = static_cast<uint32_t>(m_layout.gridWidth);
+    const uint32_t gridHeight = static_cast<uint32_t>(m_layout.gridHeight);
+    const size_t dueCount = m_due.size();
+
+    for (size_t dueIndex = 0; dueIndex < dueCount; ++dueIndex)
+    {
+        // Games are independent, so pull in the lines a later game will touch
+        // while this one is processed (a lone SnakeGame cannot overlap misses)
+        if (dueIndex + c_prefetchDistance < dueCount)
+        {
+            const uint32_t ahead = m_due[dueIndex + c_prefetchDistance];
+            const uint32_t aheadX = static_cast<uint32_t>(m_nextX[ahead]);
+            const uint32_t aheadY = static_cast<uint32_t>(m_nextY[ahead]);
+            if (aheadX < gridWidth && aheadY < gridHeight)
+            {
+                const size_t aheadIndex = aheadY * gridWidth + aheadX;
+                SNAKE_PREFETCH(&m_occupancy[ahead * m_occupancyWords + (aheadIndex >> 6)]);
+                SNAKE_PREFETCH(&m_freeSlot[ahead * m_cellCount + aheadIndex]);
+            }
+            const GridCell* aheadBody = &m_body[ahead * m_bodyCapacity];
+            SNAKE_PREFETCH(&aheadBody[(m_bodyHead[ahead] - 1) & m_bodyMask]);
+            SNAKE_PREFETCH(&aheadBody[(m_bodyHead[ahead] + m_length[ahead] - 1) & m_bodyMask]);
+        }
+
+        const uint32_t game = m_due[dueIndex];
+        stats.steps++;
+
+        const int32_t nextX = m_nextX[game];
+        const int32_t nextY = m_nextY[game];
+
+        // Boundary collision (negative coordinates wrap to large unsigned values)
+        if (static_cast<uint32_t>(nextX) >= gridWidth || static_cast<uint32_t>(nextY) >= gridHeight)
+        {
+            m_flags[game] |= c_flagGameOver;
+            stats.gameOvers++;
+            continue;
+        }
+
+        // Self collision against this game's bitmap (tail still counts)
+        const int index = nextY * static_cast<int32_t>(gridWidth) + nextX;
+        const uint64_t* occupancy = &m_occupancy[game * m_occupancyWords];
+        if ((occupancy[index >> 6] >> (index & 63)) & 1ULL)
+        {
+            m_flags[game] |= c_flagGameOver;
+            stats.gameOvers++;
+            continue;
+        }
+
+        // Push the new head
+        const GridCell nextHead = { static_cast<int16_t>(nextX), static_cast<int16_t>(nextY) };
+        GridCell* body = &m_body[game * m_bodyCapacity];
+        m_bodyHead[game] = (m_bodyHead[game] - 1) & m_bodyMask;
+        body[m_bodyHead[game]] = nextHead;
+        m_length[game]++;
+        m_headX[game] = nextHead.x;
+        m_headY[game] = nextHead.y;
+        OccupyCell(game, index);
+
+        if (m_foodAlive[game] && nextHead.x == m_foodX[game] && nextHead.y == m_foodY[game])
+        {
+            // Food eaten - grow (keep tail) and respawn
+            m_score[game]++;
+            m_foodAlive[game] = 0;
+            stats.foodEaten++;
+            SpawnFood(game);
+
+            if (m_flags[game] & c_flagWon)
+            {
+                stats.wins++;
+                continue;
+            }
+        }
+        else
+        {
+            // Normal movement - retract the tail
+            m_length[game]--;
+            const GridCell tail = body[(m_bodyHead[game] + m_length[game]) & m_bodyMask];
+            ReleaseCell(game, tail);
+        }
+
+        m_moveAccumulator[game] -= SnakeGame::c_moveIntervalTicks;
+    }
+}
+
+void SnakeWorldBatch::SpawnFood(size_t game)
+{
+    const uint32_t freeCount = m_freeCount[game];
+    if (freeCount == 0)
+    {
+        // Nowhere left to place food
+        m_foodAlive[game] = 0;
+        m_flags[game] |= c_flagWon;
+        return;
+    }
+
+    // Uniform draw from the free-cell set (same draw as SnakeGame)
+    const int index = m_freeCells[game * m_spawnCellCount + m_random[game].NextBelow(freeCount)];
+    m_foodX[game] = static_cast<int16_t>(index % m_layout.gridWidth);
+    m_foodY[game] = static_cast<int16_t>(index / m_layout.gridWidth);
+    m_foodAlive[game] = 1;
+}
+
+void SnakeWorldBatch::OccupyCell(size_t game, int index)
+{
+    m_occupancy[game * m_occupancyWords + (static_cast<size_t>(index) >> 6)] |= (1ULL << (index & 63));
+
+    // Swap-remove from the free-cell set
+    uint16_t* freeCells = &m_freeCells[game * m_spawnCellCount];
+    uint16_t* freeSlot = &m_freeSlot[game * m_cellCount];
+    const uint16_t slot = freeSlot[index];
+    if (slot != c_notFree)
+    {
+        const uint16_t lastIndex = freeCells[--m_freeCount[game]];
+        freeCells[slot] = lastIndex;
+        freeSlot[lastIndex] = slot;
+        freeSlot[index] = c_notFree;
+    }
+}
+
+void SnakeWorldBatch::ReleaseCell(size_t game, GridCell cell)
+{
+    const int index = m_layout.CellIndex(cell);
+    m_occupancy[game * m_occupancyWords + (static_cast<size_t>(index) >> 6)] &= ~(1ULL << (index & 63));
+
+    // Cells outside the spawn area were never in the free-cell set
+    if (m_layout.IsInSpawnArea(cell.x, cell.y))
+    {
+        uint16_t* freeCells = &m_freeCells[game * m_spawnCellCount];
+        const uint16_t slot = static_cast<uint16_t>(m_freeCount[game]++);
+        freeCells[slot] = static_cast<uint16_t>(index);
+        m_freeSlot[game * m_cellCount + static_cast<size_t>(index)] = slot;
+    }
+}
@@ -0,0 +1,119 @@
+//
+// SnakeWorldBatch.h
+// Many independent snake games stepped together (structure-of-arrays)
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "SnakeGame.h"
+
+// Totals from one SnakeWorldBatch::Update call
+struct SnakeBatchStats
+{
+    uint64_t steps;     // Movement steps taken across all games
+    uint32_t foodEaten; // Games that ate food (counted per step)
+    uint32_t gameOvers; // Games that died this call
+    uint32_t wins;      // Games that filled the board this call
+};
+
+// N snake games with the same rules as SnakeGame, stored as parallel arrays.
+//
+// Per-game scalars (head, direction, accumulator, score, ...) live in one array
+// each, so the per-step passes over all games (timer, next-head, bounds) are plain
+// loops over contiguous data that the compiler can vectorize. Only games that are
+// due to move take the gather/scatter path into their own occupancy bitmap, body
+// ring and free-cell set. Each game owns a Pcg32 seeded with GameSeed(seed, game),
+// so a batch matches SnakeGames reset with those seeds and stepped one at a time.
+class SnakeWorldBatch
+{
+public:
+    SnakeWorldBatch();
+    ~SnakeWorldBatch() = default;
+
+    // Reset every game to the SnakeGame starting state (screen size in pixels)
+    void Reset(size_t gameCount, int screenWidth, int screenHeight, uint64_t seed);
+
+    // Seed that game `game` of a batch reset with `seed` uses (for SnakeGame::Reset)
+    static uint64_t GameSeed(uint64_t seed, size_t game)
+    {
+        uint64_t state = seed + static_cast<uint64_t>(game) * 0x9E3779B97F4A7C15ull;
+        return SplitMix64(state);
+    }
+
+    // Queue a direction change for one game's next steps (same rules as
+    // DirectionQueue, without timestamps)
+    void QueueDirection(size_t game, Direction dir);
+
+    // Advance every game by the same number of timer ticks (SnakeGame::c_ticksPerSecond
+    // per second, default SnakeGame settings). As in SnakeGame, a game takes at most
+    // SnakeGame::c_maxStepsPerUpdate steps per call and the rest stay due.
+    SnakeBatchStats UpdateTicks(uint64_t elapsedTicks);
+
+    // Same, in seconds (rounded to the nearest tick)
+    SnakeBatchStats Update(float elapsedTime) { return UpdateTicks(SnakeGame::SecondsToTicks(elapsedTime)); }
+
+    // Per-game getters
+    size_t GetGameCount() const { return m_gameCount; }
+    GridCell GetHead(size_t game) const { return GridCell{ m_headX[game], m_headY[game] }; }
+    GridCell GetSegment(size_t game, size_t index) const
+    {
+        return m_body[game * m_bodyCapacity + ((m_bodyHead[game] + index) & m_bodyMask)];
+    }
+    Food GetFood(size_t game) const { return Food{ GridCell{ m_foodX[game], m_foodY[game] }, m_foodAlive[game] != 0 }; }
+    int GetScore(size_t game) const { return m_score[game]; }
+    size_t GetLength(size_t game) const { return m_length[game]; }
+    bool IsGameOver(size_t game) const { return (m_flags[game] & c_flagGameOver) != 0; }
+    bool IsWon(size_t game) const { return (m_flags[game] & c_flagWon) != 0; }
+    const SnakeBoardLayout& GetLayout() const { return m_layout; }
+
+private:
+    // Step every game in m_due once; returns totals for the round
+    void StepDueGames(SnakeBatchStats& stats);
+    void SpawnFood(size_t game);
+    void OccupyCell(size_t game, int index);
+    void ReleaseCell(size_t game, GridCell cell);
+
+    static constexpr uint8_t c_flagGameOver = 1;
+    static constexpr uint8_t c_flagWon = 2;
+    static constexpr uint16_t c_notFree = 0xFFFF;
+
+    size_t m_gameCount;
+    SnakeBoardLayout m_layout;
+    size_t m_cellCount;
+    size_t m_spawnCellCount;
+    size_t m_occupancyWords;  // uint64 words per game
+
+    // Per-game scalars (one entry per game)
+    std::vector<int16_t> m_headX;
+    std::vector<int16_t> m_headY;
+    std::vector<uint8_t> m_direction;
+    std::vector<uint8_t> m_queuedTurns;  // Queued directions, 2 bits each, oldest in the low bits
+    std::vector<uint8_t> m_queuedCount;
+    std::vector<uint64_t> m_moveAccumulator;  // Ticks
+    std::vector<int32_t> m_score;
+    std::vector<uint32_t> m_length;
+    std::vector<uint8_t> m_flags;
+    std::vector<int16_t> m_foodX;
+    std::vector<int16_t> m_foodY;
+    std::vector<uint8_t> m_foodAlive;
+    std::vector<uint32_t> m_freeCount;
+    std::vector<uint32_t> m_bodyHead;
+    std::vector<Pcg32> m_random;
+
+    // Per-game blocks (game i owns [i * stride, (i + 1) * stride))
+    std::vector<uint64_t> m_occupancy;  // m_occupancyWords per game
+    std::vector<GridCell> m_body;       // m_bodyCapacity per game (ring, head at m_bodyHead)
+    std::vector<uint16_t> m_freeCells;  // m_spawnCellCount per game (dense free list)
+    std::vector<uint16_t> m_freeSlot;   // m_cellCount per game (slot in free list or c_notFree)
+    size_t m_bodyCapacity;
+    uint32_t m_bodyMask;
+
+    // Scratch for the vectorizable passes
+    std::vector<int32_t> m_nextX;
+    std::vector<int32_t> m_nextY;
+    std::vector<uint8_t> m_dueMask;
+    std::vector<uint32_t> m_due;  // Compacted indices of games moving this round
+};
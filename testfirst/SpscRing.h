@@ -0,0 +1,84 @@
+//
+// SpscRing.h
+// Wait-free single-producer/single-consumer ring buffer
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed-capacity FIFO between exactly one producer thread and one consumer thread.
+//
+// Each side owns one index and only reads the other's, so TryPush and TryPop are a
+// couple of loads and one store each, never wait and never allocate. Each side
+// also caches the other's index and only reloads it when the ring looks full
+// (producer) or empty (consumer), so the indices' cache lines are not passed back
+// and forth on every call. Capacity must be a power of two; one slot is never
+// used, so Capacity - 1 items fit.
+template<typename T, size_t Capacity>
+class SpscRing
+{
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    SpscRing() : m_items{}, m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: append a copy of item; false if the ring is full
+    bool TryPush(const T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & c_mask;
+        if (next == m_cachedHead)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (next == m_cachedHead)
+                return false;
+        }
+
+        m_items[tail] = item;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: take the oldest item; false if the ring is empty
+    bool TryPop(T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return false;
+        }
+
+        item = m_items[head];
+        m_head.store((head + 1) & c_mask, std::memory_order_release);
+        return true;
+    }
+
+    // Either side: approximate number of queued items
+    size_t GetSize() const
+    {
+        return (m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire)) & c_mask;
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity - 1; }
+
+private:
+    static constexpr size_t c_mask = Capacity - 1;
+
+    std::array<T, Capacity> m_items;
+
+    // Consumer-owned index and its cached view of the tail
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // Producer-owned index and its cached view of the head
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+};
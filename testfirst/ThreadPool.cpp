@@ -0,0 +1,156 @@
+//
+// ThreadPool.cpp
+// Work-stealing thread pool implementation
+//
+
+#include "pch.h"
+#include "ThreadPool.h"
+
+namespace
+{
+    thread_local int t_workerIndex = -1;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_queued(0)
+    , m_pending(0)
+    , m_nextQueue(0)
+    , m_stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+
+    m_queues.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+int ThreadPool::CurrentWorkerIndex()
+{
+    return t_workerIndex;
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    // Workers keep their own subtasks; outside submissions are spread round-robin
+    const size_t index = (t_workerIndex >= 0 && static_cast<size_t>(t_workerIndex) < m_queues.size())
+        ? static_cast<size_t>(t_workerIndex)
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // Count first (under m_mutex so a worker about to sleep cannot miss it); a
+        // worker that wakes before the push below just retries its deques
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    m_workAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_allDone.wait(lock, [this]() { return m_pending.load(std::memory_order_acquire) == 0; });
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& body)
+{
+    if (chunkSize == 0)
+    {
+        chunkSize = 1;
+    }
+
+    for (size_t begin = 0; begin < count; begin += chunkSize)
+    {
+        const size_t end = std::min(count, begin + chunkSize);
+        Submit([&body, begin, end]() { body(begin, end); });
+    }
+
+    Wait();
+}
+
+bool ThreadPool::TryPop(size_t index, std::function<void()>& task)
+{
+    WorkerQueue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::TrySteal(size_t thief, std::function<void()>& task)
+{
+    const size_t count = m_queues.size();
+    for (size_t offset = 1; offset < count; ++offset)
+    {
+        WorkerQueue& queue = *m_queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+    t_workerIndex = static_cast<int>(index);
+
+    for (;;)
+    {
+        std::function<void()> task;
+        if (TryPop(index, task) || TrySteal(index, task))
+        {
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workAvailable.wait(lock, [this]() { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+        if (m_stopping && m_queued.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
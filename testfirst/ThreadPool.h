@@ -0,0 +1,70 @@
+//
+// ThreadPool.h
+// Work-stealing thread pool for the console tools and batch jobs
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque.
+//
+// A worker pops its newest task first (LIFO, cache-warm) and, when its deque is
+// empty, steals the oldest task from another worker (FIFO, usually the largest
+// remaining piece of work). Tasks submitted from outside the pool are dealt
+// round-robin; tasks submitted from a worker go to that worker's deque.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task
+    void Submit(std::function<void()> task);
+
+    // Block until every submitted task has finished (not from inside a task)
+    void Wait();
+
+    // Split [0, count) into chunks of `chunkSize` and run body(begin, end) for each
+    // chunk on the pool, then wait (not from inside a task)
+    void ParallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& body);
+
+    size_t GetThreadCount() const { return m_workers.size(); }
+
+    // Index of the calling worker in [0, GetThreadCount()), or -1 off the pool
+    static int CurrentWorkerIndex();
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void WorkerLoop(size_t index);
+    bool TryPop(size_t index, std::function<void()>& task);
+    bool TrySteal(size_t thief, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    // Sleeping/waking and completion tracking
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_allDone;
+    std::atomic<size_t> m_queued;   // Tasks sitting in a deque
+    std::atomic<size_t> m_pending;  // Tasks submitted but not finished
+    std::atomic<size_t> m_nextQueue;
+    bool m_stopping;
+};
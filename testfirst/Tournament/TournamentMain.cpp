@@ -0,0 +1,511 @@
+//
+// TournamentMain.cpp
+// Self-play tournament: many full SnakeGame runs sharded over a thread pool
+//
+// Usage: snake_tournament [--games N] [--threads T] [--scaling]
+//                         [--policy autopilot|random] [--budget nodes]
+//                         [--move-interval s] [--spawn-margin px] [--dt s]
+//                         [--width W] [--height H] [--max-steps N] [--seed S]
+//                         [--format csv|json] [--dynamic]
+//
+// Every game gets its own seed derived from --seed and its index, so results do
+// not depend on the thread count or scheduling. Statistics are streamed into
+// per-worker accumulators (running mean/variance plus a fixed-size histogram for
+// percentiles) and merged at the end; no per-game results are stored.
+// --scaling repeats the run on 1, 2, 4, ... threads and reports the speedup.
+// The random policy plays on a compile-time SnakeGameT when the board is one of
+// the common sizes (--dynamic forces the dynamic SnakeGame; results are identical).
+//
+
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "SnakeAutopilot.h"
+#include "SnakeGameT.h"
+#include "SnakeWorldBatch.h"
+#include "ThreadPool.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    enum class Policy
+    {
+        Autopilot,
+        Random,
+    };
+
+    struct Options
+    {
+        uint64_t games = 20000;
+        size_t threads = 0;  // 0 = hardware threads
+        bool scaling = false;
+        Policy policy = Policy::Autopilot;
+        int budget = SnakeAutopilot::c_defaultNodeBudget;
+        SnakeGame::Settings settings;
+        uint64_t dtTicks = SnakeGame::SecondsToTicks(1.0 / 60.0);
+        int width = 800;
+        int height = 600;
+        uint64_t maxSteps = 0;  // 0 = 20 steps per board cell
+        uint64_t seed = 1;
+        bool json = false;
+        bool dynamic = false;  // Never use a SnakeGameT specialization
+    };
+
+    // Games per pool task (small enough to balance, large enough to amortize)
+    constexpr size_t c_gamesPerTask = 16;
+
+    // Histogram resolution for the percentiles (integer metrics on boards up to
+    // this many cells get one bin per value)
+    constexpr size_t c_histogramBins = 4096;
+
+    // Running statistics over [0, maxValue]: Welford mean/variance, min/max and a
+    // fixed histogram. Integral metrics use whole-number bin widths so their
+    // percentiles are exact values.
+    class StreamingStats
+    {
+    public:
+        StreamingStats() : StreamingStats(1.0, false) {}
+
+        StreamingStats(double maxValue, bool integral)
+            : m_count(0), m_mean(0.0), m_m2(0.0), m_min(0.0), m_max(0.0)
+            , m_binWidth(integral ? std::max(1.0, ceil((maxValue + 1.0) / c_histogramBins)) : std::max(maxValue, 1e-9) / c_histogramBins)
+            , m_integral(integral)
+            , m_bins(c_histogramBins, 0)
+        {
+        }
+
+        void Add(double value)
+        {
+            m_count++;
+            const double delta = value - m_mean;
+            m_mean += delta / static_cast<double>(m_count);
+            m_m2 += delta * (value - m_mean);
+            m_min = (m_count == 1) ? value : std::min(m_min, value);
+            m_max = (m_count == 1) ? value : std::max(m_max, value);
+
+            const size_t bin = std::min(c_histogramBins - 1, static_cast<size_t>(std::max(0.0, value) / m_binWidth));
+            m_bins[bin]++;
+        }
+
+        // Combine with another accumulator over the same range (Chan et al.)
+        void Merge(const StreamingStats& other)
+        {
+            if (other.m_count == 0)
+                return;
+
+            if (m_count == 0)
+            {
+                *this = other;
+                return;
+            }
+
+            const uint64_t count = m_count + other.m_count;
+            const double delta = other.m_mean - m_mean;
+            m_mean += delta * static_cast<double>(other.m_count) / static_cast<double>(count);
+            m_m2 += other.m_m2 + delta * delta * static_cast<double>(m_count) * static_cast<double>(other.m_count) / static_cast<double>(count);
+            m_count = count;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+            for (size_t i = 0; i < c_histogramBins; ++i)
+            {
+                m_bins[i] += other.m_bins[i];
+            }
+        }
+
+        // Value below which the given fraction of samples falls (bin start for
+        // integral metrics, bin center otherwise)
+        double Percentile(double fraction) const
+        {
+            const uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(m_count));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < c_histogramBins; ++i)
+            {
+                seen += m_bins[i];
+                if (seen > target)
+                {
+                    const double value = (static_cast<double>(i) + (m_integral ? 0.0 : 0.5)) * m_binWidth;
+                    return std::min(m_max, std::max(m_min, value));
+                }
+            }
+            return m_max;
+        }
+
+        uint64_t GetCount() const { return m_count; }
+        double GetMean() const { return m_mean; }
+        double GetStdDev() const { return m_count > 1 ? sqrt(m_m2 / static_cast<double>(m_count - 1)) : 0.0; }
+        double GetMin() const { return m_min; }
+        double GetMax() const { return m_max; }
+
+    private:
+        uint64_t m_count;
+        double m_mean;
+        double m_m2;
+        double m_min;
+        double m_max;
+        double m_binWidth;
+        bool m_integral;
+        std::vector<uint64_t> m_bins;
+    };
+
+    struct TournamentStats
+    {
+        StreamingStats score;
+        StreamingStats length;
+        StreamingStats survival;  // Simulated seconds
+        uint64_t died = 0;
+        uint64_t won = 0;
+        uint64_t timedOut = 0;
+        uint64_t totalScore = 0;  // Exact, for comparing runs
+
+        void Merge(const TournamentStats& other)
+        {
+            score.Merge(other.score);
+            length.Merge(other.length);
+            survival.Merge(other.survival);
+            died += other.died;
+            won += other.won;
+            timedOut += other.timedOut;
+            totalScore += other.totalScore;
+        }
+    };
+
+    // One worker's game objects and accumulators (padded so workers do not share lines)
+    struct alignas(64) WorkerState
+    {
+        SnakeGame game;
+        SnakeAutopilot autopilot;
+        Pcg32 random;
+        TournamentStats stats;
+    };
+
+    struct RunResult
+    {
+        TournamentStats stats;
+        double seconds;
+        bool fixedBoard;  // Played on a SnakeGameT specialization
+    };
+
+    template<typename Game>
+    Direction RandomDirection(const Game& game, Pcg32& random)
+    {
+        // Keep going straight most of the time so games last more than a few moves
+        if (random.NextBelow(8) != 0)
+            return game.GetDirection();
+        return static_cast<Direction>(random.NextBelow(4));
+    }
+
+    // Game is SnakeGame or, for the random policy only, a SnakeGameT
+    template<typename Game>
+    void PlayGame(const Options& options, uint64_t gameIndex, uint64_t maxUpdates, Game& game, WorkerState& worker)
+    {
+        const uint64_t seed = SnakeWorldBatch::GameSeed(options.seed, static_cast<size_t>(gameIndex));
+
+        game.SetSettings(options.settings);
+        if constexpr (std::is_same_v<Game, SnakeGame>)
+        {
+            game.Reset(options.width, options.height, seed);
+            worker.autopilot.Reset(game);
+        }
+        else
+        {
+            game.Reset(seed);
+        }
+        worker.random.Seed(seed ^ 0xA5A5A5A5A5A5A5A5ull);
+
+        uint64_t updates = 0;
+        while (!game.IsGameOver() && !game.IsWon() && updates < maxUpdates)
+        {
+            Direction dir;
+            if constexpr (std::is_same_v<Game, SnakeGame>)
+            {
+                dir = (options.policy == Policy::Autopilot)
+                    ? worker.autopilot.Think(game)
+                    : RandomDirection(game, worker.random);
+            }
+            else
+            {
+                dir = RandomDirection(game, worker.random);
+            }
+            game.QueueDirection(dir);
+            game.UpdateTicks(options.dtTicks);
+            updates++;
+        }
+
+        TournamentStats& stats = worker.stats;
+        stats.score.Add(static_cast<double>(game.GetScore()));
+        stats.length.Add(static_cast<double>(game.GetLength()));
+        stats.survival.Add(SnakeGame::TicksToSeconds(updates * options.dtTicks));
+        stats.totalScore += static_cast<uint64_t>(game.GetScore());
+        if (game.IsGameOver())
+            stats.died++;
+        else if (game.IsWon())
+            stats.won++;
+        else
+            stats.timedOut++;
+    }
+
+    RunResult RunTournament(const Options& options, size_t threadCount)
+    {
+        const SnakeBoardLayout layout = SnakeBoardLayout::FromScreen(options.width, options.height, options.settings.spawnMargin);
+        const double cellCount = static_cast<double>(layout.CellCount());
+        const uint64_t maxSteps = options.maxSteps ? options.maxSteps : static_cast<uint64_t>(cellCount) * 20;
+        const uint64_t maxUpdates = (maxSteps * options.settings.moveIntervalTicks + options.dtTicks - 1) / options.dtTicks;
+        const double maxSurvival = SnakeGame::TicksToSeconds(maxUpdates * options.dtTicks);
+
+        ThreadPool pool(threadCount);
+
+        std::vector<std::unique_ptr<WorkerState>> workers;
+        for (size_t i = 0; i < pool.GetThreadCount(); ++i)
+        {
+            auto worker = std::make_unique<WorkerState>();
+            worker->autopilot.SetNodeBudget(options.budget);
+            worker->stats.score = StreamingStats(cellCount, true);
+            worker->stats.length = StreamingStats(cellCount, true);
+            worker->stats.survival = StreamingStats(maxSurvival, false);
+            workers.push_back(std::move(worker));
+        }
+
+        RunResult result;
+        const Clock::time_point start = Clock::now();
+
+        // The random policy only needs the game, so it can use a fixed-size board
+        result.fixedBoard = options.policy == Policy::Random && !options.dynamic &&
+            WithFixedBoard(options.width, options.height, [&](auto tag)
+            {
+                using FixedGame = typename decltype(tag)::Game;
+                std::vector<std::unique_ptr<FixedGame>> games;
+                for (size_t i = 0; i < workers.size(); ++i)
+                {
+                    games.push_back(std::make_unique<FixedGame>());
+                }
+
+                pool.ParallelFor(static_cast<size_t>(options.games), c_gamesPerTask, [&](size_t begin, size_t end)
+                {
+                    const size_t workerIndex = static_cast<size_t>(ThreadPool::CurrentWorkerIndex());
+                    for (size_t gameIndex = begin; gameIndex < end; ++gameIndex)
+                    {
+                        PlayGame(options, gameIndex, maxUpdates, *games[workerIndex], *workers[workerIndex]);
+                    }
+                });
+            });
+
+        if (!result.fixedBoard)
+        {
+            pool.ParallelFor(static_cast<size_t>(options.games), c_gamesPerTask, [&](size_t begin, size_t end)
+            {
+                WorkerState& worker = *workers[static_cast<size_t>(ThreadPool::CurrentWorkerIndex())];
+                for (size_t gameIndex = begin; gameIndex < end; ++gameIndex)
+                {
+                    PlayGame(options, gameIndex, maxUpdates, worker.game, worker);
+                }
+            });
+        }
+
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.stats = workers[0]->stats;
+        for (size_t i = 1; i < workers.size(); ++i)
+        {
+            result.stats.Merge(workers[i]->stats);
+        }
+        return result;
+    }
+
+    void PrintStatsCsv(const char* name, const StreamingStats& stats)
+    {
+        printf("%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", name, static_cast<unsigned long long>(stats.GetCount()),
+            stats.GetMean(), stats.GetStdDev(), stats.GetMin(),
+            stats.Percentile(0.5), stats.Percentile(0.9), stats.Percentile(0.99), stats.GetMax());
+    }
+
+    void PrintStatsJson(const char* name, const StreamingStats& stats, bool last)
+    {
+        printf("    \"%s\": { \"count\": %llu, \"mean\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+            name, static_cast<unsigned long long>(stats.GetCount()),
+            stats.GetMean(), stats.GetStdDev(), stats.GetMin(),
+            stats.Percentile(0.5), stats.Percentile(0.9), stats.Percentile(0.99), stats.GetMax(), last ? "" : ",");
+    }
+
+    struct ScalingRow
+    {
+        size_t threads;
+        double seconds;
+        bool matches;  // Same aggregate results as the 1-thread run
+    };
+
+    void PrintReport(const Options& options, size_t threadCount, const RunResult& result, const std::vector<ScalingRow>& scaling)
+    {
+        const TournamentStats& stats = result.stats;
+        const double gamesPerSecond = result.seconds > 0.0 ? static_cast<double>(options.games) / result.seconds : 0.0;
+        const char* policy = (options.policy == Policy::Autopilot) ? "autopilot" : "random";
+
+        if (options.json)
+        {
+            printf("{\n");
+            printf("  \"settings\": { \"games\": %llu, \"threads\": %zu, \"policy\": \"%s\", \"budget\": %d, \"moveInterval\": %.4f, \"spawnMargin\": %.1f, \"dt\": %.5f, \"width\": %d, \"height\": %d, \"fixedBoard\": %s, \"seed\": %llu },\n",
+                static_cast<unsigned long long>(options.games), threadCount, policy, options.budget,
+                SnakeGame::TicksToSeconds(options.settings.moveIntervalTicks), options.settings.spawnMargin, SnakeGame::TicksToSeconds(options.dtTicks), options.width, options.height,
+                result.fixedBoard ? "true" : "false", static_cast<unsigned long long>(options.seed));
+            printf("  \"seconds\": %.4f,\n  \"gamesPerSecond\": %.1f,\n", result.seconds, gamesPerSecond);
+            printf("  \"outcomes\": { \"died\": %llu, \"won\": %llu, \"timedOut\": %llu },\n",
+                static_cast<unsigned long long>(stats.died), static_cast<unsigned long long>(stats.won), static_cast<unsigned long long>(stats.timedOut));
+            printf("  \"metrics\": {\n");
+            PrintStatsJson("score", stats.score, false);
+            PrintStatsJson("length", stats.length, false);
+            PrintStatsJson("survivalSeconds", stats.survival, true);
+            printf("  }%s\n", scaling.empty() ? "" : ",");
+            if (!scaling.empty())
+            {
+                printf("  \"scaling\": [\n");
+                for (size_t i = 0; i < scaling.size(); ++i)
+                {
+                    const ScalingRow& row = scaling[i];
+                    printf("    { \"threads\": %zu, \"seconds\": %.4f, \"speedup\": %.3f, \"efficiency\": %.3f, \"matches\": %s }%s\n",
+                        row.threads, row.seconds, scaling[0].seconds / row.seconds,
+                        scaling[0].seconds / row.seconds / static_cast<double>(row.threads),
+                        row.matches ? "true" : "false", (i + 1 < scaling.size()) ? "," : "");
+                }
+                printf("  ]\n");
+            }
+            printf("}\n");
+            return;
+        }
+
+        printf("# games=%llu threads=%zu policy=%s budget=%d move_interval=%.4f spawn_margin=%.1f dt=%.5f board=%dx%d%s seed=%llu\n",
+            static_cast<unsigned long long>(options.games), threadCount, policy, options.budget,
+            SnakeGame::TicksToSeconds(options.settings.moveIntervalTicks), options.settings.spawnMargin, SnakeGame::TicksToSeconds(options.dtTicks), options.width, options.height,
+            result.fixedBoard ? "(fixed)" : "", static_cast<unsigned long long>(options.seed));
+        printf("# %.3f s, %.1f games/s\n", result.seconds, gamesPerSecond);
+        printf("metric,count,mean,stddev,min,p50,p90,p99,max\n");
+        PrintStatsCsv("score", stats.score);
+        PrintStatsCsv("length", stats.length);
+        PrintStatsCsv("survival_s", stats.survival);
+        printf("\noutcome,count\n");
+        printf("died,%llu\nwon,%llu\ntimed_out,%llu\n",
+            static_cast<unsigned long long>(stats.died), static_cast<unsigned long long>(stats.won), static_cast<unsigned long long>(stats.timedOut));
+
+        if (!scaling.empty())
+        {
+            printf("\nthreads,seconds,games_per_s,speedup,efficiency,matches\n");
+            for (const ScalingRow& row : scaling)
+            {
+                printf("%zu,%.4f,%.1f,%.3f,%.3f,%s\n", row.threads, row.seconds, static_cast<double>(options.games) / row.seconds,
+                    scaling[0].seconds / row.seconds, scaling[0].seconds / row.seconds / static_cast<double>(row.threads),
+                    row.matches ? "yes" : "no");
+            }
+        }
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (strcmp(arg, "--scaling") == 0)
+            {
+                options.scaling = true;
+                continue;
+            }
+            if (strcmp(arg, "--dynamic") == 0)
+            {
+                options.dynamic = true;
+                continue;
+            }
+
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (!value)
+                return false;
+
+            if (strcmp(arg, "--games") == 0)
+                options.games = strtoull(value, nullptr, 10);
+            else if (strcmp(arg, "--threads") == 0)
+                options.threads = static_cast<size_t>(strtoull(value, nullptr, 10));
+            else if (strcmp(arg, "--policy") == 0 && strcmp(value, "autopilot") == 0)
+                options.policy = Policy::Autopilot;
+            else if (strcmp(arg, "--policy") == 0 && strcmp(value, "random") == 0)
+                options.policy = Policy::Random;
+            else if (strcmp(arg, "--budget") == 0)
+                options.budget = atoi(value);
+            else if (strcmp(arg, "--move-interval") == 0)
+                options.settings.moveIntervalTicks = SnakeGame::SecondsToTicks(strtod(value, nullptr));
+            else if (strcmp(arg, "--spawn-margin") == 0)
+                options.settings.spawnMargin = strtof(value, nullptr);
+            else if (strcmp(arg, "--dt") == 0)
+                options.dtTicks = SnakeGame::SecondsToTicks(strtod(value, nullptr));
+            else if (strcmp(arg, "--width") == 0)
+                options.width = atoi(value);
+            else if (strcmp(arg, "--height") == 0)
+                options.height = atoi(value);
+            else if (strcmp(arg, "--max-steps") == 0)
+                options.maxSteps = strtoull(value, nullptr, 10);
+            else if (strcmp(arg, "--seed") == 0)
+                options.seed = strtoull(value, nullptr, 10);
+            else if (strcmp(arg, "--format") == 0 && (strcmp(value, "csv") == 0 || strcmp(value, "json") == 0))
+                options.json = strcmp(value, "json") == 0;
+            else
+                return false;
+
+            ++i;
+        }
+
+        return options.games > 0 && options.budget > 0 && options.dtTicks > 0 && options.settings.moveIntervalTicks > 0 &&
+            options.settings.spawnMargin >= 0.0f && options.width > 0 && options.height > 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        printf("Usage: snake_tournament [--games N] [--threads T] [--scaling] [--policy autopilot|random] [--budget nodes]\n"
+               "                        [--move-interval s] [--spawn-margin px] [--dt s] [--width W] [--height H]\n"
+               "                        [--max-steps N] [--seed S] [--format csv|json] [--dynamic]\n");
+        return 1;
+    }
+
+    const size_t hardwareThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t threadCount = options.threads ? options.threads : hardwareThreads;
+
+    std::vector<ScalingRow> scaling;
+    RunResult result;
+    if (options.scaling)
+    {
+        // 1, 2, 4, ... threads, ending with the requested count
+        RunResult baseline = {};
+        for (size_t threads = 1;; threads = std::min(threads * 2, threadCount))
+        {
+            result = RunTournament(options, threads);
+            if (threads == 1)
+                baseline = result;
+
+            const bool matches = result.stats.totalScore == baseline.stats.totalScore &&
+                result.stats.died == baseline.stats.died && result.stats.won == baseline.stats.won;
+            scaling.push_back(ScalingRow{ threads, result.seconds, matches });
+
+            if (threads >= threadCount)
+                break;
+        }
+    }
+    else
+    {
+        result = RunTournament(options, threadCount);
+    }
+
+    PrintReport(options, threadCount, result, scaling);
+
+    for (const ScalingRow& row : scaling)
+    {
+        if (!row.matches)
+            return 1;
+    }
+    return 0;
+}
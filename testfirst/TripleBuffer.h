@@ -0,0 +1,58 @@
+//
+// TripleBuffer.h
+// Wait-free latest-value handoff from one writer thread to one reader thread
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Three copies of T: the writer owns one (back), the reader owns one (front), and
+// the third sits in the middle holding the newest published value.
+//
+// Publish swaps the back and middle copies, Acquire swaps the front and middle
+// copies if something new was published; both are one atomic exchange, so neither
+// side ever waits for the other. The reader always sees a whole value (the writer
+// never touches the front copy), possibly skipping values when the writer is
+// faster, and keeps reading the same copy when nothing new has arrived.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : m_back(0), m_front(1), m_middle(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer: the copy to fill next (its old contents are an older value)
+    T& GetBack() { return m_slots[m_back]; }
+
+    // Writer: make the back copy the newest value
+    void Publish()
+    {
+        m_back = m_middle.exchange(static_cast<uint8_t>(m_back | c_fresh), std::memory_order_acq_rel) & c_indexMask;
+    }
+
+    // Reader: the newest published value (or the previous one if nothing new)
+    const T& Acquire()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & c_fresh)
+        {
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & c_indexMask;
+        }
+        return m_slots[m_front];
+    }
+
+    // Either side, before the threads start: every copy (e.g. to preallocate)
+    T& GetSlot(int index) { return m_slots[index]; }
+
+private:
+    static constexpr uint8_t c_indexMask = 0x3;
+    static constexpr uint8_t c_fresh = 0x4;  // Middle copy has not been acquired yet
+
+    T m_slots[3];
+    uint8_t m_back;  // Writer-owned
+    uint8_t m_front;  // Reader-owned
+    std::atomic<uint8_t> m_middle;  // Index of the middle copy | c_fresh
+};
@@ -5,6 +5,10 @@
 
 #pragma once
 
+// The platform layer (window, D3D12, GDK, GameInput) is only available in the
+// game build. The gameplay core and the console tools build without it.
+#if defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+
 #include <winsdkver.h>
 #ifndef _WIN32_WINNT
 #define _WIN32_WINNT 0x0A00
@@ -44,6 +48,8 @@
 #include <DirectXMath.h>
 #include <DirectXColors.h>
 
+#endif // _GAMING_DESKTOP || _GAMING_XBOX
+
 #include <algorithm>
 #include <cassert>
 #include <cmath>
@@ -59,6 +65,8 @@
 #include <system_error>
 #include <tuple>
 
+#if defined(_GAMING_DESKTOP) || defined(_GAMING_XBOX)
+
 #ifdef _DEBUG
 #include <dxgidebug.h>
 #endif
@@ -139,3 +147,5 @@ namespace DX
         }
     }
 }
+
+#endif // _GAMING_DESKTOP || _GAMING_XBOX